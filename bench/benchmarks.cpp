@@ -0,0 +1,784 @@
+#include "corpus.hpp"
+#include "harness.hpp"
+
+#include "adsb/archive.hpp"
+#include "adsb/cpr.hpp"
+#include "adsb/crc.hpp"
+#include "adsb/decoder.hpp"
+#include "adsb/dedup.hpp"
+#include "adsb/demod.hpp"
+#include "adsb/encoder.hpp"
+#include "adsb/icao_filter.hpp"
+#include "adsb/message/AirbornePositionMessage.hpp"
+#include "adsb/message/AllCallMessage.hpp"
+#include "adsb/message/IdentificationMessage.hpp"
+#include "adsb/message/SurveillanceMessage.hpp"
+#include "adsb/message/VelocityMessage.hpp"
+#include "adsb/pipeline.hpp"
+#include "adsb/stats.hpp"
+#include "adsb/stream.hpp"
+#include "adsb/simulator.hpp"
+#include "adsb/spatial_index.hpp"
+#include "adsb/tracker.hpp"
+#include "adsb/utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef ADSB_BENCH_CORPUS
+#define ADSB_BENCH_CORPUS ""
+#endif
+
+namespace {
+
+    using adsb::bench::Frame;
+    using adsb::bench::State;
+
+    /**
+     * @struct Corpus
+     * @brief Frames shared by all benchmarks, built once in main().
+     */
+    struct Corpus {
+        std::vector<Frame> synthetic;
+        std::vector<Frame> identification;
+        std::vector<Frame> position;
+        std::vector<Frame> velocity;
+        std::vector<Frame> short_frames;
+        std::vector<Frame> recorded;            // --corpus, or the six frames of bench/data/corpus.avr
+        std::string recorded_name = "sample";   // "recorded" for a capture passed with --corpus
+        std::vector<adsb::bench::CprPair> cpr_pairs;
+        uint64_t seed = 42;
+        std::size_t aircraft = 1000;
+    };
+
+    Corpus corpus;
+
+    /// Contiguous copy of the frame bytes, `stride` bytes apart.
+    std::vector<uint8_t> pack(const std::vector<Frame>& frames, std::size_t length) {
+        std::vector<uint8_t> packed(frames.size() * length);
+        for (std::size_t i = 0; i < frames.size(); ++i) std::copy(frames[i].data, frames[i].data + length, &packed[i * length]);
+        return packed;
+    }
+
+    void register_crc() {
+        adsb::bench::register_benchmark("crc/syndrome/long", [](State& state) {
+            const auto& frames = corpus.synthetic;
+            uint32_t acc = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                acc ^= adsb::crc::syndrome(frames[i % frames.size()].data, adsb::types::LONG_FRAME_BYTES);
+            }
+            adsb::bench::do_not_optimize(acc);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("crc/syndrome/short", [](State& state) {
+            const auto& frames = corpus.short_frames;
+            uint32_t acc = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                acc ^= adsb::crc::syndrome(frames[i % frames.size()].data, adsb::types::SHORT_FRAME_BYTES);
+            }
+            adsb::bench::do_not_optimize(acc);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("crc/check_batch/long", [](State& state) {
+            static const std::vector<uint8_t> packed = pack(corpus.synthetic, adsb::types::LONG_FRAME_BYTES);
+            constexpr std::size_t BATCH = 256;
+            const std::size_t batches = packed.size() / adsb::types::LONG_FRAME_BYTES / BATCH;
+            uint32_t syndromes[BATCH];
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const uint8_t* first = &packed[(i % batches) * BATCH * adsb::types::LONG_FRAME_BYTES];
+                adsb::bench::do_not_optimize(adsb::crc::check_crc_batch(first, adsb::types::LONG_FRAME_BYTES,
+                                                                        adsb::types::LONG_FRAME_BYTES, BATCH, syndromes));
+            }
+            state.set_items_per_iteration(BATCH);
+            state.set_label(adsb::crc::batch_implementation());
+        });
+    }
+
+    void register_error_correction() {
+        struct Case {
+            const char* name;
+            adsb::crc::ErrorCorrection mode;
+            double bit_error_rate;
+        };
+        static const Case cases[] = {
+            {"decode/correction/none/ber=0", adsb::crc::ErrorCorrection::NONE, 0.0},
+            {"decode/correction/single_bit/ber=1e-4", adsb::crc::ErrorCorrection::SINGLE_BIT, 1e-4},
+            {"decode/correction/single_bit/ber=1e-3", adsb::crc::ErrorCorrection::SINGLE_BIT, 1e-3},
+            {"decode/correction/single_bit/ber=1e-2", adsb::crc::ErrorCorrection::SINGLE_BIT, 1e-2},
+            {"decode/correction/two_bit/ber=1e-4", adsb::crc::ErrorCorrection::TWO_BIT, 1e-4},
+            {"decode/correction/two_bit/ber=1e-3", adsb::crc::ErrorCorrection::TWO_BIT, 1e-3},
+            {"decode/correction/two_bit/ber=1e-2", adsb::crc::ErrorCorrection::TWO_BIT, 1e-2},
+        };
+
+        for (const Case& c : cases) {
+            // Damaged frames are prepared on the first (calibration) call only
+            auto damaged = std::make_shared<std::vector<Frame>>();
+            auto label = std::make_shared<std::string>();
+            adsb::bench::register_benchmark(c.name, [&c, damaged, label](State& state) {
+                adsb::decoder::DecoderOptions options;
+                options.error_correction = c.mode;
+                adsb::message::MessageData data;
+
+                if (damaged->empty()) {
+                    *damaged = corpus.synthetic;
+                    adsb::bench::inject_bit_errors(*damaged, c.bit_error_rate, corpus.seed + 1);
+                    std::size_t failing = 0;
+                    for (const Frame& frame : *damaged) failing += adsb::crc::check(frame.data, frame.length) ? 0 : 1;
+
+                    // Recovery ratio: share of the frames failing the CRC that were repaired
+                    adsb::decoder::CorrectionStats stats;
+                    for (Frame copy : *damaged) adsb::decoder::decode_into(copy.data, copy.length, data, options, &stats);
+                    char text[64];
+                    std::snprintf(text, sizeof(text), "damaged=%.2f%% recovered=%.1f%%",
+                                  100.0 * static_cast<double>(failing) / static_cast<double>(damaged->size()),
+                                  failing == 0 ? 100.0
+                                               : 100.0 * static_cast<double>(stats.single_bit + stats.two_bit) / static_cast<double>(failing));
+                    *label = text;
+                }
+
+                const auto& frames = *damaged;
+                uint64_t decoded = 0;
+                Frame frame;
+                for (uint64_t i = 0; i < state.iterations(); ++i) {
+                    // The decoder repairs in place, so work on a copy
+                    frame = frames[i % frames.size()];
+                    decoded += adsb::decoder::decode_into(frame.data, frame.length, data, options) ? 1 : 0;
+                }
+                adsb::bench::do_not_optimize(decoded);
+                state.set_items_per_iteration(1);
+                state.set_label(*label);
+            });
+        }
+    }
+
+    /// Reads every field of a message object, as a consumer of the object API does; fields are decoded lazily.
+    void read_fields(const adsb::message::ADSBMessage* message) {
+        if (auto* identification = dynamic_cast<const adsb::message::IdentificationMessage*>(message)) {
+            adsb::bench::do_not_optimize(identification->get_data());
+        } else if (auto* position = dynamic_cast<const adsb::message::AirbornePositionMessage*>(message)) {
+            adsb::bench::do_not_optimize(position->get_data());
+        } else if (auto* velocity = dynamic_cast<const adsb::message::VelocityMessage*>(message)) {
+            adsb::bench::do_not_optimize(velocity->get_data());
+        } else if (auto* all_call = dynamic_cast<const adsb::message::AllCallMessage*>(message)) {
+            adsb::bench::do_not_optimize(all_call->get_data());
+        } else if (auto* surveillance = dynamic_cast<const adsb::message::SurveillanceMessage*>(message)) {
+            adsb::bench::do_not_optimize(surveillance->get_data());
+        }
+    }
+
+    void register_decode(const char* name, const std::vector<Frame>* frames) {
+        // The object and arena variants read the fields, so that they do the same work as decode/into
+        adsb::bench::register_benchmark(std::string("decode/object/") + name, [frames](State& state) {
+            const auto timestamp = adsb::types::from_mlat_ticks(0);
+            uint64_t decoded = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = (*frames)[i % frames->size()];
+                auto message = adsb::decoder::decode(frame.data, frame.length, timestamp);
+                decoded += message != nullptr ? 1 : 0;
+                read_fields(message.get());
+            }
+            adsb::bench::do_not_optimize(decoded);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark(std::string("decode/arena/") + name, [frames](State& state) {
+            // Batches of message objects, released together
+            constexpr std::size_t BATCH = 256;
+            const auto timestamp = adsb::types::from_mlat_ticks(0);
+            adsb::decoder::MessageArena arena;
+            std::vector<adsb::decoder::MessagePtr> batch;
+            batch.reserve(BATCH);
+            uint64_t decoded = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = (*frames)[i % frames->size()];
+                batch.push_back(adsb::decoder::decode(frame.data, frame.length, timestamp, &arena));
+                decoded += batch.back() != nullptr ? 1 : 0;
+                read_fields(batch.back().get());
+                if (batch.size() == BATCH) {
+                    batch.clear();
+                    arena.reset();
+                }
+            }
+            adsb::bench::do_not_optimize(decoded);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark(std::string("decode/into/") + name, [frames](State& state) {
+            adsb::message::MessageData data;
+            uint64_t decoded = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = (*frames)[i % frames->size()];
+                decoded += adsb::decoder::decode_into(frame.data, frame.length, data) ? 1 : 0;
+                adsb::bench::do_not_optimize(data);
+            }
+            adsb::bench::do_not_optimize(decoded);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark(std::string("decode/visit/") + name, [frames](State& state) {
+            uint64_t decoded = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = (*frames)[i % frames->size()];
+                decoded += adsb::decoder::decode_visit(frame.data, frame.length,
+                                                       [](const auto& message) { adsb::bench::do_not_optimize(message); })
+                    ? 1 : 0;
+            }
+            adsb::bench::do_not_optimize(decoded);
+            state.set_items_per_iteration(1);
+        });
+
+        // Only velocities are wanted: the other messages are dropped by the type code filter
+        adsb::bench::register_benchmark(std::string("decode/visit_velocity/") + name, [frames](State& state) {
+            double speed = 0.0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = (*frames)[i % frames->size()];
+                adsb::decoder::decode_visit(frame.data, frame.length,
+                                            [&](const adsb::message::VelocityData& velocity) { speed += velocity.speed; });
+            }
+            adsb::bench::do_not_optimize(speed);
+            state.set_items_per_iteration(1);
+        });
+    }
+
+    /**
+     * @brief Object decoding of all traffic versus a fleet of 60 aircraft picked with an IcaoFilter.
+     *
+     * Both read the fields of every message they get, see read_fields().
+     */
+    void register_filter() {
+        adsb::bench::register_benchmark("decode/filter/none", [](State& state) {
+            const auto& frames = corpus.synthetic;
+            const auto timestamp = adsb::types::from_mlat_ticks(0);
+            uint64_t decoded = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = frames[i % frames.size()];
+                auto message = adsb::decoder::decode(frame.data, frame.length, timestamp);
+                decoded += message != nullptr ? 1 : 0;
+                read_fields(message.get());
+            }
+            adsb::bench::do_not_optimize(decoded);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("decode/filter/fleet", [](State& state) {
+            const auto& frames = corpus.synthetic;
+            std::vector<uint32_t> fleet;
+            for (const Frame& frame : frames) {
+                const uint32_t icao = static_cast<uint32_t>(adsb::utils::load_be(frame.data + 1, 3));
+                if (std::find(fleet.begin(), fleet.end(), icao) == fleet.end()) fleet.push_back(icao);
+                if (fleet.size() == 60) break;
+            }
+            const adsb::decoder::IcaoFilter filter(adsb::decoder::IcaoFilter::Mode::ALLOW, fleet);
+            adsb::decoder::DecoderOptions options;
+            options.icao_filter = &filter;
+
+            const auto timestamp = adsb::types::from_mlat_ticks(0);
+            uint64_t decoded = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const Frame& frame = frames[i % frames.size()];
+                auto message = adsb::decoder::decode(frame.data, frame.length, timestamp, options);
+                decoded += message != nullptr ? 1 : 0;
+                read_fields(message.get());
+            }
+            adsb::bench::do_not_optimize(decoded);
+            state.set_items_per_iteration(1);
+            state.set_label(std::to_string(fleet.size()) + " of " + std::to_string(corpus.aircraft) + " aircraft");
+        });
+    }
+
+    void register_cpr() {
+        adsb::bench::register_benchmark("cpr/global", [](State& state) {
+            const auto& pairs = corpus.cpr_pairs;
+            uint64_t valid = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const auto& p = pairs[i % pairs.size()];
+                auto result = adsb::cpr::global_position(p.even_lat, p.even_lon, p.odd_lat, p.odd_lon, (i & 1) != 0);
+                valid += result.is_valid ? 1 : 0;
+                adsb::bench::do_not_optimize(result);
+            }
+            adsb::bench::do_not_optimize(valid);
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("cpr/global_batch", [](State& state) {
+            /**
+             * @struct Columns
+             * @brief The CPR pairs as structure of arrays, built on the first call.
+             */
+            struct Columns {
+                std::vector<int> even_lat, even_lon, odd_lat, odd_lon;
+                std::vector<int64_t> even_time, odd_time;
+                std::vector<double> latitude, longitude;
+                std::vector<uint8_t> is_valid;
+
+                explicit Columns(const std::vector<adsb::bench::CprPair>& pairs)
+                    : even_time(pairs.size(), 0), odd_time(pairs.size(), 1000),
+                      latitude(pairs.size()), longitude(pairs.size()), is_valid(pairs.size()) {
+                    for (const auto& pair : pairs) {
+                        even_lat.push_back(pair.even_lat);
+                        even_lon.push_back(pair.even_lon);
+                        odd_lat.push_back(pair.odd_lat);
+                        odd_lon.push_back(pair.odd_lon);
+                    }
+                }
+            };
+            static Columns columns(corpus.cpr_pairs);
+            const std::size_t n = corpus.cpr_pairs.size();
+            const adsb::cpr::PairBatch input{columns.even_lat.data(), columns.even_lon.data(), columns.odd_lat.data(),
+                                             columns.odd_lon.data(), columns.even_time.data(), columns.odd_time.data(), n};
+            const adsb::cpr::PositionBatch output{columns.latitude.data(), columns.longitude.data(), columns.is_valid.data()};
+
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                adsb::bench::do_not_optimize(adsb::cpr::global_position_batch(input, output));
+            }
+            state.set_items_per_iteration(n);
+            state.set_label(adsb::cpr::batch_implementation());
+        });
+
+        adsb::bench::register_benchmark("cpr/local", [](State& state) {
+            const auto& pairs = corpus.cpr_pairs;
+            uint64_t valid = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const auto& p = pairs[i % pairs.size()];
+                // Reference a few kilometres off the true position
+                const adsb::types::GlobalPosition reference{p.latitude + 0.05, p.longitude - 0.05, 0};
+                auto result = adsb::cpr::local_position(p.even_lat, p.even_lon, false, reference);
+                valid += result.is_valid ? 1 : 0;
+                adsb::bench::do_not_optimize(result);
+            }
+            adsb::bench::do_not_optimize(valid);
+            state.set_items_per_iteration(1);
+        });
+    }
+
+    void register_simulator() {
+        adsb::bench::register_benchmark("simulator/generate", [](State& state) {
+            constexpr std::size_t BATCH = 4096;
+            static std::vector<Frame> frames(BATCH);
+            adsb::simulator::SimulatorOptions options;
+            options.seed = corpus.seed;
+            options.aircraft = corpus.aircraft;
+            static adsb::simulator::TrafficSimulator simulator(options);
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                simulator.generate(frames.data(), BATCH);
+                adsb::bench::do_not_optimize(frames.data());
+            }
+            state.set_items_per_iteration(BATCH);
+        });
+
+        adsb::bench::register_benchmark("simulator/generate/ber=1e-3", [](State& state) {
+            constexpr std::size_t BATCH = 4096;
+            static std::vector<Frame> frames(BATCH);
+            adsb::simulator::SimulatorOptions options;
+            options.seed = corpus.seed;
+            options.aircraft = corpus.aircraft;
+            options.bit_error_rate = 1e-3;
+            static adsb::simulator::TrafficSimulator simulator(options);
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                adsb::bench::do_not_optimize(simulator.generate(frames.data(), BATCH));
+            }
+            state.set_items_per_iteration(BATCH);
+        });
+    }
+
+    /**
+     * @brief Parses a whole serialized feed, decodes every frame and feeds the tracker, once per iteration.
+     */
+    template <typename Parser>
+    void replay(State& state, const uint8_t* data, std::size_t size, std::size_t frames) {
+        // One tracker for all passes: after the first one, every aircraft is already tracked
+        adsb::tracker::AircraftTracker tracker;
+        adsb::message::MessageData message;
+        uint64_t updates = 0;
+        for (uint64_t i = 0; i < state.iterations(); ++i) {
+            Parser parser;
+            parser.feed(data, size, [&](const adsb::stream::FrameView& view) {
+                if (adsb::decoder::decode_into(view.data, view.length, message)) {
+                    updates += tracker.update(message, view.timestamp()) != nullptr ? 1 : 0;
+                }
+            });
+            adsb::bench::do_not_optimize(tracker.size());
+        }
+        adsb::bench::do_not_optimize(updates);
+        state.set_items_per_iteration(frames);
+        state.set_bytes_per_iteration(size);
+    }
+
+    void register_replay() {
+        adsb::bench::register_benchmark("replay/beast", [](State& state) {
+            static const std::vector<uint8_t> feed = adsb::bench::to_beast(corpus.synthetic);
+            replay<adsb::stream::BeastParser>(state, feed.data(), feed.size(), corpus.synthetic.size());
+        });
+
+        adsb::bench::register_benchmark("replay/avr", [](State& state) {
+            static const std::string feed = adsb::bench::to_avr(corpus.synthetic);
+            replay<adsb::stream::AvrParser>(state, reinterpret_cast<const uint8_t*>(feed.data()), feed.size(),
+                                            corpus.synthetic.size());
+        });
+
+        adsb::bench::register_benchmark("replay/" + corpus.recorded_name, [](State& state) {
+            static const std::string feed = adsb::bench::to_avr(corpus.recorded);
+            replay<adsb::stream::AvrParser>(state, reinterpret_cast<const uint8_t*>(feed.data()), feed.size(),
+                                            corpus.recorded.size());
+        });
+    }
+
+    /// Index of 20000 simulated aircraft around the simulator's default center.
+    const adsb::tracker::SpatialIndex& spatial_index() {
+        static const auto index = [] {
+            adsb::simulator::SimulatorOptions options;
+            options.seed = corpus.seed;
+            options.aircraft = 20000;
+            const adsb::simulator::TrafficSimulator simulator(options);
+            adsb::tracker::SpatialIndexOptions index_options;
+            index_options.capacity = options.aircraft;
+            auto built = std::make_unique<adsb::tracker::SpatialIndex>(index_options);
+            for (const auto& aircraft : simulator.aircraft()) {
+                built->update(aircraft.icao, {aircraft.latitude, aircraft.longitude, 0}, adsb::types::Timestamp{});
+            }
+            built->publish();
+            return built;
+        }();
+        return *index;
+    }
+
+    /// Query centers spread over the simulated area.
+    std::vector<adsb::types::GlobalPosition> query_points(std::size_t count) {
+        const adsb::simulator::SimulatorOptions options;
+        std::vector<adsb::types::GlobalPosition> points(count);
+        uint64_t state = corpus.seed;
+        for (auto& point : points) {
+            const double d_lat = static_cast<double>(adsb::utils::next_random(state) % 1000) / 1000.0 - 0.5;
+            const double d_lon = static_cast<double>(adsb::utils::next_random(state) % 1000) / 1000.0 - 0.5;
+            point = {options.center.latitude + d_lat * 6.0, options.center.longitude + d_lon * 9.0, 0};
+        }
+        return points;
+    }
+
+    void register_spatial() {
+        adsb::bench::register_benchmark("spatial/radius=50nm/aircraft=20000", [](State& state) {
+            const auto snapshot = spatial_index().snapshot();
+            const auto points = query_points(256);
+            std::vector<adsb::tracker::IndexedAircraft> found;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                adsb::bench::do_not_optimize(snapshot->within_radius(points[i % points.size()], 50.0, found));
+            }
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("spatial/box=1x1.5deg/aircraft=20000", [](State& state) {
+            const auto snapshot = spatial_index().snapshot();
+            const auto points = query_points(256);
+            std::vector<adsb::tracker::IndexedAircraft> found;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                const auto& point = points[i % points.size()];
+                adsb::bench::do_not_optimize(snapshot->within_box(point.latitude - 0.5, point.longitude - 0.75,
+                                                                  point.latitude + 0.5, point.longitude + 0.75, found));
+            }
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("spatial/nearest=10/aircraft=20000", [](State& state) {
+            const auto snapshot = spatial_index().snapshot();
+            const auto points = query_points(256);
+            std::vector<adsb::tracker::IndexedAircraft> found;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                adsb::bench::do_not_optimize(snapshot->nearest(points[i % points.size()], 10, found));
+            }
+            state.set_items_per_iteration(1);
+        });
+
+        adsb::bench::register_benchmark("spatial/publish/aircraft=20000", [](State& state) {
+            adsb::tracker::SpatialIndexOptions options;
+            options.capacity = 20000;
+            options.publish_interval = std::chrono::hours(1);
+            adsb::tracker::SpatialIndex index(options);
+            for (const auto& aircraft : spatial_index().snapshot()->aircraft()) {
+                index.update(aircraft.icao, aircraft.position, aircraft.position_time);
+            }
+            const auto& first = spatial_index().snapshot()->aircraft().front();
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                // A change is needed, or publish() has nothing to do
+                index.update(first.icao, first.position, first.position_time);
+                index.publish();
+            }
+            state.set_items_per_iteration(options.capacity);
+        });
+    }
+
+    /// Decoded messages of the synthetic corpus with their reception times.
+    const std::vector<std::pair<adsb::message::MessageData, adsb::types::Timestamp>>& decoded_corpus() {
+        static const auto messages = [] {
+            std::vector<std::pair<adsb::message::MessageData, adsb::types::Timestamp>> decoded;
+            adsb::message::MessageData message;
+            for (const Frame& frame : corpus.synthetic) {
+                if (adsb::decoder::decode_into(frame.data, frame.length, message)) {
+                    decoded.emplace_back(message, adsb::types::from_mlat_ticks(frame.mlat_ticks));
+                }
+            }
+            return decoded;
+        }();
+        return messages;
+    }
+
+    /// Path of the archive the archive benchmarks write and read; removed again by main().
+    std::string archive_path() {
+        static const std::string path = (std::filesystem::temp_directory_path() / "adsb-bench.archive").string();
+        return path;
+    }
+
+    /// Writes the decoded corpus to a new archive.
+    bool write_archive() {
+        std::filesystem::remove(archive_path());
+        std::filesystem::remove(archive_path() + ".idx");
+        adsb::archive::ArchiveWriter writer;
+        if (!writer.open(archive_path())) return false;
+        for (const auto& [message, timestamp] : decoded_corpus()) writer.append(message, timestamp);
+        return writer.close();
+    }
+
+    /// Opens the archive of the decoded corpus, writing it first if no benchmark has yet.
+    void open_archive(adsb::archive::ArchiveReader& reader) {
+        static const bool written = write_archive();
+        adsb::bench::do_not_optimize(written);
+        reader.open(archive_path());
+    }
+
+    void register_archive() {
+        adsb::bench::register_benchmark("archive/write", [](State& state) {
+            for (uint64_t i = 0; i < state.iterations(); ++i) adsb::bench::do_not_optimize(write_archive());
+            state.set_items_per_iteration(decoded_corpus().size());
+        });
+
+        adsb::bench::register_benchmark("archive/scan/all", [](State& state) {
+            adsb::archive::ArchiveReader reader;
+            open_archive(reader);
+            uint64_t matches = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                matches += reader.scan({}, [](const adsb::message::MessageData&, adsb::types::Timestamp) {}).matches;
+            }
+            adsb::bench::do_not_optimize(matches);
+            state.set_items_per_iteration(decoded_corpus().size());
+        });
+
+        adsb::bench::register_benchmark("archive/scan/icao_positions", [](State& state) {
+            adsb::archive::ArchiveReader reader;
+            open_archive(reader);
+            const auto& messages = decoded_corpus();
+            adsb::archive::ArchiveQuery query;
+            query.kinds = adsb::archive::kind_bit(adsb::archive::MessageKind::AIRBORNE_POSITION);
+            uint64_t matches = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                query.icao = adsb::message::icao_of(messages[(i * 7919) % messages.size()].first);
+                matches += reader.scan(query, [](const adsb::message::MessageData&, adsb::types::Timestamp) {}).matches;
+            }
+            adsb::bench::do_not_optimize(matches);
+            state.set_items_per_iteration(1);
+        });
+    }
+
+    /// Path of the tracker snapshot the snapshot benchmarks write and read; removed again by main().
+    std::string snapshot_path() {
+        static const std::string path = (std::filesystem::temp_directory_path() / "adsb-bench.snapshot").string();
+        return path;
+    }
+
+    /// Tracker holding every aircraft of the decoded corpus, and the time of its last message.
+    const std::pair<std::unique_ptr<adsb::tracker::AircraftTracker>, adsb::types::Timestamp>& tracked_corpus() {
+        static const auto tracked = [] {
+            adsb::tracker::TrackerOptions options;
+            options.expiry = std::chrono::hours(1);
+            auto tracker = std::make_unique<adsb::tracker::AircraftTracker>(options);
+            adsb::types::Timestamp last{};
+            for (const auto& [message, timestamp] : decoded_corpus()) {
+                tracker->update(message, timestamp);
+                last = std::max(last, timestamp);
+            }
+            return std::make_pair(std::move(tracker), last);
+        }();
+        return tracked;
+    }
+
+    void register_snapshot() {
+        adsb::bench::register_benchmark("tracker/snapshot/save", [](State& state) {
+            const auto& tracker = *tracked_corpus().first;
+            for (uint64_t i = 0; i < state.iterations(); ++i) adsb::bench::do_not_optimize(tracker.save(snapshot_path()));
+            state.set_items_per_iteration(tracker.size());
+        });
+
+        adsb::bench::register_benchmark("tracker/snapshot/load", [](State& state) {
+            const auto& [tracker, now] = tracked_corpus();
+            tracker->save(snapshot_path());
+            adsb::tracker::TrackerOptions options;
+            options.expiry = std::chrono::hours(1);
+            adsb::tracker::AircraftTracker restored(options);
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                adsb::bench::do_not_optimize(restored.load(snapshot_path(), now));
+            }
+            state.set_items_per_iteration(tracker->size());
+        });
+    }
+
+    /**
+     * @brief Every synthetic frame as heard by three receivers, a few milliseconds apart.
+     */
+    void register_dedup() {
+        adsb::bench::register_benchmark("dedup/check/receivers=3", [](State& state) {
+            constexpr uint32_t RECEIVERS = 3;
+            const int64_t skew_ns = 2000000;
+            adsb::dedup::DuplicateFilter filter;
+            uint64_t duplicates = 0;
+            int64_t offset_ns = 0;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                for (const Frame& frame : corpus.synthetic) {
+                    const int64_t time_ns = adsb::types::to_nanoseconds(adsb::types::from_mlat_ticks(frame.mlat_ticks));
+                    for (uint32_t receiver = 0; receiver < RECEIVERS; ++receiver) {
+                        const auto timestamp = adsb::types::from_nanoseconds(offset_ns + time_ns + receiver * skew_ns);
+                        duplicates += filter.check(frame.data, frame.length, timestamp, receiver).duplicate ? 1 : 0;
+                    }
+                }
+                // Later passes continue in time instead of finding the frames of the previous one
+                offset_ns += adsb::types::to_nanoseconds(adsb::types::from_mlat_ticks(corpus.synthetic.back().mlat_ticks));
+            }
+            adsb::bench::do_not_optimize(duplicates);
+            state.set_items_per_iteration(corpus.synthetic.size() * RECEIVERS);
+        });
+    }
+
+    /**
+     * @brief Pushes the synthetic corpus through a fresh pipeline and waits until it is drained, once per iteration.
+     *
+     * All frames come from one source; the workers only scale if they have a core each.
+     */
+    void register_pipeline(std::size_t workers) {
+        adsb::bench::register_benchmark("pipeline/workers=" + std::to_string(workers), [workers](State& state) {
+            adsb::pipeline::PipelineOptions options;
+            options.workers = workers;
+            options.overflow = adsb::pipeline::OverflowPolicy::BLOCK;
+            for (uint64_t i = 0; i < state.iterations(); ++i) {
+                adsb::pipeline::Pipeline pipeline(options);
+                adsb::pipeline::Pipeline::Source source = pipeline.source(0);
+                for (const Frame& frame : corpus.synthetic) {
+                    source.push(frame.data, frame.length, adsb::types::from_mlat_ticks(frame.mlat_ticks));
+                }
+                pipeline.stop();
+                adsb::bench::do_not_optimize(pipeline.stats().updates);
+            }
+            state.set_items_per_iteration(corpus.synthetic.size());
+        });
+    }
+
+    std::vector<Frame> select(const std::vector<Frame>& frames, int type_code_low, int type_code_high) {
+        std::vector<Frame> selected;
+        for (const Frame& frame : frames) {
+            const int type_code = frame.data[4] >> 3;
+            if (type_code >= type_code_low && type_code <= type_code_high) selected.push_back(frame);
+        }
+        return selected;
+    }
+
+    /// DF11 all-call replies of the synthetic aircraft, with a zero interrogator code.
+    std::vector<Frame> make_short_frames(const std::vector<Frame>& frames) {
+        std::vector<Frame> short_frames(frames.size());
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            const uint32_t icao = adsb::utils::load_be(frames[i].data + 1, 3);
+            const adsb::message::AllCallData reply{icao, adsb::encoder::CAPABILITY_AIRBORNE, 0};
+            short_frames[i].length = static_cast<uint8_t>(adsb::encoder::encode(reply, short_frames[i].data));
+            short_frames[i].mlat_ticks = frames[i].mlat_ticks;
+        }
+        return short_frames;
+    }
+
+    void usage(const char* program) {
+        std::fprintf(stderr,
+                     "usage: %s [--filter=<substring>] [--min-time=<seconds>] [--repetitions=<n>]\n"
+                     "          [--json=<path>] [--list] [--seed=<n>] [--frames=<n>] [--aircraft=<n>]\n"
+                     "          [--corpus=<avr file>]\n",
+                     program);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    adsb::bench::Options options;
+    adsb::bench::KeyValues extra;
+    if (!adsb::bench::parse_options(argc, argv, options, extra)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint64_t seed = 42;
+    std::size_t frames = 65536;
+    std::size_t aircraft = 1000;
+    std::string corpus_path = ADSB_BENCH_CORPUS;
+    for (const auto& [key, value] : extra) {
+        if (key == "seed") seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "frames") frames = std::max<std::size_t>(std::strtoull(value.c_str(), nullptr, 10), 1024);
+        else if (key == "aircraft") aircraft = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "corpus") {
+            corpus_path = value;
+            corpus.recorded_name = "recorded";
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    corpus.seed = seed;
+    corpus.aircraft = aircraft;
+    corpus.synthetic = adsb::bench::generate(seed, frames, aircraft);
+    corpus.identification = select(corpus.synthetic, 1, 4);
+    corpus.position = select(corpus.synthetic, 9, 18);
+    corpus.velocity = select(corpus.synthetic, 19, 19);
+    corpus.short_frames = make_short_frames(corpus.synthetic);
+    corpus.cpr_pairs = adsb::bench::generate_cpr_pairs(frames, seed);
+    if (!adsb::bench::load_avr(corpus_path, corpus.recorded) || corpus.recorded.empty()) {
+        std::fprintf(stderr, "cannot read recorded corpus '%s'\n", corpus_path.c_str());
+        return 1;
+    }
+
+    register_crc();
+    register_error_correction();
+    register_decode("identification", &corpus.identification);
+    register_decode("position", &corpus.position);
+    register_decode("velocity", &corpus.velocity);
+    register_decode(corpus.recorded_name.c_str(), &corpus.recorded);
+    register_filter();
+    register_cpr();
+    register_simulator();
+    register_replay();
+    register_dedup();
+    register_spatial();
+    register_archive();
+    register_snapshot();
+    for (std::size_t workers : {1, 2, 4}) register_pipeline(workers);
+
+    const adsb::bench::KeyValues context = {
+        {"seed", std::to_string(seed)},
+        {"frames", std::to_string(frames)},
+        {"aircraft", std::to_string(aircraft)},
+        {"corpus", corpus_path},
+        {"corpus_frames", std::to_string(corpus.recorded.size())},
+        {"crc_batch_implementation", adsb::crc::batch_implementation()},
+        {"cpr_batch_implementation", adsb::cpr::batch_implementation()},
+        {"demod_implementation", adsb::demod::implementation()},
+        {"hardware_threads", std::to_string(std::thread::hardware_concurrency())},
+        {"stats_enabled", adsb::stats::enabled() ? "true" : "false"},
+    };
+    const int status = adsb::bench::run(options, context);
+    std::filesystem::remove(archive_path());
+    std::filesystem::remove(archive_path() + ".idx");
+    std::filesystem::remove(snapshot_path());
+    return status;
+}
@@ -0,0 +1,93 @@
+#include "corpus.hpp"
+
+#include "adsb/cpr.hpp"
+#include "adsb/encoder.hpp"
+#include "adsb/stream.hpp"
+
+#include <cstdio>
+#include <random>
+
+namespace adsb::bench {
+
+    std::vector<Frame> generate(uint64_t seed, std::size_t frames, std::size_t aircraft) {
+        simulator::SimulatorOptions options;
+        options.seed = seed;
+        options.aircraft = aircraft;
+        simulator::TrafficSimulator simulator(options);
+        return simulator.generate(frames);
+    }
+
+    std::size_t inject_bit_errors(std::vector<Frame>& frames, double bit_error_rate, uint64_t seed) {
+        encoder::BitErrorInjector injector(bit_error_rate, seed);
+        std::size_t flipped = 0;
+        for (Frame& frame : frames) flipped += injector.apply(frame.data, frame.length);
+        return flipped;
+    }
+
+    std::vector<CprPair> generate_cpr_pairs(std::size_t count, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> latitude(-85.0, 85.0);
+        std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+
+        std::vector<CprPair> pairs(count);
+        for (CprPair& pair : pairs) {
+            pair.latitude = latitude(rng);
+            pair.longitude = longitude(rng);
+            const cpr::EncodedPosition even = cpr::encode(pair.latitude, pair.longitude, false);
+            const cpr::EncodedPosition odd = cpr::encode(pair.latitude, pair.longitude, true);
+            pair.even_lat = even.cpr_lat;
+            pair.even_lon = even.cpr_lon;
+            pair.odd_lat = odd.cpr_lat;
+            pair.odd_lon = odd.cpr_lon;
+        }
+        return pairs;
+    }
+
+    bool load_avr(const std::string& path, std::vector<Frame>& frames) {
+        stream::MappedFile file;
+        if (!file.open(path)) return false;
+
+        stream::AvrParser parser;
+        parser.feed(file.data(), file.size(), [&](const stream::FrameView& view) {
+            Frame frame{};
+            std::copy(view.data, view.data + view.length, frame.data);
+            frame.length = static_cast<uint8_t>(view.length);
+            frame.mlat_ticks = view.mlat_ticks;
+            frames.push_back(frame);
+        });
+        return true;
+    }
+
+    std::vector<uint8_t> to_beast(const std::vector<Frame>& frames) {
+        std::vector<uint8_t> out;
+        out.reserve(frames.size() * 26);
+        auto put = [&out](uint8_t byte) {
+            out.push_back(byte);
+            if (byte == stream::BeastFormat::ESCAPE) out.push_back(byte);
+        };
+        for (const Frame& frame : frames) {
+            out.push_back(stream::BeastFormat::ESCAPE);
+            out.push_back(frame.length == types::LONG_FRAME_BYTES ? '3' : '2');
+            for (int i = 5; i >= 0; --i) put(static_cast<uint8_t>(frame.mlat_ticks >> (8 * i)));
+            put(0x80);                  // Signal level
+            for (std::size_t i = 0; i < frame.length; ++i) put(frame.data[i]);
+        }
+        return out;
+    }
+
+    std::string to_avr(const std::vector<Frame>& frames) {
+        std::string out;
+        out.reserve(frames.size() * 42);
+        char line[48];
+        for (const Frame& frame : frames) {
+            int n = std::snprintf(line, sizeof(line), "@%012llX", static_cast<unsigned long long>(frame.mlat_ticks & 0xFFFFFFFFFFFFULL));
+            for (std::size_t i = 0; i < frame.length; ++i) {
+                n += std::snprintf(line + n, sizeof(line) - static_cast<std::size_t>(n), "%02X", frame.data[i]);
+            }
+            out.append(line, static_cast<std::size_t>(n));
+            out += ";\n";
+        }
+        return out;
+    }
+
+}
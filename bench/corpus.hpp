@@ -0,0 +1,58 @@
+#pragma once
+
+#include "adsb/simulator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace adsb::bench {
+
+    /// One Mode S frame of a corpus with its receive time.
+    using Frame = simulator::Frame;
+
+    /**
+     * @brief Generates `frames` frames of simulated traffic, see simulator::TrafficSimulator.
+     *
+     * The same seed always produces the same frames.
+     */
+    std::vector<Frame> generate(uint64_t seed, std::size_t frames, std::size_t aircraft);
+
+    /**
+     * @brief Flips every bit of every frame independently with the given probability.
+     * @return The number of flipped bits.
+     */
+    std::size_t inject_bit_errors(std::vector<Frame>& frames, double bit_error_rate, uint64_t seed);
+
+    /**
+     * @struct CprPair
+     * @brief An even and an odd CPR encoding of the same position.
+     */
+    struct CprPair {
+        int even_lat;
+        int even_lon;
+        int odd_lat;
+        int odd_lon;
+        double latitude;
+        double longitude;
+    };
+
+    /**
+     * @brief Encodes random positions (|latitude| < 85) into even/odd CPR pairs.
+     */
+    std::vector<CprPair> generate_cpr_pairs(std::size_t count, uint64_t seed);
+
+    /**
+     * @brief Reads an AVR text recording (`*8D...;`, `@...;` or `<...;` lines).
+     * @return false if the file cannot be read.
+     */
+    bool load_avr(const std::string& path, std::vector<Frame>& frames);
+
+    /// Serializes frames as a Beast binary stream (with escaping).
+    std::vector<uint8_t> to_beast(const std::vector<Frame>& frames);
+
+    /// Serializes frames as AVR text lines with timestamps (`@...;`).
+    std::string to_avr(const std::vector<Frame>& frames);
+
+}
@@ -0,0 +1,216 @@
+#include "harness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+    struct Benchmark {
+        std::string name;
+        adsb::bench::Function function;
+    };
+
+    std::vector<Benchmark>& benchmarks() {
+        static std::vector<Benchmark> registered;
+        return registered;
+    }
+
+    /**
+     * @struct Measurement
+     * @brief One timed run of a benchmark.
+     */
+    struct Measurement {
+        uint64_t iterations;
+        double real_ns;                 // Per iteration
+        double cpu_ns;                  // Per iteration
+        uint64_t items_per_iteration;
+        uint64_t bytes_per_iteration;
+        std::string label;
+    };
+
+    double process_cpu_seconds() {
+        timespec ts{};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+    }
+
+    Measurement measure(const Benchmark& benchmark, uint64_t iterations) {
+        adsb::bench::State state(iterations);
+        const double cpu_start = process_cpu_seconds();
+        const auto start = std::chrono::steady_clock::now();
+        benchmark.function(state);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const double cpu = process_cpu_seconds() - cpu_start;
+
+        const double real_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        return {iterations, real_ns / static_cast<double>(iterations), cpu * 1e9 / static_cast<double>(iterations),
+                state.items_per_iteration(), state.bytes_per_iteration(), state.label()};
+    }
+
+    /**
+     * @brief Finds an iteration count that runs for about `min_time` seconds.
+     */
+    uint64_t calibrate(const Benchmark& benchmark, double min_time) {
+        // Warm-up call, which also lets benchmarks build their inputs lazily
+        measure(benchmark, 1);
+
+        uint64_t iterations = 1;
+        for (;;) {
+            Measurement m = measure(benchmark, iterations);
+            const double seconds = m.real_ns * static_cast<double>(iterations) * 1e-9;
+            if (seconds >= min_time / 10.0 || iterations >= (uint64_t{1} << 40)) {
+                const double scaled = min_time / std::max(m.real_ns * 1e-9, 1e-12);
+                return std::max<uint64_t>(1, static_cast<uint64_t>(scaled));
+            }
+            iterations *= 10;
+        }
+    }
+
+    std::string json_escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            out += c;
+        }
+        return out;
+    }
+
+    std::string format_rate(double per_second, const char* unit) {
+        char buffer[64];
+        if (per_second >= 1e9) std::snprintf(buffer, sizeof(buffer), "%.2fG%s/s", per_second * 1e-9, unit);
+        else if (per_second >= 1e6) std::snprintf(buffer, sizeof(buffer), "%.2fM%s/s", per_second * 1e-6, unit);
+        else if (per_second >= 1e3) std::snprintf(buffer, sizeof(buffer), "%.2fk%s/s", per_second * 1e-3, unit);
+        else std::snprintf(buffer, sizeof(buffer), "%.2f%s/s", per_second, unit);
+        return buffer;
+    }
+
+    void write_json(const std::string& path, const adsb::bench::KeyValues& context,
+                    const std::vector<std::pair<std::string, Measurement>>& results, int repetitions) {
+        std::ofstream out(path);
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            return;
+        }
+
+        char date[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+        char host[256] = {};
+        gethostname(host, sizeof(host) - 1);
+
+        out << "{\n  \"context\": {\n";
+        out << "    \"date\": \"" << date << "\",\n";
+        out << "    \"host_name\": \"" << json_escape(host) << "\",\n";
+        out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+        out << "    \"library_build_type\": \"release\"";
+#else
+        out << "    \"library_build_type\": \"debug\"";
+#endif
+        for (const auto& [key, value] : context) {
+            out << ",\n    \"" << json_escape(key) << "\": \"" << json_escape(value) << "\"";
+        }
+        out << "\n  },\n  \"benchmarks\": [";
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& [name, m] = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\n";
+            out << "      \"name\": \"" << json_escape(name) << "\",\n";
+            out << "      \"run_name\": \"" << json_escape(name) << "\",\n";
+            out << "      \"run_type\": \"iteration\",\n";
+            out << "      \"repetitions\": " << repetitions << ",\n";
+            out << "      \"threads\": 1,\n";
+            out << "      \"iterations\": " << m.iterations << ",\n";
+            out << "      \"real_time\": " << m.real_ns << ",\n";
+            out << "      \"cpu_time\": " << m.cpu_ns << ",\n";
+            out << "      \"time_unit\": \"ns\"";
+            if (m.items_per_iteration > 0) {
+                out << ",\n      \"items_per_second\": " << static_cast<double>(m.items_per_iteration) * 1e9 / m.real_ns;
+            }
+            if (m.bytes_per_iteration > 0) {
+                out << ",\n      \"bytes_per_second\": " << static_cast<double>(m.bytes_per_iteration) * 1e9 / m.real_ns;
+            }
+            if (!m.label.empty()) out << ",\n      \"label\": \"" << json_escape(m.label) << "\"";
+            out << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+}
+
+namespace adsb::bench {
+
+    void register_benchmark(std::string name, Function function) {
+        benchmarks().push_back({std::move(name), std::move(function)});
+    }
+
+    bool parse_options(int argc, char** argv, Options& options, KeyValues& extra) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--list") {
+                options.list = true;
+                continue;
+            }
+            if (arg.rfind("--", 0) != 0) return false;
+
+            const std::size_t equals = arg.find('=');
+            if (equals == std::string::npos) return false;
+            const std::string key = arg.substr(2, equals - 2);
+            const std::string value = arg.substr(equals + 1);
+
+            if (key == "filter") options.filter = value;
+            else if (key == "min-time") options.min_time = std::atof(value.c_str());
+            else if (key == "repetitions") options.repetitions = std::max(1, std::atoi(value.c_str()));
+            else if (key == "json") options.json_path = value;
+            else extra.emplace_back(key, value);
+        }
+        return options.min_time > 0.0;
+    }
+
+    int run(const Options& options, const KeyValues& context) {
+        std::vector<std::pair<std::string, Measurement>> results;
+
+        if (!options.list) std::printf("%-44s %14s %14s %14s  %s\n", "Benchmark", "Time", "CPU", "Iterations", "Rate");
+        for (const Benchmark& benchmark : benchmarks()) {
+            if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) continue;
+            if (options.list) {
+                std::printf("%s\n", benchmark.name.c_str());
+                continue;
+            }
+
+            const uint64_t iterations = calibrate(benchmark, options.min_time);
+            std::vector<Measurement> runs;
+            for (int r = 0; r < options.repetitions; ++r) runs.push_back(measure(benchmark, iterations));
+            std::sort(runs.begin(), runs.end(), [](const Measurement& a, const Measurement& b) {
+                return a.real_ns < b.real_ns;
+            });
+            const Measurement& median = runs[runs.size() / 2];
+
+            std::string rate;
+            if (median.items_per_iteration > 0) {
+                rate = format_rate(static_cast<double>(median.items_per_iteration) * 1e9 / median.real_ns, "items");
+            }
+            if (median.bytes_per_iteration > 0) {
+                if (!rate.empty()) rate += " ";
+                rate += format_rate(static_cast<double>(median.bytes_per_iteration) * 1e9 / median.real_ns, "B");
+            }
+            if (!median.label.empty()) rate += " " + median.label;
+
+            std::printf("%-44s %11.1f ns %11.1f ns %14llu  %s\n", benchmark.name.c_str(), median.real_ns,
+                        median.cpu_ns, static_cast<unsigned long long>(median.iterations), rate.c_str());
+            std::fflush(stdout);
+            results.emplace_back(benchmark.name, median);
+        }
+
+        if (!options.json_path.empty() && !options.list) write_json(options.json_path, context, results, options.repetitions);
+        return 0;
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace adsb::bench {
+
+    /**
+     * @class State
+     * @brief Handed to a benchmark function: how often to run and what to report.
+     *
+     * A benchmark runs its operation `iterations()` times and may report how
+     * many items (frames, pairs, ...) and bytes one iteration processed.
+     */
+    class State {
+    public:
+        explicit State(uint64_t iterations) : m_iterations(iterations) {}
+
+        uint64_t iterations() const { return m_iterations; }
+
+        /// Items processed per iteration, reported as items per second.
+        void set_items_per_iteration(uint64_t items) { m_items_per_iteration = items; }
+        /// Bytes processed per iteration, reported as bytes per second.
+        void set_bytes_per_iteration(uint64_t bytes) { m_bytes_per_iteration = bytes; }
+        /// Free-form annotation, e.g. a recovery ratio.
+        void set_label(std::string label) { m_label = std::move(label); }
+
+        uint64_t items_per_iteration() const { return m_items_per_iteration; }
+        uint64_t bytes_per_iteration() const { return m_bytes_per_iteration; }
+        const std::string& label() const { return m_label; }
+
+    private:
+        uint64_t m_iterations;
+        uint64_t m_items_per_iteration = 0;
+        uint64_t m_bytes_per_iteration = 0;
+        std::string m_label;
+    };
+
+    using Function = std::function<void(State&)>;
+
+    /**
+     * @brief Adds a benchmark; names use `/` separated groups, e.g. "crc/syndrome/long".
+     */
+    void register_benchmark(std::string name, Function function);
+
+    /**
+     * @brief Keeps a value alive so the compiler cannot remove the computation producing it.
+     */
+    template <typename T>
+    inline void do_not_optimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * @struct Options
+     * @brief Command line options of the harness.
+     */
+    struct Options {
+        std::string filter;             // Only run benchmarks whose name contains this
+        double min_time = 0.5;          // Seconds per repetition
+        int repetitions = 3;            // The median repetition is reported
+        std::string json_path;          // Write a JSON report here
+        bool list = false;              // Print the benchmark names and exit
+    };
+
+    using KeyValues = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @brief Parses `--filter=`, `--min-time=`, `--repetitions=`, `--json=` and `--list`.
+     * @param extra Receives all other `--key=value` arguments.
+     * @return false if an argument is malformed.
+     */
+    bool parse_options(int argc, char** argv, Options& options, KeyValues& extra);
+
+    /**
+     * @brief Runs the selected benchmarks and prints a table.
+     *
+     * The JSON report follows the Google Benchmark schema, so its comparison
+     * tools work on two reports.
+     *
+     * @param context Extra key/value pairs for the `context` of the report (seed, CPU features, ...).
+     * @return The process exit code.
+     */
+    int run(const Options& options, const KeyValues& context);
+
+}
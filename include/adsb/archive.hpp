@@ -0,0 +1,194 @@
+#pragma once
+
+#include "adsb/message/MessageData.hpp"
+#include "adsb/stream.hpp"
+#include "adsb/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace adsb::archive {
+
+    /**
+     * @enum class MessageKind
+     * @brief Message types stored in an archive; the values are the alternatives of message::MessageData.
+     */
+    enum class MessageKind : uint8_t {
+        IDENTIFICATION = 1,
+        AIRBORNE_POSITION = 2,
+        VELOCITY = 3,
+        ALL_CALL = 4,
+        SURVEILLANCE = 5
+    };
+
+    constexpr std::size_t KIND_COUNT = 6;
+
+    /// Bit of a kind in ArchiveQuery::kinds.
+    constexpr uint32_t kind_bit(MessageKind kind) { return uint32_t{1} << static_cast<uint8_t>(kind); }
+
+    constexpr uint32_t ALL_KINDS = 0x3E;
+
+    /// ArchiveQuery::icao value matching every aircraft.
+    constexpr uint32_t ANY_ICAO = 0xFFFFFFFF;
+
+    /**
+     * @struct ChunkIndexEntry
+     * @brief Index record of one chunk, as stored in the `.idx` file.
+     */
+    struct ChunkIndexEntry {
+        uint64_t offset;                // Of the chunk in the data file
+        uint32_t rows;
+        uint8_t kind;                   // MessageKind
+        uint8_t reserved[3];
+        int64_t min_time_ns;
+        int64_t max_time_ns;
+        uint32_t min_icao;
+        uint32_t max_icao;
+    };
+
+    /**
+     * @struct ArchiveWriterOptions
+     * @brief Configuration of an ArchiveWriter.
+     */
+    struct ArchiveWriterOptions {
+        /// Messages per chunk; every message type fills chunks of its own.
+        std::size_t chunk_rows = 65536;
+    };
+
+    /**
+     * @class ArchiveWriter
+     * @brief Appends decoded messages to a columnar archive.
+     *
+     * An archive is a data file plus an index file (`<path>.idx`). Messages
+     * are buffered per message type and written in chunks: a time column, an
+     * ICAO column, and one column per field of the message struct, each a
+     * plain array in native byte order. Rows inside a chunk are sorted by
+     * ICAO address and time, so all messages of one aircraft are adjacent
+     * and found by binary search. For every chunk, the index file receives
+     * a fixed-size record with the time and ICAO ranges it covers.
+     *
+     * A chunk is written to the data file before its index record, so an
+     * interrupted write never leaves a record pointing to missing data.
+     * Reopening an existing archive appends to it. Not thread-safe.
+     */
+    class ArchiveWriter {
+    public:
+        explicit ArchiveWriter(const ArchiveWriterOptions& options = ArchiveWriterOptions{});
+        ~ArchiveWriter();
+
+        ArchiveWriter(const ArchiveWriter&) = delete;
+        ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+        /**
+         * @brief Creates an archive, or opens an existing one for appending.
+         * @return false if the files cannot be opened or are not archives.
+         */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Buffers a message and writes a chunk once enough messages of its type are buffered.
+         * @return false for `std::monostate` or on a write error.
+         */
+        bool append(const message::MessageData& data, types::Timestamp timestamp);
+
+        /**
+         * @brief Writes all buffered messages as (possibly short) chunks and flushes the files.
+         * @return false on a write error.
+         */
+        bool flush();
+
+        /// Flushes and closes the files; called by the destructor.
+        bool close();
+
+        bool is_open() const { return m_data != nullptr; }
+
+    private:
+        bool write_chunk(std::size_t kind);
+
+        ArchiveWriterOptions m_options;
+        std::FILE* m_data = nullptr;
+        std::FILE* m_index = nullptr;
+        uint64_t m_data_size = 0;
+        std::vector<std::pair<int64_t, message::MessageData>> m_pending[KIND_COUNT];
+        std::vector<uint32_t> m_order;          // Scratch: rows of a chunk in (ICAO, time) order
+        std::vector<uint8_t> m_chunk;           // Scratch: the chunk being written
+    };
+
+    /**
+     * @struct ArchiveQuery
+     * @brief Selection of messages to read from an archive.
+     */
+    struct ArchiveQuery {
+        types::Timestamp begin = types::Timestamp::min();
+        types::Timestamp end = types::Timestamp::max();    // Exclusive
+        uint32_t icao = ANY_ICAO;
+        uint32_t kinds = ALL_KINDS;                         // Mask of kind_bit() values
+    };
+
+    /**
+     * @struct ScanStats
+     * @brief What a scan had to read.
+     */
+    struct ScanStats {
+        std::size_t chunks = 0;         // Chunks in the archive
+        std::size_t chunks_read = 0;    // Chunks not excluded by the index
+        std::size_t rows_read = 0;      // Rows whose time (and ICAO) columns were inspected
+        std::size_t matches = 0;        // Messages passed to the callback
+    };
+
+    /**
+     * @class ArchiveReader
+     * @brief Queries a columnar archive through memory maps.
+     *
+     * Both files are mapped read-only, so only the pages a query touches are
+     * read from disk. The index excludes chunks of other message types, of
+     * other times, and whose ICAO range does not contain the queried
+     * aircraft; in the remaining chunks, a queried ICAO address is located by
+     * binary search in the sorted ICAO column. Field columns are only read
+     * for matching rows.
+     *
+     * Queries are const and may run concurrently. POSIX only.
+     */
+    class ArchiveReader {
+    public:
+        ArchiveReader() = default;
+        ~ArchiveReader();
+
+        ArchiveReader(const ArchiveReader&) = delete;
+        ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+        /**
+         * @brief Maps an archive; chunks appended later are not visible until it is opened again.
+         * @return false if the files cannot be mapped or are not archives.
+         */
+        bool open(const std::string& path);
+
+        void close();
+
+        /**
+         * @brief Calls `fn(data, timestamp)` for every message matching the query.
+         *
+         * Messages arrive chunk by chunk in the order the chunks were written,
+         * and sorted by ICAO address and time within a chunk, so those of one
+         * aircraft arrive in time order.
+         */
+        ScanStats scan(const ArchiveQuery& query,
+                       const std::function<void(const message::MessageData&, types::Timestamp)>& fn) const;
+
+        /// The index records of all chunks.
+        const ChunkIndexEntry* chunks() const { return m_entries; }
+        std::size_t chunk_count() const { return m_entry_count; }
+
+    private:
+        stream::MappedFile m_data_file;
+        stream::MappedFile m_index_file;
+        const ChunkIndexEntry* m_entries = nullptr;
+        std::size_t m_entry_count = 0;
+    };
+
+}
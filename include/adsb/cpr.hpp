@@ -0,0 +1,130 @@
+#pragma once
+
+#include "adsb/types.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace adsb::cpr {
+
+    /// Number of distinct values of a 17-bit CPR coordinate.
+    constexpr int CPR_MAX = 131072;
+
+    /// Maximum time between an even and an odd frame for global decoding.
+    constexpr std::chrono::seconds MAX_PAIR_INTERVAL{10};
+
+    /**
+     * @brief Calculates the number of longitude zones (NL) for a given latitude.
+     *
+     * Looks the latitude up in a table of the 58 precomputed NL transition
+     * latitudes instead of evaluating the trigonometric formula.
+     *
+     * @param lat The aircraft's latitude in degrees.
+     * @return The number of longitude zones.
+     */
+    int NL(double lat);
+
+    /**
+     * @brief Decodes a global (unambiguous) position from a pair of even/odd CPR frames.
+     *
+     * This is the pairing-free core of `decoder::calculate_global_position()`:
+     * parity and time window checks are the caller's responsibility. Zone
+     * arithmetic is done in fixed point (units of 2^-17 zone); the result is
+     * bit-exact with the double precision reference equations.
+     *
+     * @param even_lat Raw 17-bit CPR latitude of the even frame.
+     * @param even_lon Raw 17-bit CPR longitude of the even frame.
+     * @param odd_lat Raw 17-bit CPR latitude of the odd frame.
+     * @param odd_lon Raw 17-bit CPR longitude of the odd frame.
+     * @param even_is_newer true if the even frame was received after the odd one.
+     * @return A PositionResult struct. The `is_valid` field is false if the
+     * frames decode to different longitude zone counts (NL), e.g. because
+     * the aircraft crossed a zone boundary between them.
+     */
+    types::PositionResult global_position(int even_lat, int even_lon, int odd_lat, int odd_lon,
+                                          bool even_is_newer);
+
+    /**
+     * @brief Decodes a position from a single CPR frame relative to a nearby reference.
+     *
+     * The result is only correct if the aircraft is within half a CPR zone
+     * of the reference (about 180 NM in latitude), e.g. the receiver or the
+     * aircraft's last known position.
+     *
+     * @param cpr_lat Raw 17-bit CPR latitude.
+     * @param cpr_lon Raw 17-bit CPR longitude.
+     * @param is_odd true for an odd frame.
+     * @param reference The reference position.
+     * @return A PositionResult struct. The `is_valid` field is true on success.
+     */
+    types::PositionResult local_position(int cpr_lat, int cpr_lon, bool is_odd,
+                                         const types::GlobalPosition& reference);
+
+    /**
+     * @struct EncodedPosition
+     * @brief The 17-bit CPR coordinates of a position in one format.
+     */
+    struct EncodedPosition {
+        int cpr_lat;
+        int cpr_lon;
+    };
+
+    /**
+     * @brief Encodes a position into airborne CPR coordinates, the inverse of the decoders above.
+     *
+     * @param latitude Latitude in degrees.
+     * @param longitude Longitude in degrees.
+     * @param is_odd true for the odd format.
+     * @return The CPR coordinates of an even or odd frame.
+     */
+    EncodedPosition encode(double latitude, double longitude, bool is_odd);
+
+    /**
+     * @struct PairBatch
+     * @brief Structure-of-arrays input for `global_position_batch()`.
+     *
+     * Element i of every array describes the i-th even/odd frame pair.
+     * Timestamps are in nanoseconds on any common time base, e.g.
+     * `types::Timestamp::time_since_epoch()`.
+     */
+    struct PairBatch {
+        const int* even_lat;
+        const int* even_lon;
+        const int* odd_lat;
+        const int* odd_lon;
+        const int64_t* even_time_ns;
+        const int64_t* odd_time_ns;
+        std::size_t count;
+    };
+
+    /**
+     * @struct PositionBatch
+     * @brief Structure-of-arrays output of `global_position_batch()`; each array holds `count` elements.
+     */
+    struct PositionBatch {
+        double* latitude;
+        double* longitude;
+        uint8_t* is_valid;              // 1 if the pair decoded to a position, else 0
+    };
+
+    /**
+     * @brief Decodes the global positions of many even/odd frame pairs at once.
+     *
+     * Applies the pairing window (`MAX_PAIR_INTERVAL`) and then the same
+     * equations as `global_position()`, with identical results. On x86-64 CPUs
+     * with AVX2 four pairs are solved per instruction; the implementation is
+     * selected at runtime, with a scalar fallback.
+     *
+     * @param pairs The input pairs.
+     * @param positions Receives one result per pair. Invalid pairs get latitude and longitude 0.
+     * @return The number of valid positions.
+     */
+    std::size_t global_position_batch(const PairBatch& pairs, const PositionBatch& positions);
+
+    /**
+     * @brief Name of the implementation used by `global_position_batch()` on this CPU ("avx2" or "scalar").
+     */
+    const char* batch_implementation();
+
+}
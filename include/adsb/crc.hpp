@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace adsb::crc {
+
+    /**
+     * @enum class ErrorCorrection
+     * @brief Selects how aggressively frames failing the CRC are repaired.
+     */
+    enum class ErrorCorrection {
+        NONE,           // Only frames with a valid CRC are accepted
+        SINGLE_BIT,     // Repair any single flipped bit
+        TWO_BIT         // Additionally repair two flipped bits outside the DF and ICAO fields (long frames only)
+    };
+
+    /**
+     * @brief Computes the CRC syndrome of a packed 56 or 112-bit frame.
+     *
+     * The syndrome is the CRC of the data bits XORed with the transmitted
+     * parity field. It is 0 for an intact DF11/DF17/DF18 frame and equals the
+     * aircraft address for frames using address/parity (DF4/5/20/21).
+     *
+     * @param frame Pointer to the frame bytes.
+     * @param length Frame length in bytes (7 or 14).
+     * @return The 24-bit syndrome.
+     */
+    uint32_t syndrome(const uint8_t* frame, std::size_t length);
+
+    /**
+     * @brief Computes the CRC syndromes of many frames of the same length.
+     *
+     * The syndrome of a frame is the remainder of the whole frame, read as a
+     * polynomial, divided by the generator. On x86-64 CPUs with carry-less
+     * multiplication (PCLMULQDQ) it is computed with two folding multiplies
+     * and a Barrett reduction instead of one table lookup per byte; the
+     * implementation is picked at runtime. Results equal `syndrome()`.
+     *
+     * @param frames Pointer to the first frame; frame `i` starts at `frames + i * stride`.
+     * @param stride Distance in bytes between the starts of two frames (at least `length`).
+     * @param length Length of every frame in bytes (7 or 14).
+     * @param count Number of frames.
+     * @param syndromes Receives one syndrome per frame.
+     * @return The number of frames with a valid CRC (syndrome 0).
+     */
+    std::size_t check_crc_batch(const uint8_t* frames, std::size_t stride, std::size_t length,
+                                std::size_t count, uint32_t* syndromes);
+
+    /**
+     * @brief Name of the implementation used by `check_crc_batch()` on this CPU ("pclmul" or "table").
+     */
+    const char* batch_implementation();
+
+    /**
+     * @brief Checks whether a frame has a valid CRC (syndrome 0).
+     */
+    inline bool check(const uint8_t* frame, std::size_t length) {
+        return syndrome(frame, length) == 0;
+    }
+
+    /**
+     * @brief Repairs a frame given its (non-zero) syndrome.
+     *
+     * The syndrome is looked up in a precomputed syndrome -> bit position
+     * table, so a repair costs a single hash probe regardless of where the
+     * error is.
+     *
+     * @param frame The frame bytes; flipped bits are corrected in place.
+     * @param length Frame length in bytes (7 or 14).
+     * @param syndrome The syndrome returned by `syndrome()` for this frame.
+     * @param mode The correction mode; `NONE` never modifies the frame.
+     * @return The number of corrected bits (1 or 2), or 0 if the frame could not be repaired.
+     */
+    int correct(uint8_t* frame, std::size_t length, uint32_t syndrome, ErrorCorrection mode);
+
+}
@@ -1,16 +1,135 @@
 #pragma once
 
+#include "adsb/crc.hpp"
+#include "adsb/icao_filter.hpp"
+#include "adsb/icao_set.hpp"
+#include "adsb/stats.hpp"
 #include "adsb/types.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "message/ADSBMessage.hpp"
 #include "message/AirbornePositionMessage.hpp"
+#include "message/MessageData.hpp"
 
 
 namespace adsb::decoder {
 
+    /// Mask bit selecting ADS-B messages with this type code (0-31).
+    constexpr uint32_t type_code_bit(int type_code) { return uint32_t{1} << type_code; }
+    /// Mask bit selecting frames with this downlink format (0-24).
+    constexpr uint32_t downlink_format_bit(int df) { return uint32_t{1} << df; }
+
+    constexpr uint32_t ALL_TYPE_CODES = 0xFFFFFFFF;
+    constexpr uint32_t ALL_DOWNLINK_FORMATS = 0xFFFFFFFF;
+
+    /**
+     * @struct DecoderOptions
+     * @brief Tunables for the packed-frame decoding path.
+     */
+    struct DecoderOptions {
+        /// Repair mode for frames that fail the CRC check.
+        crc::ErrorCorrection error_correction = crc::ErrorCorrection::SINGLE_BIT;
+        /// Addresses confirmed by DF11/DF17 frames are added to this set, and
+        /// DF4/5/20/21 frames are decoded only if their address is in it.
+        /// Without a set, only DF11 and DF17 frames are decoded. The caller
+        /// keeps the set's clock running with `IcaoSet::advance()`.
+        IcaoSet* known_aircraft = nullptr;
+
+        // Filters, applied right after the CRC check and before any field is
+        // decoded; rejected frames cost little more than the CRC itself.
+
+        /// Downlink formats to decode, see `downlink_format_bit()`.
+        uint32_t downlink_format_mask = ALL_DOWNLINK_FORMATS;
+        /// Type codes of ADS-B (DF17) messages to decode, see `type_code_bit()`.
+        uint32_t type_code_mask = ALL_TYPE_CODES;
+        /// If set, only frames of aircraft accepted by the filter are decoded.
+        const IcaoFilter* icao_filter = nullptr;
+    };
+
+    /**
+     * @struct CorrectionStats
+     * @brief Counts how many frames each error correction mode rescued.
+     *
+     * The counters are plain integers owned by the caller; use one instance per thread.
+     */
+    struct CorrectionStats {
+        uint64_t single_bit = 0;
+        uint64_t two_bit = 0;
+    };
+
+    /**
+     * @struct MessageDeleter
+     * @brief Destroys a message allocated from a memory resource and returns its memory there.
+     */
+    struct MessageDeleter {
+        std::pmr::memory_resource* resource = nullptr;
+        std::size_t size = 0;
+
+        void operator()(message::ADSBMessage* message) const;
+    };
+
+    /// A message object owned by the memory resource it was decoded into.
+    using MessagePtr = std::unique_ptr<message::ADSBMessage, MessageDeleter>;
+
+    /**
+     * @class MessageArena
+     * @brief Memory resource for decoding a batch of message objects, released in one `reset()`.
+     *
+     * Allocations bump a pointer through a list of blocks and deallocation
+     * does nothing. `reset()` rewinds to the first block but keeps all
+     * blocks, so once the arena has grown to the size of a batch, decoding
+     * further batches does not call malloc/free at all. Not thread-safe;
+     * use one arena per thread.
+     */
+    class MessageArena : public std::pmr::memory_resource {
+    public:
+        explicit MessageArena(std::size_t block_bytes = 64 * 1024);
+
+        MessageArena(const MessageArena&) = delete;
+        MessageArena& operator=(const MessageArena&) = delete;
+
+        /**
+         * @brief Makes all memory available again.
+         *
+         * Every message decoded into the arena must have been destroyed
+         * (its MessagePtr reset) before.
+         */
+        void reset();
+
+        /// Bytes handed out since the last reset.
+        std::size_t allocated() const { return m_allocated; }
+        /// Bytes held in blocks.
+        std::size_t capacity() const { return m_capacity; }
+
+    private:
+        /**
+         * @struct Block
+         * @brief A chunk of memory obtained from the heap.
+         */
+        struct Block {
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t size;
+        };
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        std::vector<Block> m_blocks;
+        std::size_t m_block_bytes;
+        std::size_t m_block = 0;                // Block allocations are taken from
+        std::size_t m_offset = 0;               // First free byte in that block
+        std::size_t m_allocated = 0;
+        std::size_t m_capacity = 0;
+    };
+
     /**
      * @brief Decodes a raw 112-bit ADS-B message.
      *
@@ -20,12 +139,265 @@ namespace adsb::decoder {
      */
     std::unique_ptr<message::ADSBMessage> decode(const std::vector<int>& raw_bits);
 
+    /**
+     * @brief Decodes a packed Mode S frame.
+     *
+     * This is the primary decoding entry point: the frame is read directly from
+     * the byte buffer, as delivered by Beast/AVR feeds or a demodulator.
+     *
+     * @param frame Pointer to the frame bytes, MSB of the first byte is bit 1 of the message.
+     * @param length Frame length in bytes: `types::LONG_FRAME_BYTES` (112 bits)
+     * or `types::SHORT_FRAME_BYTES` (56 bits).
+     * @return A unique_ptr to the decoded ADSBMessage object.
+     * Returns `nullptr` if the message is invalid, unsupported or the CRC fails.
+     */
+    std::unique_ptr<message::ADSBMessage> decode(const uint8_t* frame, std::size_t length);
+
+    /**
+     * @brief Decodes a packed Mode S frame with explicit options.
+     *
+     * @param frame Pointer to the frame bytes.
+     * @param length Frame length in bytes (7 or 14).
+     * @param options Decoder options, e.g. the error correction mode.
+     * @param stats Optional counters updated when a frame is repaired.
+     * @return A unique_ptr to the decoded ADSBMessage object, or `nullptr`.
+     */
+    std::unique_ptr<message::ADSBMessage> decode(const uint8_t* frame, std::size_t length,
+                                                 const DecoderOptions& options,
+                                                 CorrectionStats* stats = nullptr);
+
+    /**
+     * @brief Decodes a packed Mode S frame stamped with the caller's reception time.
+     *
+     * The other overloads stamp messages with `steady_clock::now()`. Passing
+     * the receiver's own timestamp (see `types::from_mlat_ticks()` and
+     * `types::from_nanoseconds()`) avoids the clock read and keeps CPR
+     * pairing correct when recorded data is replayed faster than real time.
+     *
+     * @param frame Pointer to the frame bytes.
+     * @param length Frame length in bytes (7 or 14).
+     * @param timestamp Reception time of the frame.
+     * @param options Decoder options, e.g. the error correction mode.
+     * @param stats Optional counters updated when a frame is repaired.
+     * @return A unique_ptr to the decoded ADSBMessage object, or `nullptr`.
+     */
+    std::unique_ptr<message::ADSBMessage> decode(const uint8_t* frame, std::size_t length,
+                                                 types::Timestamp timestamp,
+                                                 const DecoderOptions& options = DecoderOptions{},
+                                                 CorrectionStats* stats = nullptr);
+
+    /**
+     * @brief Decodes a packed Mode S frame into a message object allocated from a memory resource.
+     *
+     * Same as the other `decode()` overloads, but the message object is
+     * placed in `resource` instead of on the heap, e.g. a MessageArena or a
+     * `std::pmr::monotonic_buffer_resource` that is released after each
+     * batch of frames. The messages must be destroyed before the resource
+     * is released.
+     *
+     * @param frame Pointer to the frame bytes.
+     * @param length Frame length in bytes (7 or 14).
+     * @param timestamp Reception time of the frame.
+     * @param resource Memory resource for the message object; must not be null.
+     * @param options Decoder options, e.g. the error correction mode.
+     * @param stats Optional counters updated when a frame is repaired.
+     * @return The decoded message, or `nullptr`.
+     */
+    MessagePtr decode(const uint8_t* frame, std::size_t length, types::Timestamp timestamp,
+                      std::pmr::memory_resource* resource,
+                      const DecoderOptions& options = DecoderOptions{},
+                      CorrectionStats* stats = nullptr);
+
+    /**
+     * @brief Decodes a packed Mode S frame, stamped with `steady_clock::now()`, into a memory resource.
+     * @see decode(const uint8_t*, std::size_t, types::Timestamp, std::pmr::memory_resource*, const DecoderOptions&, CorrectionStats*)
+     */
+    MessagePtr decode(const uint8_t* frame, std::size_t length, std::pmr::memory_resource* resource,
+                      const DecoderOptions& options = DecoderOptions{},
+                      CorrectionStats* stats = nullptr);
+
+    /**
+     * @brief Decodes a hex encoded Mode S frame.
+     *
+     * @param hex The frame as hex text, either plain (`8D4840D6...`) or AVR (`*8D4840D6...;`).
+     * @return A unique_ptr to the decoded ADSBMessage object.
+     * Returns `nullptr` if the text is malformed, the message is invalid or the CRC fails.
+     */
+    std::unique_ptr<message::ADSBMessage> decode(std::string_view hex);
+
+    /**
+     * @brief Decodes a packed Mode S frame into a caller-provided value.
+     *
+     * Unlike `decode()`, this performs no heap allocation and no virtual
+     * dispatch: the result is a plain struct stored in `out`, which may live
+     * on the stack or in a preallocated buffer and be reused across frames.
+     *
+     * @param frame Pointer to the frame bytes.
+     * @param length Frame length in bytes (7 or 14).
+     * @param out Receives the decoded message, or `std::monostate` on failure.
+     * @param options Decoder options, e.g. the error correction mode.
+     * @param stats Optional counters updated when a frame is repaired.
+     * @return true if a supported message was decoded.
+     */
+    bool decode_into(const uint8_t* frame, std::size_t length, message::MessageData& out,
+                     const DecoderOptions& options = DecoderOptions{},
+                     CorrectionStats* stats = nullptr);
+
+    /**
+     * @brief Decodes a packed Mode S frame whose CRC syndrome is already known.
+     *
+     * Same as the other `decode_into()`, for callers that compute the
+     * syndromes of many frames at once with `crc::check_crc_batch()`.
+     *
+     * @param syndrome The syndrome of the frame as received, i.e. `crc::syndrome(frame, length)`.
+     */
+    bool decode_into(const uint8_t* frame, std::size_t length, uint32_t syndrome, message::MessageData& out,
+                     const DecoderOptions& options = DecoderOptions{},
+                     CorrectionStats* stats = nullptr);
+
+    /**
+     * @brief Decodes a packed Mode S frame into a value-type result.
+     *
+     * @return The decoded message; holds `std::monostate` if the frame is
+     * invalid, unsupported or the CRC fails.
+     * @see decode_into
+     */
+    message::MessageData decode_value(const uint8_t* frame, std::size_t length,
+                                      const DecoderOptions& options = DecoderOptions{},
+                                      CorrectionStats* stats = nullptr);
+
+    namespace detail {
+        /**
+         * @struct FrameHeader
+         * @brief Fields shared by every supported message, read once per frame.
+         */
+        struct FrameHeader {
+            int df;
+            uint32_t icao;
+            int type_code;              // ADS-B type code (DF17 only)
+            uint64_t payload;           // ME field (DF17) or MB field (DF20/21)
+            uint32_t head;              // First 32 bits of the frame
+            uint32_t syndrome;
+        };
+
+        /// Validates (and if needed repairs) a frame and extracts its header; applies the filters of `options`.
+        /// `syndrome` is the precomputed CRC syndrome of the frame, or nullptr to compute it here.
+        bool read_header(const uint8_t* frame, std::size_t length, const DecoderOptions& options,
+                         CorrectionStats* stats, FrameHeader& header, const uint32_t* syndrome = nullptr);
+
+        /// Counts the outcome of a frame that passed read_header().
+        void count_result(const FrameHeader& header, bool decoded);
+
+        /**
+         * @struct VisitorFilter
+         * @brief The message structs a decode_visit() visitor accepts, as decoder masks.
+         */
+        template <typename Visitor>
+        struct VisitorFilter {
+            static constexpr bool IDENTIFICATION = std::is_invocable_v<Visitor&, const message::IdentificationData&>;
+            static constexpr bool AIRBORNE_POSITION = std::is_invocable_v<Visitor&, const message::AirbornePositionData&>;
+            static constexpr bool VELOCITY = std::is_invocable_v<Visitor&, const message::VelocityData&>;
+            static constexpr bool ALL_CALL = std::is_invocable_v<Visitor&, const message::AllCallData&>;
+            static constexpr bool SURVEILLANCE = std::is_invocable_v<Visitor&, const message::SurveillanceData&>;
+
+            static constexpr uint32_t TYPE_CODES = (IDENTIFICATION ? 0x1Eu : 0u)             // 1-4
+                                                 | (AIRBORNE_POSITION ? 0x7FE00u : 0u)        // 9-18
+                                                 | (VELOCITY ? type_code_bit(19) : 0u);
+            // Other formats stay enabled: a bit error in the format field may be repaired to DF17
+            static constexpr uint32_t DOWNLINK_FORMATS = ALL_DOWNLINK_FORMATS
+                & ~(TYPE_CODES != 0 ? 0u : downlink_format_bit(17))
+                & ~(ALL_CALL ? 0u : downlink_format_bit(11))
+                & ~(SURVEILLANCE ? 0u : downlink_format_bit(4) | downlink_format_bit(5) | downlink_format_bit(20)
+                                            | downlink_format_bit(21));
+        };
+    }
+
+    /**
+     * @brief Decodes a packed Mode S frame and passes the decoded struct to a visitor.
+     *
+     * The visitor is called with the concrete message struct
+     * (`message::IdentificationData`, `message::VelocityData`, ...), with no
+     * message object, variant or virtual call in between, so the handler can
+     * be inlined into the decoding loop. Message types the visitor has no
+     * overload for are found at compile time and added to the downlink format
+     * and type code filters of `options`: their frames are dropped as early
+     * as possible and their fields are never decoded.
+     *
+     * @code
+     * decoder::decode_visit(frame, length, utils::overloaded{
+     *     [&](const message::AirbornePositionData& position) { ... },
+     *     [&](const message::VelocityData& velocity) { ... },
+     * });
+     * @endcode
+     *
+     * With `options.known_aircraft` set, DF11 and DF17 frames the visitor
+     * has no overload for are still checked, so that they keep confirming
+     * addresses for the surveillance replies.
+     *
+     * @param frame Pointer to the frame bytes.
+     * @param length Frame length in bytes (7 or 14).
+     * @param visitor Callable with one or more of the message structs.
+     * @param options Decoder options, e.g. the error correction mode.
+     * @param stats Optional counters updated when a frame is repaired.
+     * @return true if the visitor was called.
+     */
+    template <typename Visitor>
+    bool decode_visit(const uint8_t* frame, std::size_t length, Visitor&& visitor,
+                      const DecoderOptions& options = DecoderOptions{},
+                      CorrectionStats* stats = nullptr) {
+        using Filter = detail::VisitorFilter<std::remove_reference_t<Visitor>>;
+        static_assert(Filter::TYPE_CODES != 0 || Filter::ALL_CALL || Filter::SURVEILLANCE,
+                      "the visitor accepts none of the message structs");
+        ADSB_STATS_TIMER(DECODE);
+
+        DecoderOptions filtered = options;
+        filtered.downlink_format_mask &= Filter::DOWNLINK_FORMATS;
+        filtered.type_code_mask &= Filter::TYPE_CODES;
+
+        detail::FrameHeader header{};
+        if (!detail::read_header(frame, length, filtered, stats, header)) return false;
+
+        bool visited = false;
+        if (header.df == 11) {
+            if constexpr (Filter::ALL_CALL) {
+                visitor(message::decode_all_call(header.icao, header.head, header.syndrome));
+                visited = true;
+            }
+        } else if (header.df != 17) {
+            if constexpr (Filter::SURVEILLANCE) {
+                visitor(message::decode_surveillance(header.icao, header.head, header.payload));
+                visited = true;
+            }
+        } else if (header.type_code >= 1 && header.type_code <= 4) {
+            if constexpr (Filter::IDENTIFICATION) {
+                visitor(message::decode_identification(header.icao, header.type_code, header.payload));
+                visited = true;
+            }
+        } else if (header.type_code >= 9 && header.type_code <= 18) {
+            if constexpr (Filter::AIRBORNE_POSITION) {
+                visitor(message::decode_airborne_position(header.icao, header.type_code, header.payload));
+                visited = true;
+            }
+        } else if (header.type_code == 19) {
+            if constexpr (Filter::VELOCITY) {
+                visitor(message::decode_velocity(header.icao, header.type_code, header.payload));
+                visited = true;
+            }
+        }
+
+        // The filters above leave only frames the visitor handles
+        if (visited) detail::count_result(header, true);
+        else ADSB_STATS_COUNT(REJECTED_FILTER);
+        return visited;
+    }
+
     /**
      * @brief Calculates the global position from a pair of airborne position messages.
      *
      * @param msg_a The first AirbornePositionMessage.
      * @param msg_b The second AirbornePositionMessage.
-     * @param ref_pos The reference position of the receiver.
+     * @param ref_pos The reference position of the receiver. Airborne global
+     * decoding is unambiguous, so it is currently not needed.
      * @return A PositionResult struct. The `is_valid` field is true on success.
      */
     types::PositionResult calculate_global_position(
@@ -33,4 +405,42 @@ namespace adsb::decoder {
         const message::AirbornePositionMessage& msg_b,
         const types::GlobalPosition& ref_pos);
 
+    /**
+     * @brief Calculates the global position from a pair of decoded airborne position frames.
+     *
+     * @param frame_a The first frame.
+     * @param time_a Reception time of the first frame.
+     * @param frame_b The second frame.
+     * @param time_b Reception time of the second frame.
+     * @param ref_pos The reference position of the receiver (currently not needed).
+     * @return A PositionResult struct. The `is_valid` field is true on success.
+     */
+    types::PositionResult calculate_global_position(
+        const message::AirbornePositionData& frame_a, types::Timestamp time_a,
+        const message::AirbornePositionData& frame_b, types::Timestamp time_b,
+        const types::GlobalPosition& ref_pos);
+
+    /**
+     * @brief Calculates the position from a single airborne position message.
+     *
+     * Local decoding needs no even/odd pair, but the reference must be within
+     * about 180 NM of the aircraft: use the receiver position for a first
+     * fix of nearby aircraft, or the aircraft's last known position.
+     *
+     * @param msg The AirbornePositionMessage.
+     * @param reference The reference position.
+     * @return A PositionResult struct. The `is_valid` field is true on success.
+     */
+    types::PositionResult calculate_local_position(
+        const message::AirbornePositionMessage& msg,
+        const types::GlobalPosition& reference);
+
+    /**
+     * @brief Calculates the position from a single decoded airborne position frame.
+     * @see calculate_local_position(const message::AirbornePositionMessage&, const types::GlobalPosition&)
+     */
+    types::PositionResult calculate_local_position(
+        const message::AirbornePositionData& frame,
+        const types::GlobalPosition& reference);
+
 }
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "adsb/types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace adsb::dedup {
+
+    /// Receivers that can be told apart; larger ids are folded onto these.
+    constexpr uint32_t MAX_RECEIVERS = 40;
+
+    /**
+     * @struct DuplicateFilterOptions
+     * @brief Configuration of a DuplicateFilter.
+     */
+    struct DuplicateFilterOptions {
+        /// How long a frame is remembered; copies arriving later count as new frames.
+        std::chrono::milliseconds window{1000};
+        /// Time buckets the window is divided into (at least 2); more buckets expire entries closer to `window`.
+        std::size_t buckets = 4;
+        /// Expected number of distinct frames per window.
+        std::size_t capacity = 65536;
+    };
+
+    /**
+     * @struct Sighting
+     * @brief Result of DuplicateFilter::check().
+     */
+    struct Sighting {
+        bool duplicate;         // Another receiver already reported this transmission
+        uint64_t receivers;     // Bit i set if receiver i reported it so far, including this call
+    };
+
+    /**
+     * @class DuplicateFilter
+     * @brief Suppresses copies of one transmission reported by several receivers.
+     *
+     * Frames are keyed on a 64-bit hash of their raw bytes and remembered for
+     * a time window, so overlapping receivers can share one filter in front
+     * of the decoder and only the first copy of each transmission is decoded
+     * and tracked. The filter also records which receivers heard each frame.
+     *
+     * The window is split into time buckets, each an open-addressing table of
+     * cache-line sized groups of slots. A frame is inserted into the bucket of
+     * its timestamp and looked up in all buckets of the window. Every slot is
+     * tagged with the bucket's generation, so slots of an expired generation
+     * are simply claimed again when the bucket is reused: rotating a bucket
+     * costs nothing and nothing is ever erased.
+     *
+     * A receiver cannot hear the same transmission twice, so a frame already
+     * reported by the same receiver is a new transmission with identical
+     * content (e.g. an unchanged velocity message) and is not suppressed.
+     * The window should therefore cover the latency differences between the
+     * receivers, but stay well below the interval of such retransmissions;
+     * a copy of a repeat that reaches another receiver first is merged into
+     * the earlier entry (it carries no new data anyway).
+     *
+     * Timestamps of all receivers must share one time base, such as the
+     * arrival time at the host. Copies that differ in a bit error are not
+     * recognized; the decoder repairs them afterwards. All members may be
+     * called concurrently from any thread.
+     */
+    class DuplicateFilter {
+    public:
+        explicit DuplicateFilter(const DuplicateFilterOptions& options = DuplicateFilterOptions{});
+
+        /**
+         * @brief Records a frame heard by a receiver.
+         *
+         * @param frame The raw frame bytes.
+         * @param length Frame length in bytes.
+         * @param timestamp Reception time of the frame.
+         * @param receiver Id of the receiver that heard it (< MAX_RECEIVERS).
+         * @return Whether this is a copy of an earlier frame, and who has heard it.
+         */
+        Sighting check(const uint8_t* frame, std::size_t length, types::Timestamp timestamp, uint32_t receiver);
+
+        /**
+         * @brief The receivers that reported a frame within the window ending at `timestamp`.
+         * @return A receiver bit mask, 0 if the frame is not known.
+         */
+        uint64_t receivers(const uint8_t* frame, std::size_t length, types::Timestamp timestamp) const;
+
+        /// Frames that were passed on unchecked because their slot group was full.
+        uint64_t overflows() const { return m_overflows.load(std::memory_order_relaxed); }
+
+        std::size_t capacity() const { return m_groups * SLOTS_PER_GROUP * m_buckets; }
+
+    private:
+        static constexpr std::size_t SLOTS_PER_GROUP = 4;
+
+        /// A frame: key (hash fragment, occupied flag, generation) and receivers (mask, generation).
+        struct Slot {
+            std::atomic<uint64_t> key;
+            std::atomic<uint64_t> receivers;
+        };
+
+        struct alignas(64) Group {
+            Slot slots[SLOTS_PER_GROUP];
+        };
+
+        Group& group(std::size_t bucket, uint64_t hash) const;
+        Slot* find(std::size_t bucket, uint64_t hash, uint32_t generation) const;
+
+        std::unique_ptr<Group[]> m_groups_storage;
+        std::size_t m_groups;                   // Per bucket
+        std::size_t m_buckets;
+        unsigned m_shift;
+        int64_t m_span_ns;                      // Time covered by one generation
+        std::atomic<uint64_t> m_overflows;
+    };
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "adsb/crc.hpp"
+#include "adsb/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace adsb::demod {
+
+    /**
+     * @enum class SampleFormat
+     * @brief Encoding of the interleaved I/Q input samples.
+     */
+    enum class SampleFormat {
+        UC8,            // Unsigned 8-bit I/Q, centered at 127.5 (RTL-SDR)
+        SC16            // Signed 16-bit little-endian I/Q
+    };
+
+    /**
+     * @enum class SampleRate
+     * @brief Supported input sample rates.
+     */
+    enum class SampleRate {
+        MSPS_2_0,       // 2 samples per microsecond, one sample per half-bit; bits are sliced at six phases
+        MSPS_2_4        // 2.4 samples per microsecond, bits are sliced at five phases
+    };
+
+    /**
+     * @struct DemodulatorOptions
+     * @brief Configuration of a Demodulator.
+     */
+    struct DemodulatorOptions {
+        SampleFormat format = SampleFormat::UC8;
+        SampleRate sample_rate = SampleRate::MSPS_2_0;
+        /// Repair mode for frames that fail the CRC check.
+        crc::ErrorCorrection error_correction = crc::ErrorCorrection::SINGLE_BIT;
+        /// Minimum preamble pulse magnitude (0-32767) to attempt a decode.
+        uint16_t min_signal = 400;
+    };
+
+    /**
+     * @struct DemodFrame
+     * @brief A Mode S frame recovered from the sample stream, with a valid CRC.
+     */
+    struct DemodFrame {
+        uint8_t data[types::LONG_FRAME_BYTES];
+        std::size_t length;             // types::SHORT_FRAME_BYTES or types::LONG_FRAME_BYTES
+        uint64_t sample_index;          // Index of the first preamble sample since the stream started
+        uint64_t mlat_ticks;            // Start of the preamble in 12 MHz ticks, as used by Beast feeds
+        uint16_t signal;                // Mean preamble pulse magnitude (0-32767)
+        int corrected_bits;             // Bits repaired by error correction
+
+        types::Timestamp timestamp() const { return types::from_mlat_ticks(mlat_ticks); }
+    };
+
+    /**
+     * @class Demodulator
+     * @brief Recovers Mode S frames from raw I/Q samples.
+     *
+     * Samples are converted to magnitudes (through a lookup table for 8-bit
+     * input), preambles are detected several sample positions per
+     * instruction, and bits are sliced by comparing the energy of the two
+     * half-bit chips. Frames rarely start on a sample boundary: every
+     * sub-sample phase (in 12 MHz ticks) is tried, best matching preamble
+     * first. The CRC is checked as part of demodulation, so only
+     * DF11/DF17/DF18 frames that pass it (after optional repair) are
+     * reported; frames using address/parity cannot be verified here.
+     *
+     * Samples may be passed in buffers of any size; the end of each buffer
+     * is kept so that frames crossing buffer boundaries are found. The class
+     * is not thread-safe.
+     */
+    class Demodulator {
+    public:
+        explicit Demodulator(const DemodulatorOptions& options = DemodulatorOptions{});
+
+        /**
+         * @brief Demodulates the next block of samples.
+         *
+         * @param samples Interleaved I/Q samples in the configured format.
+         * @param bytes Size of the block in bytes.
+         * @param on_frame Called as `on_frame(const DemodFrame&)` for every frame found.
+         * @return The number of frames passed to `on_frame`.
+         */
+        template <typename Fn>
+        std::size_t process(const uint8_t* samples, std::size_t bytes, Fn&& on_frame) {
+            demodulate(samples, bytes);
+            for (const DemodFrame& frame : m_frames) on_frame(frame);
+            return m_frames.size();
+        }
+
+        /// Forgets buffered samples, e.g. after a gap in the input.
+        void reset();
+
+        /// Number of complex samples consumed so far.
+        uint64_t samples_processed() const { return m_samples_processed; }
+
+    private:
+        /**
+         * @struct ChipTap
+         * @brief Samples covered by one half-bit chip and their weights (in 12 MHz ticks).
+         *
+         * `lead` and `trail` weigh the parts of the previous and the next chip
+         * that fall into the same samples, for decision feedback.
+         */
+        struct ChipTap {
+            uint16_t sample;
+            uint8_t weight[2];
+            uint8_t lead;
+            uint8_t trail;
+        };
+
+        void demodulate(const uint8_t* samples, std::size_t bytes);
+        void append_magnitudes(const uint8_t* samples, std::size_t count);
+        unsigned detect_block(std::size_t position) const;
+        int preamble_score(std::size_t position, unsigned phase) const;
+        bool try_decode(std::size_t position, DemodFrame& frame) const;
+        bool slice(std::size_t position, unsigned phase, crc::ErrorCorrection correction, bool feedback,
+                   DemodFrame& frame) const;
+
+        DemodulatorOptions m_options;
+        unsigned m_ticks_per_sample;
+        unsigned m_phases;              // Slicing phases in ticks: every tick of a sample, plus the next sample
+        std::size_t m_window;           // Samples needed after a preamble start to hold a long frame
+        std::vector<ChipTap> m_taps;    // m_phases x (16 preamble + 2 * 112 data) chips
+        std::vector<uint16_t> m_magnitude;
+        std::size_t m_size;             // Valid entries in m_magnitude
+        uint64_t m_buffer_start;        // Sample index of m_magnitude[0]
+        uint64_t m_resume;              // First sample index where a new preamble may start
+        uint64_t m_samples_processed;
+        uint8_t m_partial[4];           // Bytes of an incomplete I/Q sample
+        std::size_t m_partial_size;
+        std::vector<DemodFrame> m_frames;
+    };
+
+    /**
+     * @brief Name of the preamble detector used on this build ("sse2" or "scalar").
+     */
+    const char* implementation();
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "adsb/message/MessageData.hpp"
+#include "adsb/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace adsb::encoder {
+
+    /// Capability field of an airborne transponder with level 2 or above (CA=5).
+    constexpr int CAPABILITY_AIRBORNE = 5;
+
+    /**
+     * @brief Writes a DF17 (extended squitter) frame including its parity.
+     *
+     * @param icao The 24-bit ICAO address.
+     * @param payload The 56-bit ME field, right-aligned, e.g. from `message::encode_velocity()`.
+     * @param frame Receives `types::LONG_FRAME_BYTES` bytes.
+     * @param capability The CA field (0-7).
+     */
+    void encode_extended_squitter(uint32_t icao, uint64_t payload, uint8_t* frame,
+                                  int capability = CAPABILITY_AIRBORNE);
+
+    /**
+     * @brief Encodes a decoded message back into a frame.
+     *
+     * Identification, airborne position and velocity messages become DF17
+     * frames, all-call replies DF11 frames with the interrogator code in the
+     * parity field. Surveillance replies are not supported.
+     *
+     * @param data The message.
+     * @param frame Receives the frame; must hold `types::LONG_FRAME_BYTES` bytes.
+     * @return The frame length in bytes, or 0 if the message cannot be encoded.
+     */
+    std::size_t encode(const message::MessageData& data, uint8_t* frame);
+
+    /**
+     * @brief Computes and stores the parity field of a frame whose other bits are set.
+     *
+     * @param frame The frame; its last three bytes are overwritten.
+     * @param length Frame length in bytes (7 or 14).
+     * @param overlay Value XORed into the parity, e.g. the interrogator code of a DF11 reply.
+     */
+    void set_parity(uint8_t* frame, std::size_t length, uint32_t overlay = 0);
+
+    /**
+     * @class BitErrorInjector
+     * @brief Flips bits of a frame stream at a given bit error rate.
+     *
+     * Every bit is flipped independently with the given probability. Instead
+     * of drawing a random number per bit, the distance to the next error is
+     * drawn from the geometric distribution, so clean frames cost a single
+     * comparison. The sequence of errors depends only on the seed.
+     */
+    class BitErrorInjector {
+    public:
+        BitErrorInjector(double bit_error_rate, uint64_t seed);
+
+        /**
+         * @brief Applies the errors falling into the next `length` bytes of the stream.
+         * @return The number of flipped bits.
+         */
+        std::size_t apply(uint8_t* frame, std::size_t length) {
+            const uint64_t bits = length * 8;
+            if (m_bits_to_next_error >= bits) {
+                m_bits_to_next_error -= bits;
+                return 0;
+            }
+            return apply_errors(frame, bits);
+        }
+
+    private:
+        std::size_t apply_errors(uint8_t* frame, uint64_t bits);
+        uint64_t next_gap();
+
+        double m_log_keep;              // log(1 - bit error rate), 0 if no errors are injected
+        uint64_t m_state;
+        uint64_t m_bits_to_next_error;
+    };
+
+}
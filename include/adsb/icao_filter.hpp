@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace adsb::decoder {
+
+    /**
+     * @class IcaoFilter
+     * @brief Immutable allow or deny list of aircraft addresses.
+     *
+     * Checked by the decoder right after the address is extracted, so frames
+     * of uninteresting aircraft are dropped before any field is decoded.
+     * A 4096-bit summary of the list (512 bytes, always in cache) answers
+     * most lookups for addresses that are not listed; only candidates are
+     * confirmed by a binary search in the sorted list.
+     *
+     * The filter is never modified after construction and may be shared
+     * between threads.
+     */
+    class IcaoFilter {
+    public:
+        enum class Mode {
+            ALLOW,          // Accept only the listed addresses
+            DENY            // Accept every address except the listed ones
+        };
+
+        IcaoFilter(Mode mode, std::vector<uint32_t> addresses);
+
+        /// true if frames of this aircraft should be decoded.
+        bool accepts(uint32_t icao) const {
+            return is_listed(icao) == (m_mode == Mode::ALLOW);
+        }
+
+        bool is_listed(uint32_t icao) const {
+            const uint32_t bit = summary_bit(icao);
+            if ((m_summary[bit >> 6] & (uint64_t{1} << (bit & 63))) == 0) return false;
+            return contains(icao);
+        }
+
+        Mode mode() const { return m_mode; }
+        std::size_t size() const { return m_addresses.size(); }
+
+    private:
+        static constexpr unsigned SUMMARY_BITS = 12;
+
+        static uint32_t summary_bit(uint32_t icao) {
+            return static_cast<uint32_t>(((icao & 0xFFFFFF) * 0x9E3779B97F4A7C15ULL) >> (64 - SUMMARY_BITS));
+        }
+
+        bool contains(uint32_t icao) const;
+
+        Mode m_mode;
+        std::vector<uint32_t> m_addresses;     // Sorted, unique
+        uint64_t m_summary[(1u << SUMMARY_BITS) / 64];
+    };
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "adsb/types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace adsb::decoder {
+
+    /**
+     * @class IcaoSet
+     * @brief Concurrent set of recently confirmed aircraft addresses.
+     *
+     * Frames using address/parity (DF4/5/20/21) carry their ICAO address
+     * only XORed into the CRC, so any corrupted frame decodes to some
+     * address. Such frames are trusted only if their address was recently
+     * confirmed by a frame with a verifiable CRC (DF11/DF17).
+     *
+     * Addresses are stored in buckets of eight atomic slots, one cache line
+     * each, so a lookup touches a single line. Every entry remembers when it
+     * was last confirmed and is ignored once older than the time-to-live;
+     * stale slots are reused by inserts and cleared incrementally by
+     * `advance()`. All members may be called concurrently from any thread.
+     *
+     * The set has no clock of its own: time only passes through `advance()`.
+     * The decoder never calls it, so whoever feeds the decoder must, with
+     * the time of the frames; `pipeline::Pipeline` does so for every frame.
+     * Without it, confirmed addresses never expire.
+     */
+    class IcaoSet {
+    public:
+        /**
+         * @param capacity Expected number of addresses; the table holds twice as many slots.
+         * @param ttl How long an address stays confirmed.
+         */
+        explicit IcaoSet(std::size_t capacity = 4096, std::chrono::seconds ttl = std::chrono::seconds(60));
+
+        /// Marks an address as confirmed now.
+        void insert(uint32_t icao);
+
+        /// true if the address was confirmed within the time-to-live.
+        bool contains(uint32_t icao) const;
+
+        /**
+         * @brief Sets the current time and, once per second, clears a few stale slots.
+         *
+         * Call with the time of the frames being decoded, as often as every
+         * frame: within the same second this is a single load. Entries are
+         * aged relative to the last value; the threads of a decoder may
+         * disagree by a few seconds, as entries up to the time-to-live ahead
+         * of the current time count as fresh.
+         *
+         * @param now The current time.
+         * @param slots Number of slots to inspect for stale entries.
+         */
+        void advance(types::Timestamp now, std::size_t slots = 64);
+
+        std::size_t capacity() const { return m_bucket_count * SLOTS_PER_BUCKET; }
+
+    private:
+        static constexpr std::size_t SLOTS_PER_BUCKET = 8;
+        static constexpr uint64_t OCCUPIED = uint64_t{1} << 24;
+        static constexpr uint32_t MAX_TTL = uint32_t{1} << 30;     // Keeps 2 * ttl within 32 bits
+
+        struct alignas(64) Bucket {
+            std::atomic<uint64_t> slots[SLOTS_PER_BUCKET];
+        };
+
+        Bucket& bucket_for(uint32_t icao) const;
+        bool is_fresh(uint64_t entry, uint32_t now) const;
+
+        std::unique_ptr<Bucket[]> m_buckets;
+        std::size_t m_bucket_count;
+        unsigned m_shift;
+        uint32_t m_ttl;                         // Seconds
+        std::atomic<uint32_t> m_now;            // Seconds on the time base passed to advance()
+        std::atomic<std::size_t> m_cursor;
+    };
+
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "adsb/types.hpp"
+
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <string>
-#include <vector>
 
 
     namespace adsb::message {
@@ -12,22 +15,34 @@
          *
          * This class provides the common interface and data for all messages,
          * such as the ICAO address, type code, and reception timestamp.
+         *
+         * Derived classes keep the raw payload and decode their fields on the
+         * first call to an accessor, so messages that are only routed or
+         * counted never pay for field decoding. The fields are decoded exactly
+         * once (see decode_once()), so a message can be read from several
+         * threads at once.
          */
         class ADSBMessage {
         public:
             /**
              * @brief Constructs an ADSBMessage object.
-             * @param icao The 24-bit ICAO address of the aircraft as a hex string.
+             * @param icao The 24-bit ICAO address of the aircraft.
              * @param type_code The message Type Code (a value between 1 and 31).
-             * @param payload The 56-bit message payload.
+             * @param payload The 56-bit message payload (ME field), right-aligned.
+             * @param timestamp Reception time of the message.
              */
-            ADSBMessage(std::string icao, int type_code, std::vector<int> payload);
+            ADSBMessage(uint32_t icao, int type_code, uint64_t payload,
+                        types::Timestamp timestamp = std::chrono::steady_clock::now());
 
             virtual ~ADSBMessage() = default;
 
-            const std::string& get_icao() const { return m_icao; }
+            /**
+             * @brief Returns the ICAO address as a 6-digit lowercase hex string.
+             */
+            std::string get_icao() const;
+            uint32_t get_icao_address() const { return m_icao; }
             int get_type_code() const { return m_type_code; }
-            const std::chrono::steady_clock::time_point& get_timestamp() const { return m_timestamp; }
+            const types::Timestamp& get_timestamp() const { return m_timestamp; }
 
             /**
              * @brief Returns a string representation of the message.
@@ -36,11 +51,38 @@
             virtual std::string to_string() const;
 
         protected:
-            const std::vector<int> m_payload;
+            /**
+             * @brief Calls `decode` on the first call for this message, even if several threads call it at once.
+             *
+             * Later and concurrent callers return once the fields are decoded.
+             * std::call_once would do the same, but glibc makes a system call
+             * in it for every new flag, i.e. for every message.
+             */
+            template <typename Fn>
+            void decode_once(Fn&& decode) const {
+                if (m_fields.load(std::memory_order_acquire) == FIELDS_DECODED) return;
+                uint8_t expected = FIELDS_PENDING;
+                if (m_fields.compare_exchange_strong(expected, FIELDS_DECODING, std::memory_order_acquire)) {
+                    decode();
+                    m_fields.store(FIELDS_DECODED, std::memory_order_release);
+                } else {
+                    wait_for_fields();
+                }
+            }
+
+            const uint64_t m_payload;
             const int m_type_code;
 
         private:
-            const std::string m_icao;
-            const std::chrono::steady_clock::time_point m_timestamp;
+            static constexpr uint8_t FIELDS_PENDING = 0;
+            static constexpr uint8_t FIELDS_DECODING = 1;
+            static constexpr uint8_t FIELDS_DECODED = 2;
+
+            /// Waits for the thread that is decoding the fields.
+            void wait_for_fields() const;
+
+            const uint32_t m_icao;
+            const types::Timestamp m_timestamp;
+            mutable std::atomic<uint8_t> m_fields{FIELDS_PENDING};
         };
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/MessageData.hpp"
 
 namespace adsb::message {
     class AirbornePositionMessage : public ADSBMessage {
@@ -8,15 +9,21 @@ namespace adsb::message {
         /**
          * @brief Constructs an AirbornePositionMessage object.
          */
-        AirbornePositionMessage(const std::string& icao, int type_code, const std::vector<int>& payload);
+        AirbornePositionMessage(uint32_t icao, int type_code, uint64_t payload,
+                                types::Timestamp timestamp = std::chrono::steady_clock::now());
 
-        int get_surveillance_status() const { return m_surveillance_status; }
-        int get_nic_supplement_b() const { return m_nic_supplement_b; }
-        int get_altitude() const { return m_altitude; }
-        bool has_time_utc_sync() const { return m_time_bit; }
-        bool is_odd_frame() const { return m_is_odd; }
-        int get_cpr_latitude_raw() const { return m_cpr_lat; }
-        int get_cpr_longitude_raw() const { return m_cpr_lon; }
+        int get_surveillance_status() const { return get_data().surveillance_status; }
+        int get_nic_supplement_b() const { return get_data().nic_supplement_b; }
+        int get_altitude() const { return get_data().altitude; }
+        bool has_time_utc_sync() const { return get_data().time_utc_sync; }
+        bool is_odd_frame() const { return get_data().is_odd; }
+        int get_cpr_latitude_raw() const { return get_data().cpr_lat; }
+        int get_cpr_longitude_raw() const { return get_data().cpr_lon; }
+        /// Decodes the message fields on first use; safe to call concurrently.
+        const AirbornePositionData& get_data() const {
+            decode_once([this] { decode_fields(); });
+            return m_data;
+        }
 
         /**
          * @brief Returns a string representation of the message.
@@ -25,15 +32,8 @@ namespace adsb::message {
         std::string to_string() const override;
 
     private:
-        void decode_payload();
-        int decode_altitude(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end);
+        void decode_fields() const;
 
-        int m_surveillance_status;
-        int m_nic_supplement_b;
-        int m_altitude;
-        bool m_time_bit;
-        bool m_is_odd;
-        int m_cpr_lat;
-        int m_cpr_lon;
+        mutable AirbornePositionData m_data{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/MessageData.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace adsb::message {
+    /**
+     * @class AllCallMessage
+     * @brief All-call reply (DF11). Not an ADS-B message, so its type code is 0.
+     */
+    class AllCallMessage : public ADSBMessage {
+    public:
+        /**
+         * @brief Constructs an AllCallMessage object.
+         * @param icao The 24-bit ICAO address.
+         * @param header The first 32 bits of the frame.
+         * @param syndrome The CRC syndrome of the frame.
+         * @param timestamp Reception time of the message.
+         */
+        AllCallMessage(uint32_t icao, uint32_t header, uint32_t syndrome,
+                       types::Timestamp timestamp = std::chrono::steady_clock::now());
+
+        int get_capability() const { return get_data().capability; }
+        int get_interrogator() const { return get_data().interrogator; }
+        /// Decodes the message fields on first use; safe to call concurrently.
+        const AllCallData& get_data() const {
+            decode_once([this] { decode_fields(); });
+            return m_data;
+        }
+
+        /**
+         * @brief Returns a string representation of the message.
+         * @return A formatted string for debugging.
+         */
+        std::string to_string() const override;
+
+    private:
+        void decode_fields() const;
+
+        const uint32_t m_header;
+        const uint32_t m_syndrome;
+        mutable AllCallData m_data{};
+    };
+}
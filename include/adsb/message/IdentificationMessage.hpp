@@ -1,52 +1,29 @@
 #pragma once
 
 #include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/MessageData.hpp"
+
+#include <cstdint>
 #include <string>
-#include <vector>
 
 namespace adsb::message {
     class IdentificationMessage : public ADSBMessage {
     public:
-        /**
-         * @enum class EmitterCategory
-         * @brief Defines the aircraft category based on TC=1-4 messages.
-         */
-        enum class EmitterCategory {
-            NO_INFO_A,                      // A0
-            LIGHT,                          // A1
-            SMALL,                          // A2
-            LARGE,                          // A3
-            HIGH_VORTEX_LARGE,              // A4
-            HEAVY,                          // A5
-            HIGH_PERFORMANCE,               // A6
-            ROTORCRAFT,                     // A7
-
-            NO_INFO_B,                      // B0
-            GLIDER_SAILPLANE,               // B1
-            LIGHTER_THAN_AIR,               // B2
-            PARACHUTIST_SKYDIVER,           // B3
-            ULTRALIGHT_HANG_GLIDER,         // B4
-            RESERVED_B5,                    // B5
-            UNMANNED_AERIAL_VEHICLE,        // B6
-            SPACE_TRANS_ATMOSPHERIC,        // B7
-
-            NO_INFO_C,                      // C0
-            SURFACE_EMERGENCY_VEHICLE,      // C1
-            SURFACE_SERVICE_VEHICLE,        // C2
-            POINT_OBSTACLE,                 // C3
-            CLUSTER_OBSTACLE,               // C4
-            LINE_OBSTACLE,                  // C5
-
-            UNKNOWN
-        };
+        using EmitterCategory = message::EmitterCategory;
 
         /**
          * @brief Constructs an IdentificationMessage object.
          */
-        IdentificationMessage(const std::string& icao, int type_code, const std::vector<int>& payload);
+        IdentificationMessage(uint32_t icao, int type_code, uint64_t payload,
+                              types::Timestamp timestamp = std::chrono::steady_clock::now());
 
-        const std::string& get_flight_name() const { return m_flight_name; }
-        EmitterCategory get_category() const { return m_category; }
+        std::string get_flight_name() const { return std::string(get_data().flight_name()); }
+        EmitterCategory get_category() const { return get_data().category; }
+        /// Decodes the message fields on first use; safe to call concurrently.
+        const IdentificationData& get_data() const {
+            decode_once([this] { decode_fields(); });
+            return m_data;
+        }
 
         /**
          * @brief Returns a string representation of the message.
@@ -55,13 +32,9 @@ namespace adsb::message {
         std::string to_string() const override;
 
     private:
-        void decode_payload();
-
-        EmitterCategory decode_category(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end);
-        std::string decode_flight_name(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end);
+        void decode_fields() const;
 
-        std::string m_flight_name;
-        EmitterCategory m_category;
+        mutable IdentificationData m_data{};
     };
 
     /**
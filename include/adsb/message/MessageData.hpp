@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace adsb::message {
+    /// Altitude of a frame whose altitude code is missing (all zero) or not a valid encoding.
+    constexpr int INVALID_ALTITUDE = std::numeric_limits<int>::min();
+
+    /**
+     * @enum class EmitterCategory
+     * @brief Defines the aircraft category based on TC=1-4 messages.
+     */
+    enum class EmitterCategory {
+        NO_INFO_A,                      // A0
+        LIGHT,                          // A1
+        SMALL,                          // A2
+        LARGE,                          // A3
+        HIGH_VORTEX_LARGE,              // A4
+        HEAVY,                          // A5
+        HIGH_PERFORMANCE,               // A6
+        ROTORCRAFT,                     // A7
+
+        NO_INFO_B,                      // B0
+        GLIDER_SAILPLANE,               // B1
+        LIGHTER_THAN_AIR,               // B2
+        PARACHUTIST_SKYDIVER,           // B3
+        ULTRALIGHT_HANG_GLIDER,         // B4
+        RESERVED_B5,                    // B5
+        UNMANNED_AERIAL_VEHICLE,        // B6
+        SPACE_TRANS_ATMOSPHERIC,        // B7
+
+        NO_INFO_C,                      // C0
+        SURFACE_EMERGENCY_VEHICLE,      // C1
+        SURFACE_SERVICE_VEHICLE,        // C2
+        POINT_OBSTACLE,                 // C3
+        CLUSTER_OBSTACLE,               // C4
+        LINE_OBSTACLE,                  // C5
+
+        UNKNOWN
+    };
+
+    /**
+     * @struct IdentificationData
+     * @brief Decoded fields of an identification message (TC=1-4).
+     */
+    struct IdentificationData {
+        uint32_t icao;
+        int type_code;
+        EmitterCategory category;
+        char callsign[8];               // Not NUL-terminated, trailing spaces removed
+        uint8_t callsign_length;
+        uint64_t callsign_key;          // The 48 raw character bits, see pack_callsign()
+
+        std::string_view flight_name() const { return {callsign, callsign_length}; }
+    };
+
+    /**
+     * @struct AirbornePositionData
+     * @brief Decoded fields of an airborne position message (TC=9-18).
+     */
+    struct AirbornePositionData {
+        uint32_t icao;
+        int type_code;
+        int surveillance_status;
+        int nic_supplement_b;
+        int altitude;                   // Feet, or INVALID_ALTITUDE
+        bool time_utc_sync;
+        bool is_odd;
+        int cpr_lat;
+        int cpr_lon;
+    };
+
+    /**
+     * @struct VelocityData
+     * @brief Decoded fields of an airborne velocity message (TC=19).
+     */
+    struct VelocityData {
+        uint32_t icao;
+        int type_code;
+        double speed;
+        double heading;
+        int vertical_rate;
+    };
+
+    /**
+     * @struct AllCallData
+     * @brief Decoded fields of an all-call reply (DF11).
+     */
+    struct AllCallData {
+        uint32_t icao;
+        int capability;
+        int interrogator;               // Interrogator code recovered from the parity field
+    };
+
+    /**
+     * @struct SurveillanceData
+     * @brief Decoded fields of a surveillance reply (DF4/5/20/21).
+     *
+     * DF4/20 report the altitude, DF5/21 the squawk. DF20/21 additionally
+     * carry a Comm-B message; of these only the aircraft identification
+     * (BDS 2,0) is decoded.
+     */
+    struct SurveillanceData {
+        uint32_t icao;                  // Recovered from the address/parity field
+        int downlink_format;
+        int flight_status;
+        int altitude;
+        bool has_altitude;
+        int squawk;                     // Four octal digits as a decimal number, e.g. 7700
+        bool has_squawk;
+        char callsign[8];               // Comm-B identification; not NUL-terminated, trailing spaces removed
+        uint8_t callsign_length;        // 0 if the reply carries no identification
+        uint64_t callsign_key;          // The 48 raw character bits, see pack_callsign(); 0 without identification
+
+        std::string_view flight_name() const { return {callsign, callsign_length}; }
+    };
+
+    /**
+     * @brief Value-type decode result.
+     *
+     * `std::monostate` means the frame was invalid or of an unsupported type.
+     */
+    using MessageData = std::variant<std::monostate, IdentificationData, AirbornePositionData, VelocityData,
+                                     AllCallData, SurveillanceData>;
+
+    /**
+     * @brief The ICAO address of a decoded message.
+     * @return The address, or 0 for `std::monostate`.
+     */
+    inline uint32_t icao_of(const MessageData& data) {
+        return std::visit([](const auto& message) -> uint32_t {
+            if constexpr (std::is_same_v<std::decay_t<decltype(message)>, std::monostate>) return 0;
+            else return message.icao;
+        }, data);
+    }
+
+    /**
+     * @brief Decodes the payload of an identification message.
+     * @param icao The 24-bit ICAO address.
+     * @param type_code The message Type Code (1-4).
+     * @param payload The 56-bit message payload (ME field), right-aligned.
+     */
+    IdentificationData decode_identification(uint32_t icao, int type_code, uint64_t payload);
+
+    /**
+     * @brief Decodes the payload of an airborne position message.
+     * @param icao The 24-bit ICAO address.
+     * @param type_code The message Type Code (9-18).
+     * @param payload The 56-bit message payload (ME field), right-aligned.
+     */
+    AirbornePositionData decode_airborne_position(uint32_t icao, int type_code, uint64_t payload);
+
+    /**
+     * @brief Decodes the payload of an airborne velocity message.
+     * @param icao The 24-bit ICAO address.
+     * @param type_code The message Type Code (19).
+     * @param payload The 56-bit message payload (ME field), right-aligned.
+     */
+    VelocityData decode_velocity(uint32_t icao, int type_code, uint64_t payload);
+
+    /**
+     * @brief Decodes an all-call reply.
+     * @param icao The 24-bit ICAO address (AA field).
+     * @param header The first 32 bits of the frame.
+     * @param syndrome The CRC syndrome of the frame.
+     */
+    AllCallData decode_all_call(uint32_t icao, uint32_t header, uint32_t syndrome);
+
+    /**
+     * @brief Decodes a surveillance reply.
+     * @param icao The 24-bit ICAO address recovered from the parity field.
+     * @param header The first 32 bits of the frame.
+     * @param comm_b The 56-bit MB field of DF20/21, right-aligned; 0 for DF4/5.
+     */
+    SurveillanceData decode_surveillance(uint32_t icao, uint32_t header, uint64_t comm_b);
+
+    /**
+     * @brief Decodes a 12-bit altitude code (AC field without the M bit) into feet.
+     *
+     * Covers both the 25 ft (Q=1) and the Gillham 100 ft (Q=0) encodings
+     * through a 4096-entry table.
+     *
+     * @return The altitude in feet, or `INVALID_ALTITUDE`.
+     */
+    int decode_altitude(int altitude_code);
+
+    /**
+     * @brief Decodes the eight 6-bit characters of a flight name into `out`.
+     * @param name_bits The 48 character bits, right-aligned.
+     * @return The length of the name without trailing spaces.
+     */
+    uint8_t decode_flight_name(uint64_t name_bits, char (&out)[8]);
+
+    /**
+     * @brief Encodes a callsign into its 48-bit on-air representation.
+     *
+     * Equal callsigns always have equal keys (trailing spaces are implied),
+     * so the key can be compared and hashed instead of the text.
+     *
+     * @param callsign Up to eight characters from A-Z, 0-9 and space.
+     * @return The key, or 0 if the callsign cannot be encoded.
+     */
+    uint64_t pack_callsign(std::string_view callsign);
+
+    // Encoders: the inverse of the decode_* functions above, producing the
+    // 56-bit ME field. Decoding an encoded payload returns the same fields,
+    // except where the on-air resolution is coarser than the value given.
+
+    /**
+     * @brief Encodes the payload of an identification message.
+     *
+     * Uses `callsign_key` if set, otherwise the callsign text. The emitter
+     * category must belong to the set selected by the type code.
+     */
+    uint64_t encode_identification(const IdentificationData& data);
+
+    /**
+     * @brief Encodes the payload of an airborne position message.
+     *
+     * `cpr_lat` and `cpr_lon` are used as they are; see `cpr::encode()`.
+     */
+    uint64_t encode_airborne_position(const AirbornePositionData& data);
+
+    /**
+     * @brief Encodes the payload of an airborne velocity message (subtype 1, ground speed).
+     *
+     * Speed and vertical rate are rounded to 1 kn and 64 ft/min, and limited
+     * to the largest encodable values (1022 kn per component, 32640 ft/min).
+     */
+    uint64_t encode_velocity(const VelocityData& data);
+
+    /**
+     * @brief Encodes an altitude into a 12-bit altitude code.
+     *
+     * Altitudes from -1000 to 50175 ft use the 25 ft (Q=1) encoding, higher
+     * ones the Gillham 100 ft encoding.
+     *
+     * @return The code, or 0 ("no altitude") for `INVALID_ALTITUDE` and altitudes out of range.
+     */
+    int encode_altitude(int feet);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/MessageData.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace adsb::message {
+    /**
+     * @class SurveillanceMessage
+     * @brief Surveillance altitude/identity reply (DF4/5/20/21).
+     *
+     * Not an ADS-B message, so its type code is 0; the payload holds the
+     * Comm-B field of DF20/21.
+     */
+    class SurveillanceMessage : public ADSBMessage {
+    public:
+        /**
+         * @brief Constructs a SurveillanceMessage object.
+         * @param icao The 24-bit ICAO address recovered from the parity field.
+         * @param header The first 32 bits of the frame.
+         * @param comm_b The 56-bit MB field of DF20/21, right-aligned; 0 for DF4/5.
+         * @param timestamp Reception time of the message.
+         */
+        SurveillanceMessage(uint32_t icao, uint32_t header, uint64_t comm_b,
+                            types::Timestamp timestamp = std::chrono::steady_clock::now());
+
+        int get_downlink_format() const { return get_data().downlink_format; }
+        int get_flight_status() const { return get_data().flight_status; }
+        bool has_altitude() const { return get_data().has_altitude; }
+        int get_altitude() const { return get_data().altitude; }
+        bool has_squawk() const { return get_data().has_squawk; }
+        int get_squawk() const { return get_data().squawk; }
+        std::string get_flight_name() const { return std::string(get_data().flight_name()); }
+        /// Decodes the message fields on first use; safe to call concurrently.
+        const SurveillanceData& get_data() const {
+            decode_once([this] { decode_fields(); });
+            return m_data;
+        }
+
+        /**
+         * @brief Returns a string representation of the message.
+         * @return A formatted string for debugging.
+         */
+        std::string to_string() const override;
+
+    private:
+        void decode_fields() const;
+
+        const uint32_t m_header;
+        mutable SurveillanceData m_data{};
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/MessageData.hpp"
 
 namespace adsb::message {
     class VelocityMessage : public ADSBMessage {
@@ -8,11 +9,17 @@ namespace adsb::message {
         /**
          * @brief Constructs a VelocityMessage object.
          */
-        VelocityMessage(const std::string& icao, int type_code, const std::vector<int>& payload);
+        VelocityMessage(uint32_t icao, int type_code, uint64_t payload,
+                        types::Timestamp timestamp = std::chrono::steady_clock::now());
 
-        double get_speed() const { return m_speed; }
-        double get_heading() const { return m_heading; }
-        int get_vertical_rate() const { return m_vertical_rate; }
+        double get_speed() const { return get_data().speed; }
+        double get_heading() const { return get_data().heading; }
+        int get_vertical_rate() const { return get_data().vertical_rate; }
+        /// Decodes the message fields on first use; safe to call concurrently.
+        const VelocityData& get_data() const {
+            decode_once([this] { decode_fields(); });
+            return m_data;
+        }
 
         /**
          * @brief Returns a string representation of the message.
@@ -21,10 +28,8 @@ namespace adsb::message {
         std::string to_string() const override;
 
     private:
-        void decode_payload();
+        void decode_fields() const;
 
-        double m_speed;
-        double m_heading;
-        int m_vertical_rate;
+        mutable VelocityData m_data{};
     };
 }
\ No newline at end of file
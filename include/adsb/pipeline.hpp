@@ -0,0 +1,217 @@
+#pragma once
+
+#include "adsb/decoder.hpp"
+#include "adsb/dedup.hpp"
+#include "adsb/spsc_ring.hpp"
+#include "adsb/tracker.hpp"
+#include "adsb/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace adsb::pipeline {
+
+    /**
+     * @enum class OverflowPolicy
+     * @brief What `Source::push()` does when the source queue is full.
+     */
+    enum class OverflowPolicy {
+        DROP,           // Reject the frame and count it in PipelineStats::dropped
+        BLOCK           // Wait until the workers have made room
+    };
+
+    /**
+     * @struct PipelineOptions
+     * @brief Configuration of a Pipeline.
+     */
+    struct PipelineOptions {
+        /// Number of input sources; each is fed by a single thread.
+        std::size_t sources = 1;
+        /// Number of worker threads, each owning one tracker shard; 0 uses one per hardware thread.
+        std::size_t workers = 0;
+        /// Frames buffered per source, split evenly between the workers.
+        std::size_t source_capacity = 16384;
+        /// Decoded messages buffered between every pair of workers.
+        std::size_t shard_capacity = 4096;
+        OverflowPolicy overflow = OverflowPolicy::DROP;
+        /// Shared filter applied before decoding, with the source index as receiver id; nullptr disables it.
+        dedup::DuplicateFilter* duplicates = nullptr;
+        /// Options of every decode call. `known_aircraft` (an IcaoSet) may be shared, it is thread-safe; the
+        /// workers advance it with the timestamps of the frames.
+        decoder::DecoderOptions decoder;
+        /// Options of every tracker shard; `capacity` applies per shard.
+        tracker::TrackerOptions tracker;
+        /// Called on the owning worker thread after every tracker update.
+        std::function<void(const tracker::AircraftState&)> on_update;
+    };
+
+    /**
+     * @struct PipelineStats
+     * @brief Totals since the pipeline was started.
+     */
+    struct PipelineStats {
+        uint64_t received = 0;          // Frames accepted by the source queues
+        uint64_t dropped = 0;           // Frames rejected because a source queue was full
+        uint64_t duplicates = 0;        // Frames suppressed as copies from another source
+        uint64_t decoded = 0;           // Frames that produced a message
+        uint64_t updates = 0;           // Tracker updates that returned an aircraft
+    };
+
+    /**
+     * @class Pipeline
+     * @brief Multi-threaded decoding of several frame sources into ICAO-sharded trackers.
+     *
+     * Every source has one SPSC ring per worker. `Source::push()` reads the
+     * address of the raw frame (in clear, or from the parity field of
+     * surveillance replies) and queues the frame for the worker owning that
+     * aircraft, so even a single source keeps all workers busy. Workers compute
+     * the CRC syndromes of each popped batch with `crc::check_crc_batch()`
+     * (surveillance replies bring theirs from `push()`) and decode with
+     * them; a message whose decoded address belongs to another shard (a
+     * repaired frame) is routed to its owner through an SPSC ring per
+     * (sender, owner) pair. Each worker owns a private AircraftTracker, so no
+     * tracker state is shared or locked, and all messages of one aircraft are
+     * applied by the same thread.
+     *
+     * A worker whose route to another shard is full keeps draining its own
+     * inbound rings while it waits, so workers never deadlock on each other.
+     *
+     * With a DuplicateFilter, copies of a frame that several overlapping
+     * sources received are dropped before they are decoded.
+     *
+     * Trackers may only be inspected through `on_update` while running, or
+     * with `shard()` after `stop()`.
+     */
+    class Pipeline {
+    public:
+        /**
+         * @class Source
+         * @brief Producer handle of one input; all calls must come from the same thread.
+         */
+        class Source {
+        public:
+            /**
+             * @brief Queues a packed frame for decoding.
+             *
+             * @param frame The frame bytes.
+             * @param length Frame length in bytes (7 or 14); other lengths are rejected.
+             * @param timestamp Reception time of the frame.
+             * @return false if the frame was dropped (full queue with OverflowPolicy::DROP, or invalid length).
+             */
+            bool push(const uint8_t* frame, std::size_t length, types::Timestamp timestamp);
+
+        private:
+            friend class Pipeline;
+            Source(Pipeline& pipeline, std::size_t index) : m_pipeline(&pipeline), m_index(index) {}
+
+            Pipeline* m_pipeline;
+            std::size_t m_index;
+        };
+
+        explicit Pipeline(const PipelineOptions& options = PipelineOptions{});
+        ~Pipeline();
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        /// The producer handle of input `index` (0 <= index < sources).
+        Source source(std::size_t index) { return Source(*this, index); }
+
+        /**
+         * @brief Processes every queued frame, then joins the workers.
+         *
+         * Call only once no source pushes anymore. Idempotent.
+         */
+        void stop();
+
+        PipelineStats stats() const;
+
+        std::size_t workers() const { return m_workers.size(); }
+
+        /// Tracker shard of worker `index`; only valid after `stop()`.
+        const tracker::AircraftTracker& shard(std::size_t index) const { return m_workers[index]->tracker; }
+
+        /// The worker whose shard tracks an aircraft.
+        std::size_t shard_of(uint32_t icao) const {
+            return static_cast<std::size_t>((icao * 0x9E3779B1u) >> 8) % m_workers.size();
+        }
+
+    private:
+        /**
+         * @struct FrameItem
+         * @brief A queued frame with its reception time.
+         */
+        struct FrameItem {
+            uint8_t data[types::LONG_FRAME_BYTES];
+            uint8_t length;
+            uint32_t syndrome;          // CRC syndrome of address/parity replies, computed by push()
+            int64_t time_ns;
+        };
+
+        /**
+         * @struct MessageItem
+         * @brief A decoded message on its way to the owning shard.
+         */
+        struct MessageItem {
+            message::MessageData data;
+            int64_t time_ns;
+        };
+
+        /**
+         * @struct Counter
+         * @brief Counter written by a single thread, on a cache line of its own.
+         */
+        struct alignas(64) Counter {
+            std::atomic<uint64_t> value{0};
+
+            void add(uint64_t amount) {
+                value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+        };
+
+        /**
+         * @struct SourceQueue
+         * @brief Rings and counters of one source.
+         */
+        struct SourceQueue {
+            SourceQueue(std::size_t capacity, std::size_t workers);
+
+            std::vector<std::unique_ptr<SpscRing<FrameItem>>> rings;   // One per worker
+            Counter received;
+            Counter dropped;
+        };
+
+        /**
+         * @struct Worker
+         * @brief State owned by one worker thread.
+         */
+        struct Worker {
+            Worker(const tracker::TrackerOptions& options, std::size_t index, std::size_t workers, std::size_t capacity);
+
+            tracker::AircraftTracker tracker;
+            std::vector<std::unique_ptr<SpscRing<MessageItem>>> inbound; // One per other worker, by sender
+            Counter duplicates;
+            Counter decoded;
+            Counter updates;
+            std::thread thread;
+        };
+
+        void run(std::size_t index);
+        std::size_t decode_sources(std::size_t index);
+        std::size_t drain_inbound(std::size_t index);
+        void route(std::size_t index, const MessageItem& item);
+
+        PipelineOptions m_options;
+        std::vector<std::unique_ptr<SourceQueue>> m_sources;
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<bool> m_stopping{false};
+        std::atomic<std::size_t> m_decoders_done{0};
+        bool m_stopped = false;
+    };
+
+}
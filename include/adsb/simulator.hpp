@@ -0,0 +1,139 @@
+#pragma once
+
+#include "adsb/encoder.hpp"
+#include "adsb/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace adsb::simulator {
+
+    /**
+     * @struct Frame
+     * @brief One generated Mode S frame with its transmission time.
+     */
+    struct Frame {
+        uint8_t data[types::LONG_FRAME_BYTES];
+        uint8_t length;                 // types::LONG_FRAME_BYTES
+        uint64_t mlat_ticks;            // 12 MHz timestamp since the start of the simulation
+    };
+
+    /**
+     * @struct SimulatedAircraft
+     * @brief Ground truth of one simulated aircraft, as of its latest position frame.
+     */
+    struct SimulatedAircraft {
+        uint32_t icao;
+        uint64_t callsign_key;          // See message::pack_callsign()
+        double latitude;
+        double longitude;
+        double altitude;                // Feet
+        double speed;                   // Knots
+        double heading;                 // Degrees, clockwise from north
+        int vertical_rate;              // Feet per minute
+    };
+
+    /**
+     * @struct SimulatorOptions
+     * @brief Configuration of a TrafficSimulator. The same options always produce the same frames.
+     */
+    struct SimulatorOptions {
+        uint64_t seed = 1;
+        std::size_t aircraft = 1000;
+        /// Aircraft start within `radius_nm` of the center and turn back when they leave that area.
+        types::GlobalPosition center = {50.0, 8.0, 0};
+        double radius_nm = 250.0;
+        /// Mean interval between two transmissions of each message type, in seconds.
+        /// Every interval is drawn uniformly from +-20% around the mean, like a
+        /// real transponder does. At most 8 seconds.
+        double position_interval = 0.5;
+        double velocity_interval = 0.5;
+        double identification_interval = 5.0;
+        /// Probability of every bit to be flipped after the parity is computed.
+        double bit_error_rate = 0.0;
+    };
+
+    /**
+     * @class TrafficSimulator
+     * @brief Moves aircraft along plausible tracks and emits their ADS-B frames.
+     *
+     * Each aircraft flies a straight track at constant speed, climbing or
+     * descending to a target altitude, and transmits identification (DF17
+     * TC=4), airborne position (TC=11, alternating even and odd CPR format)
+     * and velocity (TC=19) frames at the configured rates. Transmissions are
+     * kept in a timing wheel of 10 ms slots, so each frame costs O(1)
+     * regardless of the number of aircraft, and parities are computed with
+     * `crc::check_crc_batch()` for a whole call at once.
+     *
+     * Frames are emitted in transmission order; simulated time only advances
+     * through `generate()`, so the simulator runs as fast as it can.
+     */
+    class TrafficSimulator {
+    public:
+        explicit TrafficSimulator(const SimulatorOptions& options = SimulatorOptions{});
+
+        /**
+         * @brief Emits the next frames of the simulation.
+         *
+         * @param frames Receives `count` frames.
+         * @param count Number of frames to generate.
+         * @return The number of flipped bits (see `SimulatorOptions::bit_error_rate`).
+         */
+        std::size_t generate(Frame* frames, std::size_t count);
+
+        /// Convenience overload returning a new vector.
+        std::vector<Frame> generate(std::size_t count);
+
+        /// Simulated time in 12 MHz ticks.
+        uint64_t now_ticks() const { return m_slot * SLOT_TICKS; }
+
+        const std::vector<SimulatedAircraft>& aircraft() const { return m_aircraft; }
+
+    private:
+        static constexpr uint64_t SLOT_TICKS = types::MLAT_TICKS_PER_SECOND / 100;
+        static constexpr std::size_t WHEEL_SLOTS = 1024;
+
+        enum Kind : uint32_t { POSITION, VELOCITY, IDENTIFICATION, KIND_COUNT };
+
+        /**
+         * @struct Motion
+         * @brief Kinematic state and cached payloads of one aircraft.
+         */
+        struct Motion {
+            double lat_per_tick;
+            double lon_per_tick;
+            double feet_per_tick;
+            double target_altitude;
+            uint64_t updated_ticks;
+            uint64_t identification_payload;
+            uint64_t velocity_payload;
+            bool next_odd;
+        };
+
+        void spawn(std::size_t index);
+        void set_track(std::size_t index, double heading, int vertical_rate);
+        void move(std::size_t index, uint64_t ticks);
+        uint64_t position_payload(std::size_t index);
+        void schedule(uint32_t event, uint64_t ticks);
+        uint64_t next_random();
+        double next_unit();
+
+        SimulatorOptions m_options;
+        double m_radius_deg;
+        double m_center_cos;
+        uint64_t m_interval_ticks[KIND_COUNT];
+        uint64_t m_rng;
+
+        std::vector<SimulatedAircraft> m_aircraft;
+        std::vector<Motion> m_motion;
+
+        std::vector<std::vector<uint32_t>> m_wheel;     // Events (aircraft << 2 | kind) per slot
+        uint64_t m_slot = 0;                            // Current slot, counted from the start
+        std::size_t m_cursor = 0;                       // Next event in the current slot
+
+        std::vector<uint32_t> m_syndromes;
+        encoder::BitErrorInjector m_errors;
+    };
+
+}
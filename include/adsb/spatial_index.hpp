@@ -0,0 +1,176 @@
+#pragma once
+
+#include "adsb/types.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace adsb::tracker {
+
+    /**
+     * @struct IndexedAircraft
+     * @brief Position of one aircraft in a SpatialSnapshot.
+     */
+    struct IndexedAircraft {
+        uint32_t icao;
+        types::GlobalPosition position;
+        types::Timestamp position_time;
+    };
+
+    /**
+     * @struct SpatialIndexOptions
+     * @brief Configuration of a SpatialIndex.
+     */
+    struct SpatialIndexOptions {
+        /// Edge of a grid cell in degrees; about the radius of typical queries works best.
+        double cell_degrees = 1.0;
+        /// Maximum number of aircraft indexed at the same time.
+        std::size_t capacity = 16384;
+        /// `update()` publishes a new snapshot when the last one is older than this (on the update time base).
+        std::chrono::milliseconds publish_interval{100};
+    };
+
+    /**
+     * @class SpatialSnapshot
+     * @brief Immutable view of all indexed positions at one point in time.
+     *
+     * Aircraft are stored sorted by grid cell, cells numbered row by row
+     * from the south pole and the antimeridian, so the cells of one latitude
+     * band within a longitude range are one contiguous run that is found by
+     * binary search. Queries only visit the cells overlapping the query area
+     * and then check every candidate exactly.
+     *
+     * All queries are const and may run concurrently. The output vectors are
+     * cleared first; reusing them avoids allocations.
+     */
+    class SpatialSnapshot {
+    public:
+        /**
+         * @brief Aircraft within a great-circle distance of a position.
+         *
+         * Areas reaching across the antimeridian or over a pole are handled.
+         *
+         * @return The number of aircraft found.
+         */
+        std::size_t within_radius(const types::GlobalPosition& center, double radius_nm,
+                                  std::vector<IndexedAircraft>& out) const;
+
+        /**
+         * @brief Aircraft inside a latitude/longitude box.
+         *
+         * A box with `west > east` wraps across the antimeridian.
+         *
+         * @return The number of aircraft found.
+         */
+        std::size_t within_box(double south, double west, double north, double east,
+                               std::vector<IndexedAircraft>& out) const;
+
+        /**
+         * @brief The `k` aircraft closest to a position, nearest first.
+         * @return The number of aircraft found (less than `k` if fewer are indexed).
+         */
+        std::size_t nearest(const types::GlobalPosition& center, std::size_t k, std::vector<IndexedAircraft>& out) const;
+
+        std::size_t size() const { return m_aircraft.size(); }
+
+        /// Time of the last update included in the snapshot.
+        types::Timestamp time() const { return m_time; }
+
+        /// Every indexed aircraft, in cell order.
+        const std::vector<IndexedAircraft>& aircraft() const { return m_aircraft; }
+
+    private:
+        friend class SpatialIndex;
+
+        /// Calls `fn(const IndexedAircraft&)` for every aircraft in the cells overlapping a box.
+        template <typename Fn>
+        void for_each_candidate(double south, double west, double north, double east, Fn&& fn) const;
+
+        std::vector<IndexedAircraft> m_aircraft;
+        std::vector<uint32_t> m_cells;          // Cell of each aircraft, ascending
+        double m_cell_degrees = 1.0;
+        uint32_t m_rows = 0;
+        uint32_t m_columns = 0;
+        types::Timestamp m_time{};
+    };
+
+    /**
+     * @class SpatialIndex
+     * @brief Grid index of aircraft positions with lock-free readers.
+     *
+     * A single writer (normally the AircraftTracker it is attached to via
+     * TrackerOptions::spatial_index) reports every position change and
+     * removal. Changes are applied to a private table in O(1) and become
+     * visible to readers when the writer publishes a new SpatialSnapshot,
+     * read-copy-update style: `snapshot()` hands out a shared pointer to
+     * the current one, readers query it as long as they like, and it is
+     * freed once the last reader drops it.
+     * Readers never block the writer and the writer never waits for them.
+     *
+     * `snapshot()` may be called from any thread; all other members only
+     * from the writer's thread.
+     */
+    class SpatialIndex {
+    public:
+        explicit SpatialIndex(const SpatialIndexOptions& options = SpatialIndexOptions{});
+
+        /**
+         * @brief Sets the position of an aircraft, adding it if needed.
+         *
+         * Publishes a snapshot if the current one is older than the publish interval.
+         *
+         * @return false if the index is full.
+         */
+        bool update(uint32_t icao, const types::GlobalPosition& position, types::Timestamp timestamp);
+
+        /**
+         * @brief Removes an aircraft; takes effect with the next snapshot.
+         * @return true if the aircraft was indexed.
+         */
+        bool remove(uint32_t icao);
+
+        /// Makes all changes so far visible to `snapshot()`.
+        void publish();
+
+        /// The most recently published snapshot; never null.
+        std::shared_ptr<const SpatialSnapshot> snapshot() const;
+
+        std::size_t size() const { return m_entries.size(); }
+        std::size_t capacity() const { return m_options.capacity; }
+
+    private:
+        static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+
+        /**
+         * @struct Entry
+         * @brief An aircraft in the writer's table.
+         */
+        struct Entry {
+            IndexedAircraft aircraft;
+            uint32_t cell;
+        };
+
+        uint32_t cell_of(const types::GlobalPosition& position) const;
+        std::size_t home_slot(uint32_t icao) const;
+        std::size_t find_slot(uint32_t icao) const;
+
+        SpatialIndexOptions m_options;
+        uint32_t m_rows;
+        uint32_t m_columns;
+        unsigned m_cell_bits = 0;                       // Significant bits of a cell number
+        std::vector<Entry> m_entries;                   // Dense, in no particular order
+        std::vector<uint32_t> m_slots;                  // ICAO hash table of indices into m_entries
+        std::size_t m_mask;
+        unsigned m_shift;
+        types::Timestamp m_time{};
+        types::Timestamp m_published_time{};
+        bool m_dirty = false;
+        std::shared_ptr<SpatialSnapshot> m_current;     // Accessed with the std::atomic_* functions
+        std::vector<uint64_t> m_order;                  // Scratch: (cell, entry) pairs to sort
+        std::vector<uint64_t> m_scratch;
+    };
+
+}
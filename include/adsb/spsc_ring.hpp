@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace adsb::pipeline {
+
+    /**
+     * @class SpscRing
+     * @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+     *
+     * The producer only writes the tail index and the consumer only the head
+     * index, each on its own cache line, so neither side ever executes a
+     * locked instruction. Each side also keeps a cached copy of the other's
+     * index and reloads it only when the ring looks full (or empty), which
+     * keeps the shared lines from bouncing between the two cores on every
+     * element. The batch operations publish many elements with one store.
+     *
+     * @tparam T A trivially copyable element type.
+     */
+    template <typename T>
+    class SpscRing {
+        static_assert(std::is_trivially_copyable_v<T>, "ring elements are copied with plain stores");
+
+    public:
+        /**
+         * @param capacity Minimum number of elements; rounded up to a power of two.
+         */
+        explicit SpscRing(std::size_t capacity) {
+            std::size_t size = 2;
+            while (size < capacity) size <<= 1;
+            m_mask = size - 1;
+            m_slots = std::make_unique<T[]>(size);
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /// Producer: appends an element; false if the ring is full.
+        bool try_push(const T& value) {
+            const uint64_t tail = m_producer.tail.load(std::memory_order_relaxed);
+            if (tail - m_producer.cached_head > m_mask) {
+                m_producer.cached_head = m_consumer.head.load(std::memory_order_acquire);
+                if (tail - m_producer.cached_head > m_mask) return false;
+            }
+            m_slots[tail & m_mask] = value;
+            m_producer.tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Producer: appends up to `count` elements.
+         * @return The number of elements appended (0 if the ring is full).
+         */
+        std::size_t try_push(const T* values, std::size_t count) {
+            const uint64_t tail = m_producer.tail.load(std::memory_order_relaxed);
+            std::size_t free = capacity() - static_cast<std::size_t>(tail - m_producer.cached_head);
+            if (free < count) {
+                m_producer.cached_head = m_consumer.head.load(std::memory_order_acquire);
+                free = capacity() - static_cast<std::size_t>(tail - m_producer.cached_head);
+            }
+            const std::size_t n = count < free ? count : free;
+            for (std::size_t i = 0; i < n; ++i) m_slots[(tail + i) & m_mask] = values[i];
+            if (n > 0) m_producer.tail.store(tail + n, std::memory_order_release);
+            return n;
+        }
+
+        /// Consumer: removes the oldest element; false if the ring is empty.
+        bool try_pop(T& value) {
+            const uint64_t head = m_consumer.head.load(std::memory_order_relaxed);
+            if (head == m_consumer.cached_tail) {
+                m_consumer.cached_tail = m_producer.tail.load(std::memory_order_acquire);
+                if (head == m_consumer.cached_tail) return false;
+            }
+            value = m_slots[head & m_mask];
+            m_consumer.head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Consumer: removes up to `max` of the oldest elements.
+         * @return The number of elements written to `out`.
+         */
+        std::size_t try_pop(T* out, std::size_t max) {
+            const uint64_t head = m_consumer.head.load(std::memory_order_relaxed);
+            if (m_consumer.cached_tail - head < max) {
+                m_consumer.cached_tail = m_producer.tail.load(std::memory_order_acquire);
+            }
+            const auto available = static_cast<std::size_t>(m_consumer.cached_tail - head);
+            const std::size_t n = available < max ? available : max;
+            for (std::size_t i = 0; i < n; ++i) out[i] = m_slots[(head + i) & m_mask];
+            if (n > 0) m_consumer.head.store(head + n, std::memory_order_release);
+            return n;
+        }
+
+        /// Number of queued elements; exact only when called by the producer or consumer while the other is idle.
+        std::size_t size() const {
+            return static_cast<std::size_t>(m_producer.tail.load(std::memory_order_acquire)
+                                          - m_consumer.head.load(std::memory_order_acquire));
+        }
+
+        bool empty() const { return size() == 0; }
+
+        std::size_t capacity() const { return m_mask + 1; }
+
+    private:
+        struct alignas(64) Producer {
+            std::atomic<uint64_t> tail{0};
+            uint64_t cached_head = 0;
+        };
+
+        struct alignas(64) Consumer {
+            std::atomic<uint64_t> head{0};
+            uint64_t cached_tail = 0;
+        };
+
+        Producer m_producer;
+        Consumer m_consumer;
+        std::unique_ptr<T[]> m_slots;
+        std::size_t m_mask;
+    };
+
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Hot-path instrumentation.
+ *
+ * Built only with the CMake option ADSB_ENABLE_STATS, which defines the
+ * macro of the same name. Without it, the ADSB_STATS_* macros expand to
+ * nothing and `snapshot()` returns zeros, so the decoding paths carry no
+ * instrumentation code at all.
+ */
+#ifndef ADSB_ENABLE_STATS
+#define ADSB_ENABLE_STATS 0
+#endif
+
+namespace adsb::stats {
+
+    /**
+     * @enum class Counter
+     * @brief Events counted by the library.
+     */
+    enum class Counter : std::size_t {
+        FRAMES,                         // Frames passed to the decoder
+        DECODED,                        // Frames that produced a message
+        REJECTED_LENGTH,                // Neither 56 nor 112 bits
+        REJECTED_CRC,                   // CRC failed and the frame could not be repaired
+        REJECTED_FORMAT,                // Unsupported downlink format (or frame length not matching it)
+        REJECTED_TYPE_CODE,             // DF17 with an unsupported type code
+        REJECTED_UNKNOWN_ADDRESS,       // DF4/5/20/21 from an address not confirmed before
+        REJECTED_FILTER,                // Dropped by the downlink format, type code or ICAO filters
+        CORRECTED_ONE_BIT,
+        CORRECTED_TWO_BITS,
+        CPR_PAIR_DECODED,               // Global CPR decodes that produced a position
+        CPR_PARITY_MISMATCH,            // Pair of two even or two odd frames
+        CPR_PAIR_TOO_OLD,               // Frames further apart than cpr::MAX_PAIR_INTERVAL
+        CPR_ZONE_MISMATCH,              // Frames in different longitude zone bands (NL)
+        CPR_OUT_OF_RANGE,               // Decoded latitude outside [-90, 90]
+        DUPLICATES,                     // Frames suppressed by a dedup::DuplicateFilter
+        COUNT
+    };
+
+    /**
+     * @enum class Stage
+     * @brief Timed processing stages.
+     */
+    enum class Stage : std::size_t {
+        DECODE,                         // One frame through decode() / decode_into()
+        DEMODULATE,                     // One sample block through Demodulator::process()
+        TRACKER_UPDATE,                 // One AircraftTracker::update()
+        COUNT
+    };
+
+    constexpr std::size_t COUNTER_COUNT = static_cast<std::size_t>(Counter::COUNT);
+    constexpr std::size_t STAGE_COUNT = static_cast<std::size_t>(Stage::COUNT);
+
+    // Latency histograms are log-linear (HDR style): 8 linear buckets per power of two,
+    // i.e. at most 12.5% relative error, from 1 ns up to about 73 minutes.
+    // Reading the clock costs about as much as decoding a frame, so only one
+    // call in LATENCY_SAMPLE_INTERVAL per thread and stage is timed.
+    constexpr uint32_t LATENCY_SAMPLE_INTERVAL = 64;
+    constexpr unsigned HISTOGRAM_SUB_BITS = 3;
+    constexpr unsigned HISTOGRAM_MAX_BIT = 42;
+    constexpr std::size_t HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_BIT - HISTOGRAM_SUB_BITS + 2) << HISTOGRAM_SUB_BITS;
+
+    /// Histogram bucket holding a duration of `ns` nanoseconds.
+    inline std::size_t histogram_bucket(uint64_t ns) {
+        constexpr uint64_t SUB_BUCKETS = uint64_t{1} << HISTOGRAM_SUB_BITS;
+        if (ns < SUB_BUCKETS) return static_cast<std::size_t>(ns);
+        const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(ns));
+        if (msb > HISTOGRAM_MAX_BIT) return HISTOGRAM_BUCKETS - 1;
+        const uint64_t sub = (ns >> (msb - HISTOGRAM_SUB_BITS)) & (SUB_BUCKETS - 1);
+        return static_cast<std::size_t>(((msb - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS) + sub);
+    }
+
+    /// Largest duration (in nanoseconds) that falls into a bucket.
+    uint64_t histogram_bucket_limit(std::size_t bucket);
+
+    /**
+     * @struct Histogram
+     * @brief Aggregated latencies of one stage.
+     */
+    struct Histogram {
+        std::array<uint64_t, HISTOGRAM_BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+
+        double mean_ns() const { return count == 0 ? 0.0 : static_cast<double>(total_ns) / static_cast<double>(count); }
+
+        /**
+         * @brief Upper bound of the given percentile, e.g. 99.9.
+         * @return The duration in nanoseconds, 0 if nothing was recorded.
+         */
+        uint64_t percentile_ns(double percentile) const;
+    };
+
+    /**
+     * @struct Snapshot
+     * @brief Sum of the statistics of all threads at one point in time.
+     *
+     * Counters only grow; subtract two snapshots (`later - earlier`) to get
+     * the activity of an interval. Latency histograms hold sampled calls only
+     * (see LATENCY_SAMPLE_INTERVAL).
+     */
+    struct Snapshot {
+        std::array<uint64_t, COUNTER_COUNT> counters{};
+        std::array<uint64_t, 32> downlink_formats{};        // Decoded messages per downlink format
+        std::array<uint64_t, 32> type_codes{};              // Decoded DF17 messages per type code
+        std::array<Histogram, STAGE_COUNT> latency{};
+
+        uint64_t operator[](Counter counter) const { return counters[static_cast<std::size_t>(counter)]; }
+        const Histogram& operator[](Stage stage) const { return latency[static_cast<std::size_t>(stage)]; }
+
+        Snapshot operator-(const Snapshot& earlier) const;
+    };
+
+    /// true if the library was built with ADSB_ENABLE_STATS.
+    constexpr bool enabled() { return ADSB_ENABLE_STATS != 0; }
+
+    /**
+     * @brief Sums the statistics of all threads, including threads that have exited.
+     *
+     * Takes a lock shared with thread registration only; the counting
+     * threads are never blocked.
+     */
+    Snapshot snapshot();
+
+#if ADSB_ENABLE_STATS
+
+    namespace detail {
+        /**
+         * @struct ThreadStats
+         * @brief Counters owned and written by a single thread.
+         *
+         * Each thread increments its own block with plain relaxed loads and
+         * stores (no locked instructions); the atomics only make concurrent
+         * reads by `snapshot()` well-defined. Blocks are cache-line aligned
+         * so threads never write to a shared line.
+         */
+        struct alignas(64) ThreadStats {
+            struct Latency {
+                std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS];
+                std::atomic<uint64_t> count;
+                std::atomic<uint64_t> total_ns;
+            };
+
+            std::atomic<uint64_t> counters[COUNTER_COUNT];
+            std::atomic<uint64_t> downlink_formats[32];
+            std::atomic<uint64_t> type_codes[32];
+            Latency latency[STAGE_COUNT];
+            uint32_t timer_ticks[STAGE_COUNT];      // Only accessed by the owning thread
+        };
+
+        /// Registers a block for the calling thread on first use; it is folded into the totals when the thread exits.
+        ThreadStats* register_thread();
+        void retire_thread(ThreadStats* stats);
+
+        struct ThreadHandle {
+            ThreadStats* stats = register_thread();
+            ~ThreadHandle() { retire_thread(stats); }
+        };
+
+        inline ThreadStats& local() {
+            thread_local ThreadHandle handle;
+            return *handle.stats;
+        }
+
+        inline void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    }
+
+    inline void count(Counter counter, uint64_t amount = 1) {
+        detail::bump(detail::local().counters[static_cast<std::size_t>(counter)], amount);
+    }
+
+    /// Counts a decoded message of the given downlink format and (for DF17) type code.
+    inline void count_message(int downlink_format, int type_code) {
+        detail::ThreadStats& stats = detail::local();
+        detail::bump(stats.downlink_formats[downlink_format & 31], 1);
+        if (downlink_format == 17) detail::bump(stats.type_codes[type_code & 31], 1);
+    }
+
+    inline void record(Stage stage, uint64_t ns) {
+        detail::ThreadStats::Latency& latency = detail::local().latency[static_cast<std::size_t>(stage)];
+        detail::bump(latency.buckets[histogram_bucket(ns)], 1);
+        detail::bump(latency.count, 1);
+        detail::bump(latency.total_ns, ns);
+    }
+
+    /**
+     * @class ScopedTimer
+     * @brief Records the lifetime of the object as a latency sample of a stage.
+     *
+     * Only every LATENCY_SAMPLE_INTERVAL-th timer of a stage reads the clock.
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Stage stage)
+            : m_stage(stage),
+              m_sampled(++detail::local().timer_ticks[static_cast<std::size_t>(stage)] % LATENCY_SAMPLE_INTERVAL == 0) {
+            if (m_sampled) m_start = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedTimer() {
+            if (!m_sampled) return;
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            record(m_stage, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Stage m_stage;
+        bool m_sampled;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+#define ADSB_STATS_COUNT(counter) ::adsb::stats::count(::adsb::stats::Counter::counter)
+#define ADSB_STATS_COUNT_MESSAGE(df, type_code) ::adsb::stats::count_message((df), (type_code))
+#define ADSB_STATS_TIMER(stage) ::adsb::stats::ScopedTimer adsb_stats_timer_(::adsb::stats::Stage::stage)
+
+#else
+
+#define ADSB_STATS_COUNT(counter) ((void)0)
+#define ADSB_STATS_COUNT_MESSAGE(df, type_code) ((void)0)
+#define ADSB_STATS_TIMER(stage) ((void)0)
+
+#endif
+
+}
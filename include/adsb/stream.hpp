@@ -0,0 +1,261 @@
+#pragma once
+
+#include "adsb/types.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace adsb::stream {
+
+    /**
+     * @struct FrameView
+     * @brief One Mode S frame found in an input stream.
+     *
+     * `data` points either into the buffer passed to `feed()` or into the
+     * parser, so it is only valid inside the callback.
+     */
+    struct FrameView {
+        const uint8_t* data;            // Packed frame bytes, ready for decoder::decode()
+        std::size_t length;             // types::SHORT_FRAME_BYTES or types::LONG_FRAME_BYTES
+        uint64_t mlat_ticks;            // 12 MHz receiver timestamp, 0 if the format has none
+        uint8_t signal;                 // Beast signal level, 0 if the format has none
+
+        types::Timestamp timestamp() const { return types::from_mlat_ticks(mlat_ticks); }
+    };
+
+    namespace detail {
+        enum class ParseResult { FRAME, SKIPPED, INCOMPLETE };
+    }
+
+    /**
+     * @class BeastFormat
+     * @brief Framing rules of the Beast binary format.
+     *
+     * Each message is `0x1A <type> <6 byte timestamp> <signal> <frame>`, with
+     * every 0x1A byte inside the message doubled. Type '2' carries a short
+     * and type '3' a long Mode S frame; Mode A/C ('1') and unknown messages
+     * are skipped.
+     */
+    class BeastFormat {
+    public:
+        static constexpr uint8_t ESCAPE = 0x1A;
+        /// Longest possible message, with every byte escaped.
+        static constexpr std::size_t MAX_MESSAGE_BYTES = 2 + 2 * (7 + types::LONG_FRAME_BYTES);
+
+        static const uint8_t* find_start(const uint8_t* p, const uint8_t* end) {
+            // In a clean stream the next message starts right here
+            if (*p == ESCAPE) return p;
+            const void* found = std::memchr(p, ESCAPE, static_cast<std::size_t>(end - p));
+            return found != nullptr ? static_cast<const uint8_t*>(found) : end;
+        }
+
+        detail::ParseResult parse(const uint8_t* p, const uint8_t* end, const uint8_t*& next, FrameView& view);
+
+    private:
+        uint8_t m_message[7 + types::LONG_FRAME_BYTES];
+    };
+
+    /**
+     * @class AvrFormat
+     * @brief Framing rules of the AVR text format.
+     *
+     * Accepts `*<frame>;`, `@<timestamp><frame>;` and
+     * `<<timestamp><signal><frame>;` lines, all in hex. Mode A/C and
+     * malformed lines are skipped.
+     */
+    class AvrFormat {
+    public:
+        /// Longest possible line: marker, timestamp, signal, long frame and terminator.
+        static constexpr std::size_t MAX_MESSAGE_BYTES = 1 + 12 + 2 + 2 * types::LONG_FRAME_BYTES + 1;
+
+        static const uint8_t* find_start(const uint8_t* p, const uint8_t* end) {
+            while (p < end && *p != '*' && *p != '@' && *p != '<') ++p;
+            return p;
+        }
+
+        detail::ParseResult parse(const uint8_t* p, const uint8_t* end, const uint8_t*& next, FrameView& view);
+
+    private:
+        uint8_t m_frame[types::LONG_FRAME_BYTES];
+    };
+
+    /**
+     * @class FrameParser
+     * @brief Incremental framer that yields every Mode S frame of a byte stream.
+     *
+     * Input can be passed in chunks of any size, e.g. as it arrives from a
+     * socket: a message split across two `feed()` calls is carried over in a
+     * small internal buffer. Frames that lie entirely inside the input are
+     * not copied where the format allows it (unescaped Beast messages).
+     */
+    template <typename Format>
+    class FrameParser {
+    public:
+        /**
+         * @brief Parses the next chunk of the stream.
+         *
+         * @param data Pointer to the chunk.
+         * @param length Chunk length in bytes.
+         * @param on_frame Called as `on_frame(const FrameView&)` for every frame found.
+         * @return The number of frames passed to `on_frame`.
+         */
+        template <typename Fn>
+        std::size_t feed(const uint8_t* data, std::size_t length, Fn&& on_frame) {
+            std::size_t frames = 0;
+            const uint8_t* p = data;
+            const uint8_t* end = data + length;
+
+            // Complete the carried message with the start of this chunk, then continue in place. The carry
+            // buffer always ends at `data + taken`.
+            std::size_t taken = 0;
+            while (m_carry_size > 0) {
+                const std::size_t carried = m_carry_size;
+                const std::size_t take = std::min(length - taken, CARRY_CAPACITY - carried);
+                std::memcpy(m_carry + carried, data + taken, take);
+                m_carry_size += take;
+                taken += take;
+
+                const uint8_t* stop = scan(m_carry, m_carry + m_carry_size, m_carry + carried, on_frame, frames);
+                std::size_t used = static_cast<std::size_t>(stop - m_carry);
+                if (used >= carried) {
+                    p = data + taken - (m_carry_size - used);
+                    m_carry_size = 0;
+                    break;
+                }
+
+                // A message starting in the carried bytes is still incomplete. It may start late in the
+                // buffer (after a truncated message), so drop what was parsed and refill from the chunk.
+                if (used == 0 && take == 0) used = 1;   // A full buffer cannot hold an incomplete message; never stall
+                std::memmove(m_carry, m_carry + used, m_carry_size - used);
+                m_carry_size -= used;
+                if (taken == length) return frames;
+            }
+
+            p = scan(p, end, end, on_frame, frames);
+
+            m_carry_size = static_cast<std::size_t>(end - p);
+            std::memcpy(m_carry, p, m_carry_size);
+            return frames;
+        }
+
+        /// Drops any partially received message.
+        void reset() { m_carry_size = 0; }
+
+        /// Number of bytes of a partially received message.
+        std::size_t pending() const { return m_carry_size; }
+
+    private:
+        static constexpr std::size_t CARRY_CAPACITY = 64;
+        static_assert(Format::MAX_MESSAGE_BYTES <= CARRY_CAPACITY, "carry buffer must hold one message");
+
+        /**
+         * @brief Parses messages starting before `stop`.
+         * @return Where parsing stopped: at or after `stop`, or at an incomplete message.
+         */
+        template <typename Fn>
+        const uint8_t* scan(const uint8_t* p, const uint8_t* end, const uint8_t* stop,
+                            Fn& on_frame, std::size_t& frames) {
+            FrameView view;
+            while (p < stop) {
+                p = Format::find_start(p, end);
+                if (p == end) break;
+
+                const uint8_t* next;
+                detail::ParseResult result = m_format.parse(p, end, next, view);
+                if (result == detail::ParseResult::INCOMPLETE) break;
+                if (result == detail::ParseResult::FRAME) {
+                    on_frame(static_cast<const FrameView&>(view));
+                    ++frames;
+                }
+                p = next;
+            }
+            return p;
+        }
+
+        Format m_format;
+        uint8_t m_carry[CARRY_CAPACITY];
+        std::size_t m_carry_size = 0;
+    };
+
+    using BeastParser = FrameParser<BeastFormat>;
+    using AvrParser = FrameParser<AvrFormat>;
+
+    /**
+     * @class MappedFile
+     * @brief Read-only memory mapping of a whole file, e.g. an archived feed.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        /**
+         * @brief Maps a file, replacing any previous mapping.
+         * @return false if the file cannot be opened or mapped (see errno).
+         */
+        bool open(const std::string& path);
+        void close();
+
+        bool is_open() const { return m_open; }
+        const uint8_t* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        std::size_t m_size = 0;
+        bool m_open = false;
+    };
+
+    /**
+     * @class FdReader
+     * @brief Feeds a parser from a file descriptor, e.g. a non-blocking socket.
+     */
+    class FdReader {
+    public:
+        explicit FdReader(int fd, std::size_t buffer_size = 64 * 1024);
+
+        /**
+         * @brief Reads what is currently available and parses it.
+         *
+         * Stops when the descriptor would block, when a read returns less
+         * than a full buffer, or at end of file; for a blocking descriptor
+         * this waits for the first chunk only.
+         *
+         * @return The number of bytes read, or -1 on a read error (see errno).
+         */
+        template <typename Parser, typename Fn>
+        long read_available(Parser& parser, Fn&& on_frame) {
+            long total = 0;
+            for (;;) {
+                long count = fill();
+                if (count < 0) return total > 0 ? total : count;
+                if (count == 0) break;
+                parser.feed(m_buffer.data(), static_cast<std::size_t>(count), on_frame);
+                total += count;
+                if (static_cast<std::size_t>(count) < m_buffer.size()) break;
+            }
+            return total;
+        }
+
+        /// true once the descriptor reported end of file.
+        bool eof() const { return m_eof; }
+
+    private:
+        /// Reads one chunk into the buffer; 0 if nothing is available or at end of file.
+        long fill();
+
+        int m_fd;
+        std::vector<uint8_t> m_buffer;
+        bool m_eof;
+    };
+
+}
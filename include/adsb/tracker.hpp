@@ -0,0 +1,257 @@
+#pragma once
+
+#include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/MessageData.hpp"
+#include "adsb/types.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace adsb::tracker {
+
+    class SpatialIndex;
+
+    /**
+     * @struct CprFrame
+     * @brief The most recent even or odd CPR frame of an aircraft.
+     */
+    struct CprFrame {
+        int cpr_lat;
+        int cpr_lon;
+        types::Timestamp timestamp;
+        bool is_valid;
+    };
+
+    /**
+     * @struct AircraftState
+     * @brief Everything the tracker knows about one aircraft.
+     */
+    struct AircraftState {
+        uint32_t icao;
+        types::Timestamp last_seen;
+        uint32_t message_count;
+
+        char callsign[8];               // Not NUL-terminated, trailing spaces removed
+        uint8_t callsign_length;
+        uint64_t callsign_key;          // See message::pack_callsign(); 0 if unknown
+        message::EmitterCategory category;
+        bool has_identification;
+
+        int altitude;
+        bool has_altitude;
+
+        int squawk;                     // Four octal digits as a decimal number
+        bool has_squawk;
+
+        double speed;
+        double heading;
+        int vertical_rate;
+        bool has_velocity;
+
+        CprFrame even_frame;
+        CprFrame odd_frame;
+
+        types::GlobalPosition position;
+        types::Timestamp position_time;
+        bool has_position;
+    };
+
+    /**
+     * @struct TrackerOptions
+     * @brief Configuration of an AircraftTracker.
+     */
+    struct TrackerOptions {
+        /// Maximum number of aircraft tracked at the same time.
+        std::size_t capacity = 16384;
+        /// Aircraft not heard from for this long are removed.
+        std::chrono::seconds expiry = std::chrono::seconds(60);
+        /// Number of table slots checked for stale entries on every update.
+        std::size_t expiry_slots_per_update = 2;
+        /// Receiver position, used as reference for local CPR decoding.
+        types::GlobalPosition receiver = {0.0, 0.0, 0};
+        /// If non-zero, place aircraft without a position by local decoding against
+        /// the receiver when the result is within this range. Must stay below 180 NM.
+        double receiver_range_nm = 0.0;
+        /// Once an aircraft has a position, decode every new frame locally against it.
+        bool local_decoding = false;
+        /// Maximum age of the last known position to be used as local reference.
+        std::chrono::seconds local_reference_max_age = std::chrono::seconds(30);
+        /// If set, kept up to date with every position and removal; it must not be shared with another tracker.
+        SpatialIndex* spatial_index = nullptr;
+    };
+
+    /**
+     * @class AircraftTracker
+     * @brief Per-aircraft state keyed by the 24-bit ICAO address.
+     *
+     * Aircraft are stored in an open-addressing hash table that is allocated
+     * once at construction, so updates never allocate. Even/odd CPR frames are
+     * paired automatically and a position is computed as soon as a valid pair
+     * is available; optionally, single frames are decoded locally against the
+     * receiver or the last known position (see TrackerOptions). Stale
+     * aircraft are expired incrementally: every update inspects a few table
+     * slots, so there is never a full sweep. A second table indexes the
+     * aircraft by their packed callsign, and an optional SpatialIndex by
+     * their position.
+     *
+     * The whole state can be saved to a snapshot file and loaded again after
+     * a restart, so aircraft keep their positions and callsigns instead of
+     * waiting for a new CPR pair and identification.
+     *
+     * The class is not thread-safe. Pointers returned by `update()` and
+     * `find()` stay valid until the next call to `update()` or `expire()`.
+     */
+    class AircraftTracker {
+    public:
+        explicit AircraftTracker(const TrackerOptions& options = TrackerOptions{});
+
+        /**
+         * @brief Applies a decoded message to the state of its aircraft.
+         *
+         * @param data The decoded message; `std::monostate` is ignored.
+         * @param timestamp Reception time of the message.
+         * @return The updated aircraft state, or `nullptr` if the message was
+         * ignored or the tracker is full.
+         */
+        const AircraftState* update(const message::MessageData& data, types::Timestamp timestamp);
+
+        /**
+         * @brief Applies a message object to the state of its aircraft, using its timestamp.
+         * @see update(const message::MessageData&, types::Timestamp)
+         */
+        const AircraftState* update(const message::ADSBMessage& message);
+
+        /**
+         * @brief Looks up an aircraft by its ICAO address.
+         * @return The aircraft state, or `nullptr` if it is not tracked.
+         */
+        const AircraftState* find(uint32_t icao) const;
+
+        /**
+         * @brief Looks up the aircraft currently using a callsign, e.g. "BAW123".
+         *
+         * If several aircraft report the same callsign, the one that reported
+         * it last is returned.
+         *
+         * @return The aircraft state, or `nullptr` if no tracked aircraft uses the callsign.
+         */
+        const AircraftState* find_by_callsign(std::string_view callsign) const;
+
+        /**
+         * @brief Looks up an aircraft by the packed callsign key of a decoded message.
+         * @see find_by_callsign()
+         */
+        const AircraftState* find_by_callsign_key(uint64_t callsign_key) const;
+
+        /**
+         * @brief Removes an aircraft from the tracker.
+         * @return true if the aircraft was tracked.
+         */
+        bool remove(uint32_t icao);
+
+        /**
+         * @brief Runs one incremental expiry step.
+         *
+         * Called implicitly by `update()`; call it directly to keep expiring
+         * aircraft while no messages arrive.
+         *
+         * @param now The current time.
+         * @param slots Number of table slots to inspect.
+         */
+        void expire(types::Timestamp now, std::size_t slots);
+
+        /// Removes all aircraft.
+        void clear();
+
+        /**
+         * @brief Writes the state of all aircraft to a snapshot file.
+         *
+         * The file holds a small versioned header followed by the raw
+         * AircraftState records, with their timestamps stored as ages
+         * before `now` and the wall-clock time of the save in the header.
+         * It is written under a temporary name and renamed when complete, so
+         * a crash never leaves a torn snapshot; call this periodically and on
+         * shutdown. POSIX only.
+         *
+         * @param now The current time on the time base of the tracker.
+         * @return false on a write error.
+         */
+        bool save(const std::string& path, types::Timestamp now) const;
+
+        /**
+         * @brief Replaces the tracked aircraft with those of a snapshot file.
+         *
+         * The file is mapped and its records are copied into the table; only
+         * their timestamps are rebased and the callsign and spatial indexes
+         * rebuilt. The ages saved by `save()` are taken back from `now`,
+         * less the wall-clock time that passed since the save, so `now` may
+         * be on a different time base than that of the saving process, e.g.
+         * `steady_clock` after a reboot. Aircraft not heard from within the
+         * expiry time before `now` are skipped. Snapshots written by a build
+         * with a different AircraftState layout, and records with invalid
+         * flags, categories or callsign lengths, are rejected.
+         *
+         * @param now The current time on the time base of the tracker.
+         * @return false if the file cannot be read or is not a valid
+         * snapshot; the tracker is unchanged then.
+         */
+        bool load(const std::string& path, types::Timestamp now);
+
+        std::size_t size() const { return m_size; }
+        std::size_t capacity() const { return m_options.capacity; }
+
+        /**
+         * @brief Calls `fn(const AircraftState&)` for every tracked aircraft.
+         */
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            for (const auto& slot : m_slots) {
+                if (slot.icao != EMPTY) fn(slot);
+            }
+        }
+
+    private:
+        static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+        static constexpr uint64_t NO_CALLSIGN = 0;
+
+        /**
+         * @struct CallsignEntry
+         * @brief Slot of the callsign index, which maps callsign keys to ICAO addresses.
+         */
+        struct CallsignEntry {
+            uint64_t key;
+            uint32_t icao;
+        };
+
+        std::size_t home_slot(uint32_t icao) const;
+        std::size_t find_slot(uint32_t icao) const;
+        AircraftState* find_or_insert(uint32_t icao);
+        void erase_slot(std::size_t index);
+
+        std::size_t callsign_home_slot(uint64_t key) const;
+        std::size_t find_callsign_slot(uint64_t key) const;
+        void set_callsign(AircraftState& state, const char (&callsign)[8], uint8_t length, uint64_t key);
+        void unindex_callsign(const AircraftState& state);
+
+        void apply(AircraftState& state, const message::IdentificationData& data, types::Timestamp timestamp);
+        void apply(AircraftState& state, const message::AirbornePositionData& data, types::Timestamp timestamp);
+        void apply(AircraftState& state, const message::VelocityData& data, types::Timestamp timestamp);
+        void apply(AircraftState& state, const message::AllCallData& data, types::Timestamp timestamp);
+        void apply(AircraftState& state, const message::SurveillanceData& data, types::Timestamp timestamp);
+        void set_position(AircraftState& state, const types::GlobalPosition& position, types::Timestamp timestamp);
+        void restore(const AircraftState& saved);
+
+        TrackerOptions m_options;
+        std::vector<AircraftState> m_slots;
+        std::vector<CallsignEntry> m_callsigns;     // Same size as m_slots: at most one callsign per aircraft
+        std::size_t m_mask;
+        unsigned m_shift;
+        std::size_t m_size;
+        std::size_t m_expiry_cursor;
+    };
+
+}
@@ -1,6 +1,44 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
 namespace adsb::types {
+    /// Length in bytes of a long (112-bit) Mode S frame, e.g. DF17.
+    constexpr std::size_t LONG_FRAME_BYTES  = 14;
+    /// Length in bytes of a short (56-bit) Mode S frame, e.g. DF11.
+    constexpr std::size_t SHORT_FRAME_BYTES = 7;
+
+    /// Reception time of a frame.
+    using Timestamp = std::chrono::steady_clock::time_point;
+
+    /// Frequency of the Beast/MLAT timestamp counter.
+    constexpr uint64_t MLAT_TICKS_PER_SECOND = 12000000;
+
+    /**
+     * @brief Converts a nanosecond count on the caller's time base to a Timestamp.
+     */
+    inline Timestamp from_nanoseconds(int64_t nanoseconds) {
+        return Timestamp(std::chrono::duration_cast<Timestamp::duration>(std::chrono::nanoseconds(nanoseconds)));
+    }
+
+    /**
+     * @brief Converts a 12 MHz Beast/MLAT tick count to a Timestamp.
+     */
+    inline Timestamp from_mlat_ticks(uint64_t ticks) {
+        const uint64_t seconds = ticks / MLAT_TICKS_PER_SECOND;
+        const uint64_t remainder = ticks % MLAT_TICKS_PER_SECOND;
+        return from_nanoseconds(static_cast<int64_t>(seconds * 1000000000ULL + remainder * 1000ULL / 12ULL));
+    }
+
+    /**
+     * @brief Converts a Timestamp to nanoseconds on its time base.
+     */
+    inline int64_t to_nanoseconds(Timestamp timestamp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    }
+
     /**
      * @struct GlobalPosition
      * @brief Represents a geographical position with latitude and longitude.
@@ -19,4 +57,4 @@ namespace adsb::types {
         GlobalPosition position;
         bool is_valid;
     };
-}
\ No newline at end of file
+}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include "adsb/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace adsb::utils {
@@ -11,4 +17,111 @@ namespace adsb::utils {
      * @return The resulting integer value.
      */
     int bits_to_int(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end);
-}
\ No newline at end of file
+
+    /**
+     * @brief Extracts a bit field from a packed 56-bit payload (ME field).
+     *
+     * Bit 0 is the most significant bit of the payload, matching the bit
+     * numbering used by the ADS-B decoding guide.
+     *
+     * @param payload The 56-bit payload, right-aligned in a 64-bit word.
+     * @param start Index of the first bit of the field.
+     * @param length Number of bits in the field (at most 32).
+     * @return The resulting integer value.
+     */
+    inline uint32_t bits_to_int(uint64_t payload, int start, int length) {
+        return static_cast<uint32_t>((payload >> (56 - start - length)) & ((uint64_t{1} << length) - 1));
+    }
+
+    /**
+     * @brief Compile-time descriptor of a bit field in a packed 56-bit payload (ME/MB field).
+     *
+     * Bits are numbered as in `bits_to_int()`, so `Field<8, 12>` is the
+     * altitude code of a position message; `get()` and `put()` are a single
+     * shift and mask.
+     *
+     * @tparam Start Index of the first bit of the field.
+     * @tparam Length Number of bits in the field.
+     */
+    template <int Start, int Length>
+    struct Field {
+        static_assert(Start >= 0 && Length > 0 && Start + Length <= 56, "field must lie within the 56-bit payload");
+
+        using value_type = std::conditional_t<(Length <= 32), uint32_t, uint64_t>;
+
+        static constexpr int SHIFT = 56 - Start - Length;
+        static constexpr uint64_t MASK = (uint64_t{1} << Length) - 1;
+
+        static constexpr value_type get(uint64_t payload) {
+            return static_cast<value_type>((payload >> SHIFT) & MASK);
+        }
+
+        /// The payload bits of a field value; OR the results of several fields together.
+        static constexpr uint64_t put(uint64_t value) {
+            return (value & MASK) << SHIFT;
+        }
+    };
+
+    /**
+     * @brief Reads `count` bytes (at most 8) as a big-endian unsigned integer.
+     */
+    inline uint64_t load_be(const uint8_t* bytes, std::size_t count) {
+        uint64_t value = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            value = (value << 8) | bytes[i];
+        }
+        return value;
+    }
+
+    /**
+     * @brief Packs a sequence of bits (0 or 1) into bytes, MSB first.
+     *
+     * @param bits The bit sequence; its size must be a multiple of 8.
+     * @param out Destination buffer of at least `bits.size() / 8` bytes.
+     */
+    void pack_bits(const std::vector<int>& bits, uint8_t* out);
+
+    /**
+     * @brief Parses a hex encoded frame into bytes.
+     *
+     * Accepts plain hex digits as well as an AVR style line (`*8D...;`);
+     * surrounding whitespace is ignored.
+     *
+     * @param hex The hex text.
+     * @param out Destination buffer.
+     * @param capacity Size of the destination buffer in bytes.
+     * @return The number of bytes written, or 0 if the text is not valid hex
+     * or does not fit into the buffer.
+     */
+    std::size_t hex_to_bytes(std::string_view hex, uint8_t* out, std::size_t capacity);
+
+    /**
+     * @brief Great-circle distance between two positions.
+     * @return The distance in nautical miles.
+     */
+    double distance_nm(const types::GlobalPosition& a, const types::GlobalPosition& b);
+
+    /**
+     * @brief Advances a SplitMix64 generator and returns its next 64 random bits.
+     *
+     * Small, fast and seedable with any value; used where a reproducible
+     * random sequence is needed on a hot path (encoder, simulator).
+     */
+    inline uint64_t next_random(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Combines several lambdas into one function object, e.g. a visitor for `decoder::decode_visit()`.
+     */
+    template <typename... Fns>
+    struct overloaded : Fns... {
+        using Fns::operator()...;
+    };
+
+    template <typename... Fns>
+    overloaded(Fns...) -> overloaded<Fns...>;
+}
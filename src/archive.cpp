@@ -0,0 +1,391 @@
+#include "adsb/archive.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    using adsb::archive::ChunkIndexEntry;
+    using adsb::archive::KIND_COUNT;
+    using namespace adsb::message;
+
+    constexpr char DATA_MAGIC[8] = {'A', 'D', 'S', 'B', 'A', 'R', 'C', '1'};
+    constexpr char INDEX_MAGIC[8] = {'A', 'D', 'S', 'B', 'I', 'D', 'X', '1'};
+    constexpr uint32_t CHUNK_MAGIC = 0x4B484341;        // "ACHK"
+    constexpr std::size_t FILE_HEADER_BYTES = 16;
+    constexpr std::size_t ALIGNMENT = 8;
+
+    /**
+     * @struct ChunkHeader
+     * @brief Start of a chunk in the data file; the columns follow, each padded to 8 bytes.
+     */
+    struct ChunkHeader {
+        uint32_t magic;
+        uint8_t kind;
+        uint8_t column_count;
+        uint16_t reserved;
+        uint32_t rows;
+        uint32_t reserved2;
+    };
+
+    static_assert(sizeof(ChunkHeader) % ALIGNMENT == 0, "columns must stay aligned");
+    static_assert(sizeof(ChunkIndexEntry) % ALIGNMENT == 0, "index records must stay aligned");
+
+    /**
+     * @struct Column
+     * @brief A field of a message struct, stored as an array of its raw bytes.
+     */
+    struct Column {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+#define ADSB_ARCHIVE_COLUMN(Type, field) Column{offsetof(Type, field), sizeof(Type::field)}
+
+    constexpr Column IDENTIFICATION_COLUMNS[] = {
+        ADSB_ARCHIVE_COLUMN(IdentificationData, type_code),
+        ADSB_ARCHIVE_COLUMN(IdentificationData, category),
+        ADSB_ARCHIVE_COLUMN(IdentificationData, callsign),
+        ADSB_ARCHIVE_COLUMN(IdentificationData, callsign_length),
+        ADSB_ARCHIVE_COLUMN(IdentificationData, callsign_key),
+    };
+
+    constexpr Column AIRBORNE_POSITION_COLUMNS[] = {
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, type_code),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, surveillance_status),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, nic_supplement_b),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, altitude),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, time_utc_sync),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, is_odd),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, cpr_lat),
+        ADSB_ARCHIVE_COLUMN(AirbornePositionData, cpr_lon),
+    };
+
+    constexpr Column VELOCITY_COLUMNS[] = {
+        ADSB_ARCHIVE_COLUMN(VelocityData, type_code),
+        ADSB_ARCHIVE_COLUMN(VelocityData, speed),
+        ADSB_ARCHIVE_COLUMN(VelocityData, heading),
+        ADSB_ARCHIVE_COLUMN(VelocityData, vertical_rate),
+    };
+
+    constexpr Column ALL_CALL_COLUMNS[] = {
+        ADSB_ARCHIVE_COLUMN(AllCallData, capability),
+        ADSB_ARCHIVE_COLUMN(AllCallData, interrogator),
+    };
+
+    constexpr Column SURVEILLANCE_COLUMNS[] = {
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, downlink_format),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, flight_status),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, altitude),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, has_altitude),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, squawk),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, has_squawk),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, callsign),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, callsign_length),
+        ADSB_ARCHIVE_COLUMN(SurveillanceData, callsign_key),
+    };
+
+#undef ADSB_ARCHIVE_COLUMN
+
+    /**
+     * @struct Schema
+     * @brief The columns of one message kind; the ICAO address is the first member of every struct.
+     */
+    struct Schema {
+        const Column* columns;
+        std::size_t count;
+    };
+
+    template <std::size_t N>
+    constexpr Schema schema_of(const Column (&columns)[N]) {
+        return {columns, N};
+    }
+
+    constexpr Schema SCHEMAS[KIND_COUNT] = {
+        {nullptr, 0},
+        schema_of(IDENTIFICATION_COLUMNS),
+        schema_of(AIRBORNE_POSITION_COLUMNS),
+        schema_of(VELOCITY_COLUMNS),
+        schema_of(ALL_CALL_COLUMNS),
+        schema_of(SURVEILLANCE_COLUMNS),
+    };
+
+    static_assert(offsetof(IdentificationData, icao) == 0 && offsetof(AirbornePositionData, icao) == 0
+                  && offsetof(VelocityData, icao) == 0 && offsetof(AllCallData, icao) == 0
+                  && offsetof(SurveillanceData, icao) == 0, "the ICAO column is read from the start of each struct");
+
+    std::size_t padded(std::size_t bytes) {
+        return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    /// Size of a chunk with `rows` rows of a kind, header included.
+    std::size_t chunk_bytes(const Schema& schema, std::size_t rows) {
+        std::size_t bytes = sizeof(ChunkHeader) + padded(rows * sizeof(int64_t)) + padded(rows * sizeof(uint32_t));
+        for (std::size_t c = 0; c < schema.count; ++c) bytes += padded(rows * schema.columns[c].size);
+        return bytes;
+    }
+
+    /// Raw bytes of the message struct held by `data`; nullptr for std::monostate.
+    const uint8_t* bytes_of(const MessageData& data) {
+        return std::visit([](const auto& message) -> const uint8_t* {
+            if constexpr (std::is_same_v<std::decay_t<decltype(message)>, std::monostate>) return nullptr;
+            else return reinterpret_cast<const uint8_t*>(&message);
+        }, data);
+    }
+
+    uint8_t* bytes_of(MessageData& data) {
+        return const_cast<uint8_t*>(bytes_of(static_cast<const MessageData&>(data)));
+    }
+
+    /// Default-constructs alternative `kind` of `data`.
+    void emplace_kind(MessageData& data, std::size_t kind) {
+        switch (kind) {
+            case 1: data.emplace<1>(); break;
+            case 2: data.emplace<2>(); break;
+            case 3: data.emplace<3>(); break;
+            case 4: data.emplace<4>(); break;
+            case 5: data.emplace<5>(); break;
+            default: data.emplace<0>(); break;
+        }
+    }
+
+    /**
+     * @brief Opens a file for appending, after checking or writing its header.
+     * @param[out] size The file size, without any torn record at the end.
+     */
+    std::FILE* open_for_append(const std::string& path, const char (&magic)[8], std::size_t record_bytes,
+                               uint64_t& size) {
+        struct stat info {};
+        if (::stat(path.c_str(), &info) == 0 && info.st_size > 0) {
+            std::FILE* existing = std::fopen(path.c_str(), "rb");
+            if (existing == nullptr) return nullptr;
+            char header[FILE_HEADER_BYTES];
+            const bool valid = std::fread(header, 1, sizeof(header), existing) == sizeof(header)
+                            && std::memcmp(header, magic, sizeof(magic)) == 0;
+            std::fclose(existing);
+            if (!valid) return nullptr;
+
+            // Cut off what an interrupted write left behind, so that new records stay aligned
+            size = static_cast<uint64_t>(info.st_size);
+            size -= (size - FILE_HEADER_BYTES) % record_bytes;
+            if (size != static_cast<uint64_t>(info.st_size) && ::truncate(path.c_str(), static_cast<off_t>(size)) != 0) {
+                return nullptr;
+            }
+            return std::fopen(path.c_str(), "ab");
+        }
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) return nullptr;
+        char header[FILE_HEADER_BYTES] = {};
+        std::memcpy(header, magic, sizeof(magic));
+        header[8] = 1;                                  // Format version
+        if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+            std::fclose(file);
+            return nullptr;
+        }
+        size = FILE_HEADER_BYTES;
+        return file;
+    }
+
+}
+
+namespace adsb::archive {
+
+    ArchiveWriter::ArchiveWriter(const ArchiveWriterOptions& options) : m_options(options) {
+        m_options.chunk_rows = std::clamp<std::size_t>(options.chunk_rows, 1, UINT32_MAX);
+    }
+
+    ArchiveWriter::~ArchiveWriter() {
+        close();
+    }
+
+    bool ArchiveWriter::open(const std::string& path) {
+        close();
+        uint64_t index_size = 0;
+        m_data = open_for_append(path, DATA_MAGIC, ALIGNMENT, m_data_size);
+        m_index = m_data != nullptr ? open_for_append(path + ".idx", INDEX_MAGIC, sizeof(ChunkIndexEntry), index_size)
+                                    : nullptr;
+        if (m_index == nullptr) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool ArchiveWriter::append(const message::MessageData& data, types::Timestamp timestamp) {
+        const std::size_t kind = data.index();
+        if (m_data == nullptr || kind == 0) return false;
+        std::vector<std::pair<int64_t, message::MessageData>>& pending = m_pending[kind];
+        pending.emplace_back(types::to_nanoseconds(timestamp), data);
+        return pending.size() < m_options.chunk_rows || write_chunk(kind);
+    }
+
+    bool ArchiveWriter::write_chunk(std::size_t kind) {
+        std::vector<std::pair<int64_t, message::MessageData>>& pending = m_pending[kind];
+        if (pending.empty()) return true;
+        const Schema& schema = SCHEMAS[kind];
+        const std::size_t rows = pending.size();
+
+        // Rows by ICAO address, then time
+        m_order.resize(rows);
+        for (std::size_t i = 0; i < rows; ++i) m_order[i] = static_cast<uint32_t>(i);
+        std::sort(m_order.begin(), m_order.end(), [&pending](uint32_t a, uint32_t b) {
+            const uint32_t icao_a = message::icao_of(pending[a].second);
+            const uint32_t icao_b = message::icao_of(pending[b].second);
+            return icao_a != icao_b ? icao_a < icao_b : pending[a].first < pending[b].first;
+        });
+
+        m_chunk.assign(chunk_bytes(schema, rows), 0);
+        const ChunkHeader header{CHUNK_MAGIC, static_cast<uint8_t>(kind), static_cast<uint8_t>(schema.count), 0,
+                                 static_cast<uint32_t>(rows), 0};
+        std::memcpy(m_chunk.data(), &header, sizeof(header));
+
+        ChunkIndexEntry entry{m_data_size, static_cast<uint32_t>(rows), static_cast<uint8_t>(kind), {},
+                              INT64_MAX, INT64_MIN, UINT32_MAX, 0};
+        uint8_t* times = m_chunk.data() + sizeof(ChunkHeader);
+        uint8_t* icaos = times + padded(rows * sizeof(int64_t));
+        for (std::size_t row = 0; row < rows; ++row) {
+            const auto& [time_ns, data] = pending[m_order[row]];
+            const uint32_t icao = message::icao_of(data);
+            std::memcpy(times + row * sizeof(int64_t), &time_ns, sizeof(int64_t));
+            std::memcpy(icaos + row * sizeof(uint32_t), &icao, sizeof(uint32_t));
+            entry.min_time_ns = std::min(entry.min_time_ns, time_ns);
+            entry.max_time_ns = std::max(entry.max_time_ns, time_ns);
+            entry.min_icao = std::min(entry.min_icao, icao);
+            entry.max_icao = std::max(entry.max_icao, icao);
+        }
+
+        uint8_t* column = icaos + padded(rows * sizeof(uint32_t));
+        for (std::size_t c = 0; c < schema.count; ++c) {
+            const Column& field = schema.columns[c];
+            for (std::size_t row = 0; row < rows; ++row) {
+                std::memcpy(column + row * field.size, bytes_of(pending[m_order[row]].second) + field.offset, field.size);
+            }
+            column += padded(rows * field.size);
+        }
+        pending.clear();
+
+        // Data first: an index record must never point past the end of the data file
+        if (std::fwrite(m_chunk.data(), 1, m_chunk.size(), m_data) != m_chunk.size() || std::fflush(m_data) != 0) {
+            return false;
+        }
+        m_data_size += m_chunk.size();
+        return std::fwrite(&entry, sizeof(entry), 1, m_index) == 1;
+    }
+
+    bool ArchiveWriter::flush() {
+        if (m_data == nullptr) return false;
+        bool ok = true;
+        for (std::size_t kind = 1; kind < KIND_COUNT; ++kind) ok = write_chunk(kind) && ok;
+        return std::fflush(m_data) == 0 && std::fflush(m_index) == 0 && ok;
+    }
+
+    bool ArchiveWriter::close() {
+        if (m_data == nullptr) return true;
+        bool ok = m_index != nullptr && flush();
+        ok = std::fclose(m_data) == 0 && ok;
+        if (m_index != nullptr) ok = std::fclose(m_index) == 0 && ok;
+        m_data = nullptr;
+        m_index = nullptr;
+        return ok;
+    }
+
+    ArchiveReader::~ArchiveReader() {
+        close();
+    }
+
+    bool ArchiveReader::open(const std::string& path) {
+        close();
+        const bool valid = m_data_file.open(path) && m_index_file.open(path + ".idx")
+                        && m_data_file.size() >= FILE_HEADER_BYTES
+                        && std::memcmp(m_data_file.data(), DATA_MAGIC, sizeof(DATA_MAGIC)) == 0
+                        && m_index_file.size() >= FILE_HEADER_BYTES
+                        && std::memcmp(m_index_file.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0;
+        if (!valid) {
+            close();
+            return false;
+        }
+        m_entries = reinterpret_cast<const ChunkIndexEntry*>(m_index_file.data() + FILE_HEADER_BYTES);
+        m_entry_count = (m_index_file.size() - FILE_HEADER_BYTES) / sizeof(ChunkIndexEntry);
+        return true;
+    }
+
+    void ArchiveReader::close() {
+        m_data_file.close();
+        m_index_file.close();
+        m_entries = nullptr;
+        m_entry_count = 0;
+    }
+
+    ScanStats ArchiveReader::scan(const ArchiveQuery& query,
+                                  const std::function<void(const message::MessageData&, types::Timestamp)>& fn) const {
+        ScanStats stats;
+        stats.chunks = m_entry_count;
+        const uint8_t* base = m_data_file.data();
+        const std::size_t data_size = m_data_file.size();
+        const int64_t begin_ns = types::to_nanoseconds(query.begin);
+        const int64_t end_ns = types::to_nanoseconds(query.end);
+        const bool any_icao = query.icao == ANY_ICAO;
+        message::MessageData data;
+
+        for (std::size_t i = 0; i < m_entry_count; ++i) {
+            const ChunkIndexEntry& entry = m_entries[i];
+            if (entry.kind == 0 || entry.kind >= KIND_COUNT || (query.kinds & (uint32_t{1} << entry.kind)) == 0) continue;
+            if (entry.max_time_ns < begin_ns || entry.min_time_ns >= end_ns) continue;
+            if (!any_icao && (query.icao < entry.min_icao || query.icao > entry.max_icao)) continue;
+
+            // Skip records that do not match a complete chunk, e.g. of a damaged file
+            const Schema& schema = SCHEMAS[entry.kind];
+            if (entry.offset % ALIGNMENT != 0 || entry.offset > data_size
+                || chunk_bytes(schema, entry.rows) > data_size - entry.offset) {
+                continue;
+            }
+            ChunkHeader header;
+            std::memcpy(&header, base + entry.offset, sizeof(header));
+            if (header.magic != CHUNK_MAGIC || header.kind != entry.kind || header.rows != entry.rows
+                || header.column_count != schema.count) {
+                continue;
+            }
+            ++stats.chunks_read;
+
+            const std::size_t rows = entry.rows;
+            const auto* times = reinterpret_cast<const int64_t*>(base + entry.offset + sizeof(ChunkHeader));
+            const auto* icaos = reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(times)
+                                                                  + padded(rows * sizeof(int64_t)));
+            const uint8_t* columns = reinterpret_cast<const uint8_t*>(icaos) + padded(rows * sizeof(uint32_t));
+
+            std::size_t first = 0;
+            std::size_t last = rows;
+            if (!any_icao) {
+                // The aircraft's rows are adjacent and in time order
+                const auto range = std::equal_range(icaos, icaos + rows, query.icao);
+                first = static_cast<std::size_t>(range.first - icaos);
+                last = static_cast<std::size_t>(range.second - icaos);
+                first = static_cast<std::size_t>(std::lower_bound(times + first, times + last, begin_ns) - times);
+                last = static_cast<std::size_t>(std::lower_bound(times + first, times + last, end_ns) - times);
+            }
+            stats.rows_read += last - first;
+
+            for (std::size_t row = first; row < last; ++row) {
+                if (times[row] < begin_ns || times[row] >= end_ns) continue;
+                emplace_kind(data, entry.kind);
+                uint8_t* bytes = bytes_of(data);
+                std::memcpy(bytes, &icaos[row], sizeof(uint32_t));
+                const uint8_t* column = columns;
+                for (std::size_t c = 0; c < schema.count; ++c) {
+                    const Column& field = schema.columns[c];
+                    std::memcpy(bytes + field.offset, column + row * field.size, field.size);
+                    column += padded(rows * field.size);
+                }
+                ++stats.matches;
+                fn(data, types::from_nanoseconds(times[row]));
+            }
+        }
+        return stats;
+    }
+
+}
@@ -0,0 +1,386 @@
+#include "adsb/cpr.hpp"
+#include "adsb/stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ADSB_CPR_HAVE_AVX2 1
+#endif
+
+namespace {
+
+    constexpr int64_t CPR_SCALE = adsb::cpr::CPR_MAX;
+    constexpr double CPR_MAX_D = static_cast<double>(adsb::cpr::CPR_MAX);
+
+    // Latitude zone sizes of even (NZ = 15) and odd frames, in degrees
+    constexpr double D_LAT_EVEN = 360.0 / 60.0;
+    constexpr double D_LAT_ODD  = 360.0 / 59.0;
+
+    /**
+     * @brief Latitudes at which NL decreases by one, in ascending order.
+     *
+     * Entry i is the latitude from which on NL(lat) = 58 - i, i.e.
+     * acos(sqrt((1 - cos(pi / 30)) / (1 - cos(2 * pi / (59 - i))))) in degrees.
+     */
+    constexpr std::array<double, 58> NL_TRANSITIONS = {
+        10.47047129996848, 14.828174368686794, 18.186263570713354, 21.029394926028463,
+        23.545044865570706, 25.829247070587755, 27.938987101219045, 29.911356857318083,
+        31.77209707681077, 33.53993436298484, 35.22899597796385, 36.85025107593526,
+        38.41241892412256, 39.922566843338615, 41.38651832260239, 42.80914012243555,
+        44.194549514192744, 45.546267226602346, 46.867332524987454, 48.160391280966216,
+        49.42776439255687, 50.67150165553835, 51.893424691687684, 53.09516152796003,
+        54.278174722729, 55.44378444495043, 56.59318756205918, 57.72747353866114,
+        58.84763776148457, 59.954592766940294, 61.04917774246351, 62.13216659210329,
+        63.20427479381928, 64.2661652256744, 65.31845309682089, 66.36171008382617,
+        67.39646774084667, 68.4232202208333, 69.44242631144024, 70.454510749876,
+        71.45986473028982, 72.45884544728945, 73.45177441667865, 74.43893415725137,
+        75.42056256653356, 76.39684390794469, 77.36789461328188, 78.33374082922747,
+        79.29428225456925, 80.24923213280512, 81.19801349271948, 82.13956980510606,
+        83.07199444719814, 83.99173562980565, 84.89166190702085, 85.75541620944418,
+        86.535369975121, 87.0,
+    };
+
+    /**
+     * @struct NLIndex
+     * @brief Direct-index form of NL_TRANSITIONS, with half-degree buckets.
+     *
+     * `base[b]` is NL at the start of bucket b (latitude b / 2) and
+     * `transition[b]` the single transition latitude strictly inside the
+     * bucket (or a value above 90 if there is none), so
+     * NL(lat) = base[b] - (|lat| >= transition[b]).
+     */
+    struct NLIndex {
+        static constexpr int BUCKETS = 181;
+        double base[BUCKETS];
+        double transition[BUCKETS];
+    };
+
+    constexpr NLIndex make_nl_index() {
+        NLIndex index{};
+        for (int b = 0; b < NLIndex::BUCKETS; ++b) {
+            double start = b * 0.5;
+            int passed = 0;
+            double inside = 1000.0;
+            for (double t : NL_TRANSITIONS) {
+                if (t <= start) ++passed;
+                else if (t < start + 0.5) inside = t;
+            }
+            index.base[b] = 59 - passed;
+            index.transition[b] = inside;
+        }
+        return index;
+    }
+
+    constexpr bool nl_buckets_hold_one_transition() {
+        for (int b = 0; b < NLIndex::BUCKETS; ++b) {
+            int inside = 0;
+            for (double t : NL_TRANSITIONS) {
+                if (t > b * 0.5 && t < b * 0.5 + 0.5) ++inside;
+            }
+            if (inside > 1) return false;
+        }
+        return true;
+    }
+
+    static_assert(nl_buckets_hold_one_transition(), "NL index buckets must contain at most one transition");
+
+    constexpr NLIndex NL_INDEX = make_nl_index();
+
+    /**
+     * @brief Floor division for a positive divisor.
+     */
+    constexpr int64_t floor_div(int64_t a, int64_t b) {
+        return (a >= 0) ? a / b : -((-a + b - 1) / b);
+    }
+
+    /**
+     * @brief Modulo with a result in [0, b) for a positive divisor.
+     */
+    constexpr int64_t positive_mod(int64_t a, int64_t b) {
+        int64_t r = a % b;
+        return r < 0 ? r + b : r;
+    }
+
+    /**
+     * @brief floor() for values well within the int64_t range, without a library call.
+     */
+    inline int64_t floor_to_int(double x) {
+        const auto truncated = static_cast<int64_t>(x);
+        return static_cast<double>(truncated) > x ? truncated - 1 : truncated;
+    }
+
+    /**
+     * @brief Modulo with a result in [0, y) for positive y, unlike std::fmod.
+     */
+    double positive_mod(double x, double y) {
+        double r = std::fmod(x, y);
+        return r < 0 ? r + y : r;
+    }
+
+    /**
+     * @brief Converts a fixed-point CPR coordinate (zone index * 2^17 + fraction) to degrees.
+     *
+     * The product is rounded once and the scaling by 2^17 is exact, so the
+     * result is identical to evaluating `zone_size * (index + fraction / 2^17)`
+     * in double precision.
+     */
+    double to_degrees(int64_t fixed, double zone_size) {
+        return static_cast<double>(fixed) * zone_size / CPR_MAX_D;
+    }
+
+    constexpr int64_t MAX_PAIR_INTERVAL_NS =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(adsb::cpr::MAX_PAIR_INTERVAL).count();
+
+    bool in_pair_window(int64_t even_time_ns, int64_t odd_time_ns) {
+        int64_t diff = even_time_ns - odd_time_ns;
+        return diff <= MAX_PAIR_INTERVAL_NS && diff >= -MAX_PAIR_INTERVAL_NS;
+    }
+
+    std::size_t global_position_batch_scalar(const adsb::cpr::PairBatch& pairs,
+                                             const adsb::cpr::PositionBatch& positions,
+                                             std::size_t begin) {
+        std::size_t valid = 0;
+        for (std::size_t i = begin; i < pairs.count; ++i) {
+            adsb::types::PositionResult result{{0.0, 0.0, 0}, false};
+            if (in_pair_window(pairs.even_time_ns[i], pairs.odd_time_ns[i])) {
+                result = adsb::cpr::global_position(pairs.even_lat[i], pairs.even_lon[i],
+                                                    pairs.odd_lat[i], pairs.odd_lon[i],
+                                                    pairs.even_time_ns[i] > pairs.odd_time_ns[i]);
+            }
+            if (!result.is_valid) result.position = {0.0, 0.0, 0};
+            positions.latitude[i] = result.position.latitude;
+            positions.longitude[i] = result.position.longitude;
+            positions.is_valid[i] = result.is_valid ? 1 : 0;
+            valid += result.is_valid ? 1 : 0;
+        }
+        return valid;
+    }
+
+#ifdef ADSB_CPR_HAVE_AVX2
+
+    __attribute__((target("avx2")))
+    inline __m256d positive_mod_pd(__m256d a, __m256d b) {
+        return _mm256_sub_pd(a, _mm256_mul_pd(b, _mm256_floor_pd(_mm256_div_pd(a, b))));
+    }
+
+    /**
+     * @brief Subtracts `full` from the lanes of `value` that are >= `limit`.
+     */
+    __attribute__((target("avx2")))
+    inline __m256d wrap_pd(__m256d value, __m256d limit, __m256d full) {
+        __m256d over = _mm256_cmp_pd(value, limit, _CMP_GE_OQ);
+        return _mm256_blendv_pd(value, _mm256_sub_pd(value, full), over);
+    }
+
+    /**
+     * @brief Vector NL() through the direct-index bucket table.
+     */
+    __attribute__((target("avx2")))
+    inline __m256d nl_pd(__m256d abs_lat) {
+        __m256d scaled = _mm256_min_pd(_mm256_mul_pd(abs_lat, _mm256_set1_pd(2.0)),
+                                       _mm256_set1_pd(NLIndex::BUCKETS - 1));
+        __m128i bucket = _mm256_cvttpd_epi32(scaled);
+        // The masked gathers with explicit source and mask are equivalent to _mm256_i32gather_pd(), which
+        // starts from an undefined register that GCC reports as maybe uninitialized
+        const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d base = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), NL_INDEX.base, bucket, all_lanes, 8);
+        __m256d transition = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), NL_INDEX.transition, bucket, all_lanes, 8);
+        __m256d passed = _mm256_and_pd(_mm256_cmp_pd(abs_lat, transition, _CMP_GE_OQ), _mm256_set1_pd(1.0));
+        return _mm256_sub_pd(base, passed);
+    }
+
+    /**
+     * @brief AVX2 version of the global CPR equations, four pairs at a time.
+     *
+     * Integer zone arithmetic is carried out on doubles holding exact integers
+     * (all values stay far below 2^53), and every floating point operation
+     * matches the scalar path one to one, so results are bit-identical.
+     * FMA is deliberately not enabled to keep products rounded separately.
+     */
+    __attribute__((target("avx2")))
+    std::size_t global_position_batch_avx2(const adsb::cpr::PairBatch& pairs,
+                                           const adsb::cpr::PositionBatch& positions) {
+        const __m256d scale = _mm256_set1_pd(static_cast<double>(CPR_SCALE));
+        const __m256d inv_scale = _mm256_set1_pd(1.0 / static_cast<double>(CPR_SCALE));
+        const __m256d half_scale = _mm256_set1_pd(static_cast<double>(CPR_SCALE / 2));
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d c59 = _mm256_set1_pd(59.0);
+        const __m256d c60 = _mm256_set1_pd(60.0);
+        const __m256d c90 = _mm256_set1_pd(90.0);
+        const __m256d c180 = _mm256_set1_pd(180.0);
+        const __m256d c270 = _mm256_set1_pd(270.0);
+        const __m256d c360 = _mm256_set1_pd(360.0);
+        const __m256d d_lat_even = _mm256_set1_pd(D_LAT_EVEN);
+        const __m256d d_lat_odd = _mm256_set1_pd(D_LAT_ODD);
+        const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+        const __m256i window = _mm256_set1_epi64x(MAX_PAIR_INTERVAL_NS);
+        const __m256i neg_window = _mm256_set1_epi64x(-MAX_PAIR_INTERVAL_NS);
+
+        std::size_t valid = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= pairs.count; i += 4) {
+            __m256d y_even = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs.even_lat + i)));
+            __m256d x_even = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs.even_lon + i)));
+            __m256d y_odd  = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs.odd_lat + i)));
+            __m256d x_odd  = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pairs.odd_lon + i)));
+            __m256i t_even = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs.even_time_ns + i));
+            __m256i t_odd  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs.odd_time_ns + i));
+
+            __m256i diff = _mm256_sub_epi64(t_even, t_odd);
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(diff, window), _mm256_cmpgt_epi64(neg_window, diff));
+            __m256d ok = _mm256_castsi256_pd(_mm256_xor_si256(outside, _mm256_set1_epi64x(-1)));
+            __m256d even_newer = _mm256_castsi256_pd(_mm256_cmpgt_epi64(t_even, t_odd));
+
+            // j = floor((59 * lat_even - 60 * lat_odd + 2^16) / 2^17)
+            __m256d j = _mm256_floor_pd(_mm256_mul_pd(
+                _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(c59, y_even), _mm256_mul_pd(c60, y_odd)), half_scale), inv_scale));
+
+            __m256d fixed_even = _mm256_add_pd(_mm256_mul_pd(positive_mod_pd(j, c60), scale), y_even);
+            __m256d fixed_odd  = _mm256_add_pd(_mm256_mul_pd(positive_mod_pd(j, c59), scale), y_odd);
+            __m256d r_lat_even = wrap_pd(_mm256_mul_pd(_mm256_mul_pd(fixed_even, d_lat_even), inv_scale), c270, c360);
+            __m256d r_lat_odd  = wrap_pd(_mm256_mul_pd(_mm256_mul_pd(fixed_odd, d_lat_odd), inv_scale), c270, c360);
+
+            ok = _mm256_and_pd(ok, _mm256_cmp_pd(_mm256_and_pd(r_lat_even, abs_mask), c90, _CMP_LE_OQ));
+            ok = _mm256_and_pd(ok, _mm256_cmp_pd(_mm256_and_pd(r_lat_odd, abs_mask), c90, _CMP_LE_OQ));
+
+            __m256d nl = nl_pd(_mm256_and_pd(r_lat_even, abs_mask));
+            ok = _mm256_and_pd(ok, _mm256_cmp_pd(nl, nl_pd(_mm256_and_pd(r_lat_odd, abs_mask)), _CMP_EQ_OQ));
+
+            __m256d latitude = _mm256_blendv_pd(r_lat_odd, r_lat_even, even_newer);
+
+            // m = floor((lon_even * (nl - 1) - lon_odd * nl + 2^16) / 2^17)
+            __m256d m = _mm256_floor_pd(_mm256_mul_pd(
+                _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(x_even, _mm256_sub_pd(nl, one)), _mm256_mul_pd(x_odd, nl)), half_scale),
+                inv_scale));
+            __m256d n_i = _mm256_max_pd(_mm256_blendv_pd(_mm256_sub_pd(nl, one), nl, even_newer), one);
+            __m256d longitude_base = _mm256_blendv_pd(x_odd, x_even, even_newer);
+            __m256d fixed_lon = _mm256_add_pd(_mm256_mul_pd(positive_mod_pd(m, n_i), scale), longitude_base);
+            __m256d longitude = wrap_pd(_mm256_mul_pd(_mm256_mul_pd(fixed_lon, _mm256_div_pd(c360, n_i)), inv_scale), c180, c360);
+
+            _mm256_storeu_pd(positions.latitude + i, _mm256_and_pd(latitude, ok));
+            _mm256_storeu_pd(positions.longitude + i, _mm256_and_pd(longitude, ok));
+
+            int mask = _mm256_movemask_pd(ok);
+            for (int lane = 0; lane < 4; ++lane) {
+                positions.is_valid[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+            }
+            valid += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+        }
+
+        return valid + global_position_batch_scalar(pairs, positions, i);
+    }
+
+#endif
+
+}
+
+namespace adsb::cpr {
+
+    int NL(double lat) {
+        double abs_lat = std::abs(lat);
+        int bucket = std::min(static_cast<int>(abs_lat * 2.0), NLIndex::BUCKETS - 1);
+        int nl = static_cast<int>(NL_INDEX.base[bucket]);
+        return abs_lat >= NL_INDEX.transition[bucket] ? nl - 1 : nl;
+    }
+
+    types::PositionResult global_position(int even_lat, int even_lon, int odd_lat, int odd_lon,
+                                          bool even_is_newer) {
+        // Latitude index, floor(59 * lat_even - 60 * lat_odd + 1/2) in units of 2^-17
+        int64_t j = floor_div(59 * int64_t{even_lat} - 60 * int64_t{odd_lat} + CPR_SCALE / 2, CPR_SCALE);
+
+        double r_lat_even = to_degrees(positive_mod(j, 60) * CPR_SCALE + even_lat, D_LAT_EVEN);
+        double r_lat_odd  = to_degrees(positive_mod(j, 59) * CPR_SCALE + odd_lat, D_LAT_ODD);
+
+        if (r_lat_even >= 270.0) r_lat_even -= 360.0;
+        if (r_lat_odd  >= 270.0) r_lat_odd  -= 360.0;
+
+        if (r_lat_even < -90.0 || r_lat_even > 90.0 || r_lat_odd < -90.0 || r_lat_odd > 90.0) {
+            ADSB_STATS_COUNT(CPR_OUT_OF_RANGE);
+            return {{0.0, 0.0}, false};
+        }
+
+        // Both frames must lie in the same longitude zone band
+        int nl = NL(r_lat_even);
+        if (nl != NL(r_lat_odd)) {
+            ADSB_STATS_COUNT(CPR_ZONE_MISMATCH);
+            return {{0.0, 0.0}, false};
+        }
+
+        double latitude = even_is_newer ? r_lat_even : r_lat_odd;
+
+        int64_t m = floor_div(int64_t{even_lon} * (nl - 1) - int64_t{odd_lon} * nl + CPR_SCALE / 2, CPR_SCALE);
+        int64_t n_i = std::max(nl - (even_is_newer ? 0 : 1), 1);
+        int64_t longitude_base = even_is_newer ? even_lon : odd_lon;
+
+        double longitude = to_degrees(positive_mod(m, n_i) * CPR_SCALE + longitude_base, 360.0 / static_cast<double>(n_i));
+        if (longitude >= 180.0) longitude -= 360.0;
+
+        ADSB_STATS_COUNT(CPR_PAIR_DECODED);
+        return {{latitude, longitude}, true};
+    }
+
+    types::PositionResult local_position(int cpr_lat, int cpr_lon, bool is_odd,
+                                         const types::GlobalPosition& reference) {
+        double lat_fraction = cpr_lat / CPR_MAX_D;
+        double lon_fraction = cpr_lon / CPR_MAX_D;
+
+        double d_lat = is_odd ? D_LAT_ODD : D_LAT_EVEN;
+        auto j = static_cast<int64_t>(std::floor(reference.latitude / d_lat)
+                                    + std::floor(0.5 + positive_mod(reference.latitude, d_lat) / d_lat - lat_fraction));
+        double latitude = to_degrees(j * CPR_SCALE + cpr_lat, d_lat);
+
+        if (latitude < -90.0 || latitude > 90.0) {
+            return {{0.0, 0.0}, false};
+        }
+
+        double d_lon = 360.0 / std::max(static_cast<double>(NL(latitude) - (is_odd ? 1 : 0)), 1.0);
+        auto m = static_cast<int64_t>(std::floor(reference.longitude / d_lon)
+                                    + std::floor(0.5 + positive_mod(reference.longitude, d_lon) / d_lon - lon_fraction));
+        double longitude = to_degrees(m * CPR_SCALE + cpr_lon, d_lon);
+
+        if (longitude > 180.0) longitude -= 360.0;
+        if (longitude <= -180.0) longitude += 360.0;
+
+        return {{latitude, longitude}, true};
+    }
+
+    EncodedPosition encode(double latitude, double longitude, bool is_odd) {
+        // Zones are counted with multiplications and integer truncation; the
+        // divisions and floor()/fmod() calls of the textbook formula cost
+        // several times more
+        const double d_lat = is_odd ? D_LAT_ODD : D_LAT_EVEN;
+        const double zones_per_degree = is_odd ? 59.0 / 360.0 : 60.0 / 360.0;
+        const double lat_zones = latitude * zones_per_degree;
+        const int64_t lat_zone = floor_to_int(lat_zones);
+        const int64_t yz = floor_to_int(CPR_MAX_D * (lat_zones - static_cast<double>(lat_zone)) + 0.5);
+        // NL of the latitude the decoder will see, not of the exact one
+        const double r_lat = d_lat * (static_cast<double>(lat_zone) + static_cast<double>(yz) / CPR_MAX_D);
+
+        const double nl = std::max(static_cast<double>(NL(r_lat) - (is_odd ? 1 : 0)), 1.0);
+        const double lon_zones = longitude * nl * (1.0 / 360.0);
+        const int64_t xz = floor_to_int(CPR_MAX_D * (lon_zones - static_cast<double>(floor_to_int(lon_zones))) + 0.5);
+
+        return {static_cast<int>(yz & (CPR_SCALE - 1)), static_cast<int>(xz & (CPR_SCALE - 1))};
+    }
+
+    std::size_t global_position_batch(const PairBatch& pairs, const PositionBatch& positions) {
+#ifdef ADSB_CPR_HAVE_AVX2
+        static const bool has_avx2 = __builtin_cpu_supports("avx2");
+        if (has_avx2) return global_position_batch_avx2(pairs, positions);
+#endif
+        return global_position_batch_scalar(pairs, positions, 0);
+    }
+
+    const char* batch_implementation() {
+#ifdef ADSB_CPR_HAVE_AVX2
+        if (__builtin_cpu_supports("avx2")) return "avx2";
+#endif
+        return "scalar";
+    }
+
+}
@@ -0,0 +1,275 @@
+#include "adsb/crc.hpp"
+
+#include "adsb/types.hpp"
+#include "adsb/utils.hpp"
+
+#include <array>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ADSB_CRC_HAVE_PCLMUL 1
+#endif
+
+namespace {
+
+    // CRC checksum polynomial for ADS-B messages
+    constexpr uint32_t ADS_B_CRC_POLY = 0xFFF409;
+
+    constexpr std::size_t LONG_FRAME_BITS = 112;
+
+    /**
+     * @brief Builds the byte-wise CRC lookup table for the ADS-B polynomial.
+     */
+    constexpr std::array<uint32_t, 256> make_crc_table() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            uint32_t crc = byte << 16;
+            for (int j = 0; j < 8; ++j) {
+                crc <<= 1;
+                if (crc & 0x1000000) {
+                    crc ^= ADS_B_CRC_POLY;
+                }
+            }
+            table[byte] = crc & 0xFFFFFF;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint32_t, 256> CRC_TABLE = make_crc_table();
+
+    /**
+     * @class SyndromeTable
+     * @brief Open-addressing hash table mapping error syndromes to bit positions.
+     *
+     * Bit positions are stored as the polynomial power of the flipped bit
+     * (0 = last parity bit), so the same entries serve short and long frames.
+     */
+    class SyndromeTable {
+    public:
+        struct Entry {
+            uint32_t syndrome;  // 0 marks an empty slot
+            uint8_t bit_count;  // 1 or 2, 0 if the syndrome is ambiguous
+            uint8_t power_a;
+            uint8_t power_b;
+        };
+
+        SyndromeTable() : m_entries{} {
+            std::array<uint32_t, LONG_FRAME_BITS> power_syndromes{};
+            uint32_t r = 1;
+            for (std::size_t k = 0; k < LONG_FRAME_BITS; ++k) {
+                power_syndromes[k] = r;
+                r <<= 1;
+                if (r & 0x1000000) {
+                    r = (r ^ ADS_B_CRC_POLY) & 0xFFFFFF;
+                }
+            }
+
+            for (std::size_t k = 0; k < LONG_FRAME_BITS; ++k) {
+                insert(power_syndromes[k], 1, k, k);
+            }
+
+            // Two-bit errors are only considered outside the DF (bits 0-4)
+            // and ICAO (bits 8-31) fields of a long frame, i.e. powers 0-79
+            // (ME and PI fields) and 104-106 (CA field).
+            auto two_bit_candidate = [](std::size_t k) {
+                return k < 80 || (k >= 104 && k <= 106);
+            };
+            for (std::size_t a = 0; a < LONG_FRAME_BITS; ++a) {
+                if (!two_bit_candidate(a)) continue;
+                for (std::size_t b = a + 1; b < LONG_FRAME_BITS; ++b) {
+                    if (!two_bit_candidate(b)) continue;
+                    insert(power_syndromes[a] ^ power_syndromes[b], 2, a, b);
+                }
+            }
+        }
+
+        const Entry* find(uint32_t syndrome) const {
+            for (std::size_t i = slot(syndrome);; i = (i + 1) & MASK) {
+                const Entry& entry = m_entries[i];
+                if (entry.syndrome == syndrome) return &entry;
+                if (entry.syndrome == 0) return nullptr;
+            }
+        }
+
+    private:
+        static constexpr std::size_t SIZE = 8192;
+        static constexpr std::size_t MASK = SIZE - 1;
+
+        static std::size_t slot(uint32_t syndrome) {
+            return static_cast<std::size_t>((syndrome * 2654435761u) >> 19) & MASK;
+        }
+
+        void insert(uint32_t syndrome, uint8_t bit_count, std::size_t power_a, std::size_t power_b) {
+            for (std::size_t i = slot(syndrome);; i = (i + 1) & MASK) {
+                Entry& entry = m_entries[i];
+                if (entry.syndrome == 0) {
+                    entry = {syndrome, bit_count, static_cast<uint8_t>(power_a), static_cast<uint8_t>(power_b)};
+                    return;
+                }
+                if (entry.syndrome == syndrome) {
+                    // Prefer the pattern with fewer errors; equal weight means ambiguity
+                    if (entry.bit_count == bit_count) entry.bit_count = 0;
+                    return;
+                }
+            }
+        }
+
+        std::array<Entry, SIZE> m_entries;
+    };
+
+    const SyndromeTable& syndrome_table() {
+        static const SyndromeTable table;
+        return table;
+    }
+
+    void flip_power(uint8_t* frame, std::size_t length, std::size_t power) {
+        std::size_t bit = length * 8 - 1 - power;
+        frame[bit / 8] ^= static_cast<uint8_t>(0x80 >> (bit % 8));
+    }
+
+    std::size_t check_crc_batch_table(const uint8_t* frames, std::size_t stride, std::size_t length,
+                                      std::size_t count, uint32_t* syndromes) {
+        std::size_t valid = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            syndromes[i] = adsb::crc::syndrome(frames + i * stride, length);
+            valid += syndromes[i] == 0 ? 1 : 0;
+        }
+        return valid;
+    }
+
+#ifdef ADSB_CRC_HAVE_PCLMUL
+
+    // Generator polynomial including its x^24 term
+    constexpr uint64_t GENERATOR = 0x1000000 | ADS_B_CRC_POLY;
+
+    /**
+     * @brief x^power mod G, the folding constant that moves a chunk down by `power` bits.
+     */
+    constexpr uint64_t x_pow_mod(std::size_t power) {
+        uint64_t r = 1;
+        for (std::size_t i = 0; i < power; ++i) {
+            r <<= 1;
+            if (r & 0x1000000) r ^= GENERATOR;
+        }
+        return r;
+    }
+
+    /**
+     * @brief floor(x^64 / G), the Barrett constant for remainders of polynomials below degree 64.
+     */
+    constexpr uint64_t barrett_mu() {
+        unsigned __int128 remainder = static_cast<unsigned __int128>(1) << 64;
+        uint64_t quotient = 0;
+        for (int i = 40; i >= 0; --i) {
+            if ((remainder >> (24 + i)) & 1) {
+                quotient |= uint64_t{1} << i;
+                remainder ^= static_cast<unsigned __int128>(GENERATOR) << i;
+            }
+        }
+        return quotient;
+    }
+
+    constexpr uint64_t FOLD_40 = x_pow_mod(40);
+    constexpr uint64_t FOLD_80 = x_pow_mod(80);
+    constexpr uint64_t BARRETT_MU = barrett_mu();
+
+    __attribute__((target("pclmul")))
+    inline uint64_t clmul(uint64_t a, uint64_t b) {
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(
+            _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(a)),
+                                 _mm_cvtsi64_si128(static_cast<long long>(b)), 0x00)));
+    }
+
+    /**
+     * @brief Remainder of a polynomial of degree below 64 divided by G.
+     */
+    __attribute__((target("pclmul")))
+    inline uint32_t barrett_reduce(uint64_t value) {
+        // The quotient is (value / x^24) * mu / x^40; the product has up to 80 bits
+        __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(value >> 24)),
+                                               _mm_cvtsi64_si128(static_cast<long long>(BARRETT_MU)), 0x00);
+        uint64_t quotient = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_srli_si128(product, 5)));
+        return static_cast<uint32_t>((value ^ clmul(quotient, GENERATOR)) & 0xFFFFFF);
+    }
+
+    __attribute__((target("pclmul")))
+    std::size_t check_crc_batch_pclmul(const uint8_t* frames, std::size_t stride, std::size_t length,
+                                       std::size_t count, uint32_t* syndromes) {
+        std::size_t valid = 0;
+        if (length == adsb::types::LONG_FRAME_BYTES) {
+            // 112 bits = A * x^80 + B * x^40 + C; folding A and B leaves less than 64 bits
+            for (std::size_t i = 0; i < count; ++i) {
+                const uint8_t* frame = frames + i * stride;
+                uint64_t a = adsb::utils::load_be(frame, 4);
+                uint64_t b = adsb::utils::load_be(frame + 4, 5);
+                uint64_t c = adsb::utils::load_be(frame + 9, 5);
+                syndromes[i] = barrett_reduce(clmul(a, FOLD_80) ^ clmul(b, FOLD_40) ^ c);
+                valid += syndromes[i] == 0 ? 1 : 0;
+            }
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                const uint8_t* frame = frames + i * stride;
+                syndromes[i] = barrett_reduce((adsb::utils::load_be(frame, 4) << 24) | adsb::utils::load_be(frame + 4, 3));
+                valid += syndromes[i] == 0 ? 1 : 0;
+            }
+        }
+        return valid;
+    }
+
+#endif
+
+}
+
+namespace adsb::crc {
+
+    uint32_t syndrome(const uint8_t* frame, std::size_t length) {
+        std::size_t data_bytes = length - 3;
+
+        uint32_t crc = 0;
+        for (std::size_t i = 0; i < data_bytes; ++i) {
+            crc = ((crc << 8) ^ CRC_TABLE[(crc >> 16) ^ frame[i]]) & 0xFFFFFF;
+        }
+
+        crc ^= static_cast<uint32_t>(frame[data_bytes]) << 16;
+        crc ^= static_cast<uint32_t>(frame[data_bytes + 1]) << 8;
+        crc ^= static_cast<uint32_t>(frame[data_bytes + 2]);
+
+        return crc;
+    }
+
+    int correct(uint8_t* frame, std::size_t length, uint32_t syndrome, ErrorCorrection mode) {
+        if (mode == ErrorCorrection::NONE || syndrome == 0) return 0;
+
+        const auto* entry = syndrome_table().find(syndrome);
+        if (entry == nullptr || entry->bit_count == 0) return 0;
+
+        const std::size_t frame_bits = length * 8;
+        if (entry->bit_count == 1) {
+            if (entry->power_a >= frame_bits) return 0;
+            flip_power(frame, length, entry->power_a);
+            return 1;
+        }
+
+        if (mode != ErrorCorrection::TWO_BIT || frame_bits != LONG_FRAME_BITS) return 0;
+        flip_power(frame, length, entry->power_a);
+        flip_power(frame, length, entry->power_b);
+        return 2;
+    }
+
+    std::size_t check_crc_batch(const uint8_t* frames, std::size_t stride, std::size_t length,
+                                std::size_t count, uint32_t* syndromes) {
+#ifdef ADSB_CRC_HAVE_PCLMUL
+        static const bool has_pclmul = __builtin_cpu_supports("pclmul");
+        if (has_pclmul) return check_crc_batch_pclmul(frames, stride, length, count, syndromes);
+#endif
+        return check_crc_batch_table(frames, stride, length, count, syndromes);
+    }
+
+    const char* batch_implementation() {
+#ifdef ADSB_CRC_HAVE_PCLMUL
+        if (__builtin_cpu_supports("pclmul")) return "pclmul";
+#endif
+        return "table";
+    }
+
+}
@@ -1,191 +1,438 @@
 #include "adsb/decoder.hpp"
 
 #include "adsb/message/ADSBMessage.hpp"
+#include "adsb/message/AllCallMessage.hpp"
 #include "adsb/message/IdentificationMessage.hpp"
 #include "adsb/message/AirbornePositionMessage.hpp"
+#include "adsb/message/SurveillanceMessage.hpp"
 #include "adsb/message/VelocityMessage.hpp"
+#include "adsb/cpr.hpp"
+#include "adsb/stats.hpp"
+#include "adsb/utils.hpp"
 
 #include <chrono>
-#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
 #include <vector>
 #include <memory>
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 
-namespace {
+namespace adsb::decoder {
+    namespace FieldIndex {
+        constexpr std::size_t ICAO_BYTE    = 1;
+        constexpr std::size_t PAYLOAD_BYTE = 4;
+        constexpr std::size_t PAYLOAD_BYTES = 7;
+    }
 
-    // CRC checksum polynomial for ADS-B messages
-    constexpr uint32_t ADS_B_CRC_POLY = 0xFFF409;
+    namespace {
+        using detail::FrameHeader;
 
-    /**
-     * @brief Calculates the number of longitude zones (NL) for a given latitude.
-     * @param lat The aircraft's latitude in degrees.
-     * @return The number of longitude zones.
-     */
-    int NL(double lat) {
-        if (std::abs(lat) >= 87.0) return 1;
-        if (lat == 0) return 59;
-        double term = 1.0 - std::cos(M_PI / 30.0);
-        double lat_rad = lat * M_PI / 180.0;
-        double bottom = std::cos(lat_rad) * std::cos(lat_rad);
-        double nl_val = 2.0 * M_PI / std::acos(1.0 - (term / bottom));
-        return static_cast<int>(std::floor(nl_val));
+        bool is_long_format(int df) {
+            return df >= 16;
+        }
+
+        bool accepts_address(const DecoderOptions& options, uint32_t icao) {
+            return options.icao_filter == nullptr || options.icao_filter->accepts(icao);
+        }
+
+        /**
+         * @struct HeapFactory
+         * @brief Allocates message objects with `new`.
+         */
+        struct HeapFactory {
+            using Pointer = std::unique_ptr<adsb::message::ADSBMessage>;
+
+            template <typename T, typename... Args>
+            Pointer create(Args&&... args) const {
+                return std::make_unique<T>(std::forward<Args>(args)...);
+            }
+        };
+
+        /**
+         * @struct ResourceFactory
+         * @brief Allocates message objects from a memory resource.
+         */
+        struct ResourceFactory {
+            using Pointer = MessagePtr;
+
+            std::pmr::memory_resource* resource;
+
+            template <typename T, typename... Args>
+            Pointer create(Args&&... args) const {
+                static_assert(alignof(T) <= alignof(std::max_align_t), "MessageDeleter assumes the default alignment");
+                void* memory = resource->allocate(sizeof(T), alignof(std::max_align_t));
+                return Pointer(new (memory) T(std::forward<Args>(args)...), MessageDeleter{resource, sizeof(T)});
+            }
+        };
+
+        template <typename Factory>
+        typename Factory::Pointer create_message(const FrameHeader& header, adsb::types::Timestamp timestamp,
+                                                 const Factory& factory) {
+            const uint32_t icao = header.icao;
+            const int type_code = header.type_code;
+            const uint64_t payload = header.payload;
+
+            if (header.df == 11) {
+                return factory.template create<adsb::message::AllCallMessage>(icao, header.head, header.syndrome, timestamp);
+            }
+            if (header.df != 17) {
+                return factory.template create<adsb::message::SurveillanceMessage>(icao, header.head, payload, timestamp);
+            }
+
+            switch (type_code) {
+                case 1: case 2: case 3: case 4:
+                    return factory.template create<adsb::message::IdentificationMessage>(icao, type_code, payload, timestamp);
+                case 9: case 10: case 11: case 12: case 13: case 14: case 15: case 16: case 17: case 18:
+                    return factory.template create<adsb::message::AirbornePositionMessage>(icao, type_code, payload, timestamp);
+                case 19:
+                    return factory.template create<adsb::message::VelocityMessage>(icao, type_code, payload, timestamp);
+                default:
+                    return nullptr;
+            }
+        }
+
+        template <typename Factory = HeapFactory>
+        typename Factory::Pointer make_message(const FrameHeader& header, adsb::types::Timestamp timestamp,
+                                               const Factory& factory = Factory{}) {
+            typename Factory::Pointer message = create_message(header, timestamp, factory);
+            detail::count_result(header, message != nullptr);
+            return message;
+        }
+
+        /// Decodes the fields of a frame that passed read_header() into `out`.
+        bool decode_header(const FrameHeader& header, message::MessageData& out) {
+            if (header.df == 11) {
+                out = adsb::message::decode_all_call(header.icao, header.head, header.syndrome);
+            } else if (header.df != 17) {
+                out = adsb::message::decode_surveillance(header.icao, header.head, header.payload);
+            } else {
+                switch (header.type_code) {
+                    case 1: case 2: case 3: case 4:
+                        out = adsb::message::decode_identification(header.icao, header.type_code, header.payload);
+                        break;
+                    case 9: case 10: case 11: case 12: case 13: case 14: case 15: case 16: case 17: case 18:
+                        out = adsb::message::decode_airborne_position(header.icao, header.type_code, header.payload);
+                        break;
+                    case 19:
+                        out = adsb::message::decode_velocity(header.icao, header.type_code, header.payload);
+                        break;
+                    default:
+                        out = std::monostate{};
+                        break;
+                }
+            }
+
+            const bool decoded = !std::holds_alternative<std::monostate>(out);
+            detail::count_result(header, decoded);
+            return decoded;
+        }
     }
 
     /**
-     * @brief Performs a CRC check on a 112-bit raw message.
+     * @brief Validates (and if needed repairs) a frame and extracts its header.
+     *
+     * DF11 and DF17 frames carry their address in clear and are checked
+     * against the CRC; they confirm the address in `options.known_aircraft`.
+     * DF4/5/20/21 frames are accepted if the address recovered from their
+     * parity field is in that set.
+     *
+     * The downlink format, type code and address filters of `options` are
+     * applied here, as soon as the respective field is known. With
+     * `options.known_aircraft` set, valid DF11/DF17 frames confirm their
+     * address before the filters reject them, so that a decoder interested
+     * only in surveillance replies still learns the aircraft around it.
+     *
+     * @return true if the frame is a supported, valid message that passes the filters.
      */
-    bool check_crc(const std::vector<int>& message) {
-        if (message.size() != 112) return false;
+    bool detail::read_header(const uint8_t* frame, std::size_t length,
+                             const DecoderOptions& options, CorrectionStats* stats,
+                             FrameHeader& header, const uint32_t* known_syndrome) {
+        ADSB_STATS_COUNT(FRAMES);
+        if (frame == nullptr || (length != adsb::types::LONG_FRAME_BYTES && length != adsb::types::SHORT_FRAME_BYTES)) {
+            ADSB_STATS_COUNT(REJECTED_LENGTH);
+            return false;
+        }
 
-        uint8_t bytes[14] = {0};
-        for (size_t i = 0; i < 112; ++i) {
-            if (message[i] == 1) {
-                bytes[i / 8] |= (1 << (7 - (i % 8)));
-            }
+        const int df = frame[0] >> 3;
+        // DF4/5/11/20/21 frames are never repaired, so their format is final before the CRC. DF11 still has to
+        // confirm its address if surveillance replies are checked against the known aircraft.
+        const bool confirms = options.known_aircraft != nullptr;
+        if (df != 17 && (options.downlink_format_mask & downlink_format_bit(df)) == 0 && !(df == 11 && confirms)) {
+            ADSB_STATS_COUNT(REJECTED_FILTER);
+            return false;
         }
 
-        uint32_t crc = 0;
-        for (int i = 0; i < 11; i++) {
-            crc ^= static_cast<uint32_t>(bytes[i]) << 16;
-            for (int j = 0; j < 8; j++) {
-                crc <<= 1;
-                if (crc & 0x1000000) {
-                    crc ^= ADS_B_CRC_POLY;
+        const uint32_t syndrome = known_syndrome != nullptr ? *known_syndrome : adsb::crc::syndrome(frame, length);
+        const bool long_frame = length == adsb::types::LONG_FRAME_BYTES;
+
+        switch (df) {
+            case 4: case 5: case 20: case 21:
+                // Address/parity: the syndrome is the aircraft address
+                if (is_long_format(df) != long_frame) {
+                    ADSB_STATS_COUNT(REJECTED_FORMAT);
+                    return false;
                 }
+                if (options.known_aircraft == nullptr || !options.known_aircraft->contains(syndrome)) {
+                    ADSB_STATS_COUNT(REJECTED_UNKNOWN_ADDRESS);
+                    return false;
+                }
+                if (!accepts_address(options, syndrome)) {
+                    ADSB_STATS_COUNT(REJECTED_FILTER);
+                    return false;
+                }
+                header.df = df;
+                header.icao = syndrome;
+                header.type_code = 0;
+                header.head = static_cast<uint32_t>(adsb::utils::load_be(frame, 4));
+                header.payload = long_frame
+                    ? adsb::utils::load_be(frame + FieldIndex::PAYLOAD_BYTE, FieldIndex::PAYLOAD_BYTES) : 0;
+                header.syndrome = syndrome;
+                return true;
+            case 11:
+                // The low 7 bits of the syndrome carry the interrogator code
+                if (long_frame) {
+                    ADSB_STATS_COUNT(REJECTED_FORMAT);
+                    return false;
+                }
+                if ((syndrome & ~0x7Fu) != 0) {
+                    ADSB_STATS_COUNT(REJECTED_CRC);
+                    return false;
+                }
+                header.df = df;
+                header.head = static_cast<uint32_t>(adsb::utils::load_be(frame, 4));
+                header.icao = header.head & 0xFFFFFF;
+                if (syndrome == 0 && confirms) options.known_aircraft->insert(header.icao);
+                if ((options.downlink_format_mask & downlink_format_bit(11)) == 0 || !accepts_address(options, header.icao)) {
+                    ADSB_STATS_COUNT(REJECTED_FILTER);
+                    return false;
+                }
+                header.type_code = 0;
+                header.payload = 0;
+                header.syndrome = syndrome;
+                return true;
+            default:
+                break;
+        }
+
+        uint8_t corrected[adsb::types::LONG_FRAME_BYTES];
+        std::copy(frame, frame + length, corrected);
+
+        // Attempt error correction through the syndrome table if the initial CRC fails
+        if (syndrome != 0) {
+            int fixed_bits = adsb::crc::correct(corrected, length, syndrome, options.error_correction);
+            if (fixed_bits == 0) {
+                ADSB_STATS_COUNT(REJECTED_CRC);
+                return false;
+            }
+            if (fixed_bits == 1) ADSB_STATS_COUNT(CORRECTED_ONE_BIT);
+            else ADSB_STATS_COUNT(CORRECTED_TWO_BITS);
+            if (stats != nullptr) {
+                if (fixed_bits == 1) ++stats->single_bit;
+                else ++stats->two_bit;
             }
         }
 
-        crc ^= static_cast<uint32_t>(bytes[11]) << 16;
-        crc ^= static_cast<uint32_t>(bytes[12]) << 8;
-        crc ^= static_cast<uint32_t>(bytes[13]);
+        if ((corrected[0] >> 3) != 17 || !long_frame) {
+            ADSB_STATS_COUNT(REJECTED_FORMAT);
+            return false;
+        }
 
-        return (crc & 0xFFFFFF) == 0;
+        header.df = 17;
+        header.head = static_cast<uint32_t>(adsb::utils::load_be(corrected, 4));
+        header.icao = header.head & 0xFFFFFF;
+        header.type_code = corrected[FieldIndex::PAYLOAD_BYTE] >> 3;
+        // A repaired frame may be noise that happened to land near a valid codeword, so like DF11 only an
+        // intact frame vouches for its address
+        if (syndrome == 0 && confirms) options.known_aircraft->insert(header.icao);
+        if ((options.downlink_format_mask & downlink_format_bit(17)) == 0
+            || (options.type_code_mask & type_code_bit(header.type_code)) == 0 || !accepts_address(options, header.icao)) {
+            ADSB_STATS_COUNT(REJECTED_FILTER);
+            return false;
+        }
+        header.payload = adsb::utils::load_be(corrected + FieldIndex::PAYLOAD_BYTE, FieldIndex::PAYLOAD_BYTES);
+        header.syndrome = 0;
+        return true;
     }
 
-}
+    /**
+     * @brief Counts the outcome of a frame that passed read_header().
+     */
+    void detail::count_result(const FrameHeader& header, bool decoded) {
+#if ADSB_ENABLE_STATS
+        if (decoded) {
+            ADSB_STATS_COUNT(DECODED);
+            ADSB_STATS_COUNT_MESSAGE(header.df, header.type_code);
+        } else {
+            ADSB_STATS_COUNT(REJECTED_TYPE_CODE);
+        }
+#else
+        (void)header;
+        (void)decoded;
+#endif
+    }
 
-namespace adsb::decoder {
-    namespace FieldIndex {
-        constexpr int ICAO_START    = 8;
-        constexpr int ICAO_END      = 31;
-        constexpr int PAYLOAD_START = 32;
-        constexpr int TYPE_CODE_END = 36;
-        constexpr int PAYLOAD_END   = 88;
+    void MessageDeleter::operator()(message::ADSBMessage* message) const {
+        message->~ADSBMessage();
+        resource->deallocate(message, size, alignof(std::max_align_t));
     }
 
-    std::unique_ptr<adsb::message::ADSBMessage> decode(const std::vector<int>& raw_bits) {
-        if (raw_bits.size() != 112) return nullptr;
-
-        std::vector<int> corrected_bits = raw_bits;
-        bool is_valid = check_crc(corrected_bits);
-
-        // Attempt single-bit error correction if initial CRC fails
-        if (!is_valid) {
-            for (int i = 0; i < 112; ++i) {
-                corrected_bits[i] = 1 - corrected_bits[i]; // Flip bit
-                if (check_crc(corrected_bits)) {
-                    is_valid = true;
-                    break;
-                }
-                corrected_bits[i] = raw_bits[i]; // Flip back
+    MessageArena::MessageArena(std::size_t block_bytes) : m_block_bytes(std::max<std::size_t>(block_bytes, 256)) {}
+
+    void MessageArena::reset() {
+        m_block = 0;
+        m_offset = 0;
+        m_allocated = 0;
+    }
+
+    void* MessageArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+        for (;; ++m_block, m_offset = 0) {
+            if (m_block == m_blocks.size()) {
+                // Blocks are kept for later batches; a request larger than a block gets one of its own
+                const std::size_t size = std::max(m_block_bytes, bytes + alignment);
+                m_blocks.push_back({std::make_unique<std::byte[]>(size), size});
+                m_capacity += size;
+            }
+
+            const Block& block = m_blocks[m_block];
+            const auto base = reinterpret_cast<uintptr_t>(block.memory.get());
+            const std::size_t offset = ((base + m_offset + alignment - 1) & ~(uintptr_t{alignment} - 1)) - base;
+            if (offset + bytes <= block.size) {
+                m_offset = offset + bytes;
+                m_allocated += bytes;
+                return block.memory.get() + offset;
             }
         }
+    }
 
-        if (!is_valid) return nullptr;
+    std::unique_ptr<adsb::message::ADSBMessage> decode(const std::vector<int>& raw_bits) {
+        if (raw_bits.size() != adsb::types::LONG_FRAME_BYTES * 8) return nullptr;
 
-        int df = 0;
-        for (int i = 0; i < 5; ++i)
-            df = (df << 1) | corrected_bits[i];
-        if (df != 17) return nullptr;
+        uint8_t frame[adsb::types::LONG_FRAME_BYTES];
+        adsb::utils::pack_bits(raw_bits, frame);
+        return decode(frame, sizeof(frame));
+    }
 
-        unsigned int icao_val = 0;
-        for (int i = FieldIndex::ICAO_START; i <= FieldIndex::ICAO_END; ++i) {
-            icao_val = (icao_val << 1) | corrected_bits[i];
-        }
+    std::unique_ptr<adsb::message::ADSBMessage> decode(std::string_view hex) {
+        uint8_t frame[adsb::types::LONG_FRAME_BYTES];
+        std::size_t length = adsb::utils::hex_to_bytes(hex, frame, sizeof(frame));
+        if (length == 0) return nullptr;
+        return decode(frame, length);
+    }
 
-        std::stringstream icao_ss;
-        icao_ss << std::hex << std::setfill('0') << std::setw(6) << icao_val;
-        std::string icao = icao_ss.str();
+    std::unique_ptr<adsb::message::ADSBMessage> decode(const uint8_t* frame, std::size_t length) {
+        return decode(frame, length, DecoderOptions{});
+    }
 
-        int type_code = 0;
-        for (int i = FieldIndex::PAYLOAD_START; i <= FieldIndex::TYPE_CODE_END; ++i) {
-            type_code = (type_code << 1) | corrected_bits[i];
-        }
+    std::unique_ptr<adsb::message::ADSBMessage> decode(const uint8_t* frame, std::size_t length,
+                                                       const DecoderOptions& options,
+                                                       CorrectionStats* stats) {
+        ADSB_STATS_TIMER(DECODE);
+        FrameHeader header{};
+        if (!detail::read_header(frame, length, options, stats, header)) return nullptr;
+        // Read the clock only for frames that actually produce a message
+        return make_message(header, std::chrono::steady_clock::now());
+    }
 
-        std::vector<int> payload(corrected_bits.cbegin() + FieldIndex::PAYLOAD_START,
-                                 corrected_bits.cbegin() + FieldIndex::PAYLOAD_END);
+    std::unique_ptr<adsb::message::ADSBMessage> decode(const uint8_t* frame, std::size_t length,
+                                                       adsb::types::Timestamp timestamp,
+                                                       const DecoderOptions& options,
+                                                       CorrectionStats* stats) {
+        ADSB_STATS_TIMER(DECODE);
+        FrameHeader header{};
+        if (!detail::read_header(frame, length, options, stats, header)) return nullptr;
+        return make_message(header, timestamp);
+    }
 
-        switch (type_code) {
-            case 1: case 2: case 3: case 4:
-                return std::make_unique<adsb::message::IdentificationMessage>(icao, type_code, payload);
-            case 9: case 10: case 11: case 12: case 13: case 14: case 15: case 16: case 17: case 18:
-                return std::make_unique<adsb::message::AirbornePositionMessage>(icao, type_code, payload);
-            case 19:
-                return std::make_unique<adsb::message::VelocityMessage>(icao, type_code, payload);
-            default:
-                return nullptr;
+    MessagePtr decode(const uint8_t* frame, std::size_t length, adsb::types::Timestamp timestamp,
+                      std::pmr::memory_resource* resource, const DecoderOptions& options, CorrectionStats* stats) {
+        ADSB_STATS_TIMER(DECODE);
+        FrameHeader header{};
+        if (!detail::read_header(frame, length, options, stats, header)) return nullptr;
+        return make_message(header, timestamp, ResourceFactory{resource});
+    }
+
+    MessagePtr decode(const uint8_t* frame, std::size_t length, std::pmr::memory_resource* resource,
+                      const DecoderOptions& options, CorrectionStats* stats) {
+        ADSB_STATS_TIMER(DECODE);
+        FrameHeader header{};
+        if (!detail::read_header(frame, length, options, stats, header)) return nullptr;
+        return make_message(header, std::chrono::steady_clock::now(), ResourceFactory{resource});
+    }
+
+    bool decode_into(const uint8_t* frame, std::size_t length, message::MessageData& out,
+                     const DecoderOptions& options, CorrectionStats* stats) {
+        ADSB_STATS_TIMER(DECODE);
+        FrameHeader header{};
+        if (!detail::read_header(frame, length, options, stats, header)) {
+            out = std::monostate{};
+            return false;
         }
+        return decode_header(header, out);
+    }
+
+    bool decode_into(const uint8_t* frame, std::size_t length, uint32_t syndrome, message::MessageData& out,
+                     const DecoderOptions& options, CorrectionStats* stats) {
+        ADSB_STATS_TIMER(DECODE);
+        FrameHeader header{};
+        if (!detail::read_header(frame, length, options, stats, header, &syndrome)) {
+            out = std::monostate{};
+            return false;
+        }
+        return decode_header(header, out);
+    }
+
+    message::MessageData decode_value(const uint8_t* frame, std::size_t length,
+                                      const DecoderOptions& options, CorrectionStats* stats) {
+        message::MessageData result;
+        decode_into(frame, length, result, options, stats);
+        return result;
     }
 
     adsb::types::PositionResult calculate_global_position(
         const adsb::message::AirbornePositionMessage& msg_a,
         const adsb::message::AirbornePositionMessage& msg_b,
         const adsb::types::GlobalPosition& ref_pos) {
+        return calculate_global_position(msg_a.get_data(), msg_a.get_timestamp(),
+                                         msg_b.get_data(), msg_b.get_timestamp(), ref_pos);
+    }
 
-        if (msg_a.is_odd_frame() == msg_b.is_odd_frame()) {
-            return {{0.0, 0.0}, false};
-        }
-
-        const adsb::message::AirbornePositionMessage& even_msg = msg_a.is_odd_frame() ? msg_b : msg_a;
-        const adsb::message::AirbornePositionMessage& odd_msg = msg_a.is_odd_frame() ? msg_a : msg_b;
-        auto t_even = even_msg.get_timestamp();
-        auto t_odd = odd_msg.get_timestamp();
+    adsb::types::PositionResult calculate_global_position(
+        const adsb::message::AirbornePositionData& frame_a, adsb::types::Timestamp time_a,
+        const adsb::message::AirbornePositionData& frame_b, adsb::types::Timestamp time_b,
+        const adsb::types::GlobalPosition&) {
 
-        auto time_diff = std::chrono::duration_cast<std::chrono::milliseconds>(t_even - t_odd);
-        if (std::abs(time_diff.count()) > 10000) {
+        if (frame_a.is_odd == frame_b.is_odd) {
+            ADSB_STATS_COUNT(CPR_PARITY_MISMATCH);
             return {{0.0, 0.0}, false};
         }
 
-        const double CPR_MAX = 131072.0;
-        double cpr_lat_even = even_msg.get_cpr_latitude_raw() / CPR_MAX;
-        double cpr_lon_even = even_msg.get_cpr_longitude_raw() / CPR_MAX;
-        double cpr_lat_odd = odd_msg.get_cpr_latitude_raw() / CPR_MAX;
-        double cpr_lon_odd = odd_msg.get_cpr_longitude_raw() / CPR_MAX;
-
-        const int NZ = 15;
-        double d_lat_even = 360.0 / (4.0 * NZ);
-        double d_lat_odd  = 360.0 / (4.0 * NZ - 1.0);
+        const adsb::message::AirbornePositionData& even = frame_a.is_odd ? frame_b : frame_a;
+        const adsb::message::AirbornePositionData& odd = frame_a.is_odd ? frame_a : frame_b;
+        auto t_even = frame_a.is_odd ? time_b : time_a;
+        auto t_odd = frame_a.is_odd ? time_a : time_b;
 
-        double j = std::floor(59.0 * cpr_lat_even - 60.0 * cpr_lat_odd + 0.5);
-
-        double r_lat_even = d_lat_even * (std::fmod(j, 60.0) + cpr_lat_even);
-        double r_lat_odd  = d_lat_odd  * (std::fmod(j, 59.0) + cpr_lat_odd);
-
-        if (r_lat_even >= 270.0) r_lat_even -= 360.0;
-        if (r_lat_odd  >= 270.0) r_lat_odd  -= 360.0;
-
-        bool is_even_newer = t_even > t_odd;
-        double latitude = is_even_newer ? r_lat_even : r_lat_odd;
-
-        int nl = NL(latitude);
-        if (nl <= 0) {
+        if (std::chrono::abs(t_even - t_odd) > adsb::cpr::MAX_PAIR_INTERVAL) {
+            ADSB_STATS_COUNT(CPR_PAIR_TOO_OLD);
             return {{0.0, 0.0}, false};
         }
 
-        double m = std::floor(cpr_lon_even * (nl - 1.0) - cpr_lon_odd * nl + 0.5);
-        double nl_mod = std::max(static_cast<double>(nl - (is_even_newer ? 0 : 1)), 1.0);
-        double d_lon = 360.0 / nl_mod;
-
-        double longitude_base = is_even_newer ? cpr_lon_even : cpr_lon_odd;
-        double longitude = d_lon * (std::fmod(m, nl_mod) + longitude_base);
-
-        longitude += d_lon * std::round((ref_pos.longitude - longitude) / d_lon);
+        bool is_even_newer = t_even > t_odd;
+        return adsb::cpr::global_position(even.cpr_lat, even.cpr_lon, odd.cpr_lat, odd.cpr_lon, is_even_newer);
+    }
 
-        if (longitude > 180.0) longitude -= 360.0;
+    adsb::types::PositionResult calculate_local_position(
+        const adsb::message::AirbornePositionMessage& msg,
+        const adsb::types::GlobalPosition& reference) {
+        return calculate_local_position(msg.get_data(), reference);
+    }
 
-        return {{latitude, longitude}, true};
+    adsb::types::PositionResult calculate_local_position(
+        const adsb::message::AirbornePositionData& frame,
+        const adsb::types::GlobalPosition& reference) {
+        return adsb::cpr::local_position(frame.cpr_lat, frame.cpr_lon, frame.is_odd, reference);
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,162 @@
+#include "adsb/dedup.hpp"
+
+#include "adsb/stats.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    // Key layout: hash fragment (bits 25-63), occupied flag (bit 24), generation (bits 0-23)
+    // Receivers layout: receiver mask (bits 24-63), generation (bits 0-23)
+    constexpr uint64_t GENERATION_MASK = 0xFFFFFF;
+    constexpr uint64_t OCCUPIED = uint64_t{1} << 24;
+
+    uint64_t hash_frame(const uint8_t* frame, std::size_t length) {
+        uint64_t hash = length * 0x9E3779B97F4A7C15ULL;
+        for (std::size_t offset = 0; offset < length; offset += 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, frame + offset, std::min<std::size_t>(8, length - offset));
+            hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+            hash ^= hash >> 31;
+        }
+        hash *= 0x94D049BB133111EBULL;
+        return hash ^ (hash >> 29);
+    }
+
+    // The table index comes from the top bits of the hash, the fragment from the bottom ones
+    uint64_t make_key(uint64_t hash, uint32_t generation) {
+        return (hash << 25) | OCCUPIED | generation;
+    }
+
+    /// true if a slot may be taken by a frame of `generation`: empty, or from an older generation.
+    bool is_claimable(uint64_t key, uint32_t generation) {
+        if ((key & OCCUPIED) == 0) return true;
+        // Unsigned difference tolerates wrap-around of the 24-bit generation
+        const uint64_t age = (generation - (key & GENERATION_MASK)) & GENERATION_MASK;
+        return age != 0 && age < (GENERATION_MASK >> 1);
+    }
+
+    uint64_t mask_of(uint64_t receivers, uint32_t generation) {
+        return (receivers & GENERATION_MASK) == generation ? receivers >> 24 : 0;
+    }
+
+    /**
+     * @brief Adds a receiver to a slot's mask.
+     * @return false if the receiver was already in it.
+     */
+    bool add_receiver(std::atomic<uint64_t>& receivers, uint64_t bit, uint32_t generation, uint64_t& mask) {
+        uint64_t current = receivers.load(std::memory_order_relaxed);
+        for (;;) {
+            mask = mask_of(current, generation);
+            if ((mask & bit) != 0) return false;
+            const uint64_t desired = ((mask | bit) << 24) | generation;
+            if (receivers.compare_exchange_weak(current, desired, std::memory_order_relaxed)) {
+                mask |= bit;
+                return true;
+            }
+        }
+    }
+
+}
+
+namespace adsb::dedup {
+
+    DuplicateFilter::DuplicateFilter(const DuplicateFilterOptions& options)
+        : m_groups(1),
+          m_buckets(std::max<std::size_t>(options.buckets, 2)),
+          m_shift(64),
+          m_overflows(0) {
+        const auto window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options.window).count();
+        m_span_ns = std::max<int64_t>(window_ns / static_cast<int64_t>(m_buckets - 1), 1);
+
+        // A generation holds the frames of 1 / (buckets - 1) of the window, at half load
+        const std::size_t per_generation = std::max<std::size_t>(options.capacity / (m_buckets - 1), 1);
+        while (m_groups * SLOTS_PER_GROUP < per_generation * 2) {
+            m_groups <<= 1;
+            --m_shift;
+        }
+        m_groups_storage = std::make_unique<Group[]>(m_groups * m_buckets);
+        for (std::size_t g = 0; g < m_groups * m_buckets; ++g) {
+            for (auto& slot : m_groups_storage[g].slots) {
+                slot.key.store(0, std::memory_order_relaxed);
+                slot.receivers.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    DuplicateFilter::Group& DuplicateFilter::group(std::size_t bucket, uint64_t hash) const {
+        const std::size_t index = m_shift == 64 ? 0 : static_cast<std::size_t>(hash >> m_shift);
+        return m_groups_storage[bucket * m_groups + index];
+    }
+
+    DuplicateFilter::Slot* DuplicateFilter::find(std::size_t bucket, uint64_t hash, uint32_t generation) const {
+        const uint64_t key = make_key(hash, generation);
+        for (auto& slot : group(bucket, hash).slots) {
+            if (slot.key.load(std::memory_order_relaxed) == key) return &slot;
+        }
+        return nullptr;
+    }
+
+    Sighting DuplicateFilter::check(const uint8_t* frame, std::size_t length, types::Timestamp timestamp,
+                                    uint32_t receiver) {
+        const uint64_t hash = hash_frame(frame, length);
+        const uint64_t bit = uint64_t{1} << (receiver % MAX_RECEIVERS);
+        const auto now = static_cast<uint64_t>(std::max<int64_t>(types::to_nanoseconds(timestamp), 0) / m_span_ns);
+        const auto generation = static_cast<uint32_t>(now & GENERATION_MASK);
+        uint64_t mask;
+
+        // Newest generation first, so a repeated transmission is found before the original one
+        for (uint64_t age = 0; age < m_buckets && age <= now; ++age) {
+            const uint64_t past = now - age;
+            const auto past_generation = static_cast<uint32_t>(past & GENERATION_MASK);
+            Slot* slot = find(past % m_buckets, hash, past_generation);
+            if (slot == nullptr) continue;
+            if (add_receiver(slot->receivers, bit, past_generation, mask)) {
+                ADSB_STATS_COUNT(DUPLICATES);
+                return {true, mask};
+            }
+            // Heard by this receiver before: same content, but a new transmission
+            if (age == 0) {
+                slot->receivers.store((bit << 24) | generation, std::memory_order_relaxed);
+                return {false, bit};
+            }
+            break;
+        }
+
+        const uint64_t desired = make_key(hash, generation);
+        for (auto& slot : group(now % m_buckets, hash).slots) {
+            uint64_t key = slot.key.load(std::memory_order_relaxed);
+            for (;;) {
+                if (key == desired) {
+                    // Inserted by another thread since the lookup above
+                    const bool added = add_receiver(slot.receivers, bit, generation, mask);
+                    if (added) ADSB_STATS_COUNT(DUPLICATES);
+                    return {added, mask};
+                }
+                if (!is_claimable(key, generation)) break;
+                if (slot.key.compare_exchange_strong(key, desired, std::memory_order_relaxed)) {
+                    add_receiver(slot.receivers, bit, generation, mask);
+                    return {false, mask};
+                }
+            }
+        }
+
+        // Group full of current frames: pass the frame on rather than risk suppressing a new one
+        m_overflows.fetch_add(1, std::memory_order_relaxed);
+        return {false, bit};
+    }
+
+    uint64_t DuplicateFilter::receivers(const uint8_t* frame, std::size_t length, types::Timestamp timestamp) const {
+        const uint64_t hash = hash_frame(frame, length);
+        const auto now = static_cast<uint64_t>(std::max<int64_t>(types::to_nanoseconds(timestamp), 0) / m_span_ns);
+        for (uint64_t age = 0; age < m_buckets && age <= now; ++age) {
+            const uint64_t past = now - age;
+            const auto past_generation = static_cast<uint32_t>(past & GENERATION_MASK);
+            const Slot* slot = find(past % m_buckets, hash, past_generation);
+            if (slot != nullptr) return mask_of(slot->receivers.load(std::memory_order_relaxed), past_generation);
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,380 @@
+#include "adsb/demod.hpp"
+
+#include "adsb/stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ADSB_DEMOD_HAVE_SSE2 1
+#endif
+
+namespace {
+
+    constexpr unsigned TICKS_PER_CHIP = 6;         // A half-bit chip lasts 0.5 us = 6 ticks of 12 MHz
+    constexpr unsigned PREAMBLE_CHIPS = 16;
+    constexpr unsigned LONG_FRAME_CHIPS = 2 * 112;
+    constexpr unsigned PREAMBLE_PULSES = (1u << 0) | (1u << 2) | (1u << 7) | (1u << 9);    // High chips
+    constexpr unsigned MAX_PHASES = 7;
+    constexpr uint16_t MAX_MAGNITUDE = 32767;      // Keeps magnitudes usable with signed 16-bit SIMD compares
+    constexpr std::size_t BLOCK = 8;               // Preamble positions tested per detect_block() call
+    constexpr std::size_t PADDING = 32;            // Readable slack behind the last magnitude
+
+    /**
+     * @struct PreambleShape
+     * @brief Sample offsets of the four preamble pulses and of the gaps between them.
+     *
+     * Each pulse is read as the larger of two samples so that the test holds
+     * for every sub-sample phase: a frame starting between two samples spreads
+     * every pulse over both. The quiet samples lie inside the gaps for every
+     * phase.
+     */
+    struct PreambleShape {
+        std::array<std::array<uint8_t, 2>, 4> pulses;
+        std::array<uint8_t, 12> quiet;
+        std::size_t quiet_count;
+    };
+
+    constexpr PreambleShape SHAPE_2_0 = {
+        {{{0, 1}, {2, 3}, {7, 8}, {9, 10}}},
+        {4, 5, 6, 11, 12, 13, 14, 15},
+        8
+    };
+
+    constexpr PreambleShape SHAPE_2_4 = {
+        {{{0, 1}, {2, 3}, {8, 9}, {10, 11}}},
+        {5, 6, 7, 13, 14, 15, 16, 17, 18},
+        9
+    };
+
+    const PreambleShape& shape_for(adsb::demod::SampleRate rate) {
+        return rate == adsb::demod::SampleRate::MSPS_2_4 ? SHAPE_2_4 : SHAPE_2_0;
+    }
+
+    /**
+     * @brief Magnitude of every possible 8-bit I/Q pair, indexed by `(i << 8) | q`.
+     */
+    const std::vector<uint16_t>& uc8_magnitudes() {
+        static const std::vector<uint16_t> table = [] {
+            std::vector<uint16_t> magnitudes(65536);
+            const double scale = MAX_MAGNITUDE / (127.5 * std::sqrt(2.0));
+            for (int i = 0; i < 256; ++i) {
+                for (int q = 0; q < 256; ++q) {
+                    double di = i - 127.5;
+                    double dq = q - 127.5;
+                    double magnitude = std::sqrt(di * di + dq * dq) * scale + 0.5;
+                    magnitudes[(i << 8) | q] = static_cast<uint16_t>(std::min(magnitude, double{MAX_MAGNITUDE}));
+                }
+            }
+            return magnitudes;
+        }();
+        return table;
+    }
+
+    uint16_t sc16_magnitude(int16_t i, int16_t q) {
+        const float power = static_cast<float>(i) * i + static_cast<float>(q) * q;
+        const float magnitude = std::sqrt(power) * 0.70710678f;
+        return static_cast<uint16_t>(std::min(magnitude, float{MAX_MAGNITUDE}));
+    }
+
+    int16_t load_le16(const uint8_t* bytes) {
+        return static_cast<int16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    bool is_supported_df(int df) {
+        return df == 11 || df == 17 || df == 18;
+    }
+
+}
+
+namespace adsb::demod {
+
+    Demodulator::Demodulator(const DemodulatorOptions& options)
+        : m_options(options),
+          m_ticks_per_sample(options.sample_rate == SampleRate::MSPS_2_4 ? 5 : 6),
+          m_phases(m_ticks_per_sample + 1),
+          m_window(0),
+          m_size(0),
+          m_buffer_start(0),
+          m_resume(0),
+          m_samples_processed(0),
+          m_partial{},
+          m_partial_size(0) {
+        // Precompute which samples each chip covers, for every slicing phase. The preamble chips come first.
+        m_taps.resize(m_phases * (PREAMBLE_CHIPS + LONG_FRAME_CHIPS));
+        for (unsigned phase = 0; phase < m_phases; ++phase) {
+            for (unsigned chip = 0; chip < PREAMBLE_CHIPS + LONG_FRAME_CHIPS; ++chip) {
+                const unsigned start = phase + TICKS_PER_CHIP * chip;
+                const unsigned sample = start / m_ticks_per_sample;
+                const unsigned first = std::min(m_ticks_per_sample * (sample + 1) - start, TICKS_PER_CHIP);
+                ChipTap& tap = m_taps[phase * (PREAMBLE_CHIPS + LONG_FRAME_CHIPS) + chip];
+                tap.sample = static_cast<uint16_t>(sample);
+                tap.weight[0] = static_cast<uint8_t>(first);
+                tap.weight[1] = static_cast<uint8_t>(TICKS_PER_CHIP - first);
+                const unsigned end = start + TICKS_PER_CHIP;
+                const unsigned last = tap.weight[1] > 0 ? sample + 1 : sample;
+                tap.lead = static_cast<uint8_t>(first * (start - m_ticks_per_sample * sample));
+                tap.trail = static_cast<uint8_t>((tap.weight[1] > 0 ? tap.weight[1] : first)
+                                                 * (m_ticks_per_sample * (last + 1) - end));
+            }
+        }
+
+        static_assert(MAX_PHASES >= 6 + 1, "one phase per tick of a 2.0 Msps sample, plus the next sample");
+        const unsigned last_tick = (m_phases - 1) + TICKS_PER_CHIP * (PREAMBLE_CHIPS + LONG_FRAME_CHIPS);
+        m_window = last_tick / m_ticks_per_sample + 2 + BLOCK;
+        m_magnitude.resize(m_window + PADDING);
+        m_frames.reserve(64);
+    }
+
+    void Demodulator::reset() {
+        m_size = 0;
+        m_buffer_start = m_samples_processed;
+        m_resume = m_samples_processed;
+        m_partial_size = 0;
+        m_frames.clear();
+    }
+
+    void Demodulator::demodulate(const uint8_t* samples, std::size_t bytes) {
+        ADSB_STATS_TIMER(DEMODULATE);
+        m_frames.clear();
+
+        const std::size_t sample_bytes = m_options.format == SampleFormat::UC8 ? 2 : 4;
+        if (m_partial_size > 0) {
+            const std::size_t take = std::min(bytes, sample_bytes - m_partial_size);
+            std::memcpy(m_partial + m_partial_size, samples, take);
+            m_partial_size += take;
+            samples += take;
+            bytes -= take;
+            if (m_partial_size < sample_bytes) return;
+            append_magnitudes(m_partial, 1);
+            m_partial_size = 0;
+        }
+
+        const std::size_t count = bytes / sample_bytes;
+        append_magnitudes(samples, count);
+        m_partial_size = bytes - count * sample_bytes;
+        std::memcpy(m_partial, samples + count * sample_bytes, m_partial_size);
+
+        if (m_size <= m_window) return;
+        const std::size_t end = m_size - m_window;
+
+        for (std::size_t block = 0; block < end; block += BLOCK) {
+            unsigned candidates = detect_block(block);
+            while (candidates != 0) {
+                const std::size_t position = block + static_cast<std::size_t>(__builtin_ctz(candidates));
+                candidates &= candidates - 1;
+                if (position >= end || m_buffer_start + position < m_resume) continue;
+
+                DemodFrame frame;
+                if (try_decode(position, frame)) {
+                    m_frames.push_back(frame);
+                    // Do not look for preambles inside the frame just decoded
+                    const uint64_t frame_ticks = TICKS_PER_CHIP * (PREAMBLE_CHIPS + 16 * frame.length);
+                    m_resume = (frame.mlat_ticks + frame_ticks) / m_ticks_per_sample;
+                }
+            }
+        }
+
+        // Keep the tail: a preamble found in the next block may start there
+        std::memmove(m_magnitude.data(), m_magnitude.data() + end, (m_size - end) * sizeof(uint16_t));
+        m_size -= end;
+        m_buffer_start += end;
+    }
+
+    void Demodulator::append_magnitudes(const uint8_t* samples, std::size_t count) {
+        if (m_magnitude.size() < m_size + count + PADDING) {
+            m_magnitude.resize(m_size + count + PADDING);
+        }
+        uint16_t* out = m_magnitude.data() + m_size;
+
+        if (m_options.format == SampleFormat::UC8) {
+            const uint16_t* table = uc8_magnitudes().data();
+            for (std::size_t k = 0; k < count; ++k) {
+                out[k] = table[(samples[2 * k] << 8) | samples[2 * k + 1]];
+            }
+        } else {
+            std::size_t k = 0;
+#ifdef ADSB_DEMOD_HAVE_SSE2
+            // Four I/Q pairs per iteration: i*i + q*q with one multiply-add, then sqrt in single precision
+            const __m128 scale = _mm_set1_ps(0.70710678f);
+            for (; k + 4 <= count; k += 4) {
+                __m128i iq = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + 4 * k));
+                __m128i power = _mm_madd_epi16(iq, iq);
+                // (-32768)^2 * 2 overflows int32; halve as unsigned and double in float
+                __m128 power_ps = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(power, 1)), _mm_set1_ps(2.0f));
+                __m128i magnitude = _mm_cvttps_epi32(_mm_mul_ps(_mm_sqrt_ps(power_ps), scale));
+                __m128i packed = _mm_packs_epi32(magnitude, magnitude);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + k), packed);
+            }
+#endif
+            for (; k < count; ++k) {
+                out[k] = sc16_magnitude(load_le16(samples + 4 * k), load_le16(samples + 4 * k + 2));
+            }
+        }
+
+        m_size += count;
+        m_samples_processed += count;
+    }
+
+    unsigned Demodulator::detect_block(std::size_t position) const {
+        const PreambleShape& shape = shape_for(m_options.sample_rate);
+        const uint16_t* m = m_magnitude.data() + position;
+
+#ifdef ADSB_DEMOD_HAVE_SSE2
+        auto load = [m](std::size_t offset) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(m + offset));
+        };
+        auto pulse = [&](std::size_t index) {
+            return _mm_max_epi16(load(shape.pulses[index][0]), load(shape.pulses[index][1]));
+        };
+
+        const __m128i high = _mm_avg_epu16(_mm_avg_epu16(pulse(0), pulse(1)), _mm_avg_epu16(pulse(2), pulse(3)));
+        const __m128i threshold = _mm_add_epi16(_mm_srli_epi16(high, 1), _mm_srli_epi16(high, 3));
+
+        // Every quiet sample must stay at or below 5/8 of the mean pulse height
+        __m128i excess = _mm_setzero_si128();
+        for (std::size_t i = 0; i < shape.quiet_count; ++i) {
+            excess = _mm_or_si128(excess, _mm_subs_epu16(load(shape.quiet[i]), threshold));
+        }
+
+        const __m128i quiet = _mm_cmpeq_epi16(excess, _mm_setzero_si128());
+        const __m128i strong = _mm_cmpgt_epi16(high, _mm_set1_epi16(static_cast<int16_t>(m_options.min_signal - 1)));
+        const __m128i match = _mm_and_si128(quiet, strong);
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(match, _mm_setzero_si128())));
+#else
+        unsigned mask = 0;
+        for (std::size_t j = 0; j < BLOCK; ++j) {
+            unsigned sum = 0;
+            for (const auto& pair : shape.pulses) {
+                sum += std::max(m[j + pair[0]], m[j + pair[1]]);
+            }
+            const unsigned high = sum / 4;
+            const unsigned threshold = high / 2 + high / 8;
+
+            bool quiet = true;
+            for (std::size_t i = 0; i < shape.quiet_count; ++i) {
+                quiet = quiet && m[j + shape.quiet[i]] <= threshold;
+            }
+            if (quiet && high >= m_options.min_signal) mask |= 1u << j;
+        }
+        return mask;
+#endif
+    }
+
+    int Demodulator::preamble_score(std::size_t position, unsigned phase) const {
+        const ChipTap* taps = m_taps.data() + phase * (PREAMBLE_CHIPS + LONG_FRAME_CHIPS);
+        const uint16_t* m = m_magnitude.data() + position;
+        int score = 0;
+        for (unsigned chip = 0; chip < PREAMBLE_CHIPS; ++chip) {
+            const ChipTap& tap = taps[chip];
+            const int energy = m[tap.sample] * tap.weight[0] + m[tap.sample + 1] * tap.weight[1];
+            score += (PREAMBLE_PULSES >> chip) & 1 ? energy : -energy;
+        }
+        return score;
+    }
+
+    bool Demodulator::try_decode(std::size_t position, DemodFrame& frame) const {
+        // Try the phases in the order in which they match the preamble, so that the frame is sliced (and
+        // timestamped) at the phase closest to its actual start
+        unsigned order[MAX_PHASES];
+        int score[MAX_PHASES];
+        for (unsigned phase = 0; phase < m_phases; ++phase) {
+            // Insertion sort: there are only a few phases, and std::sort() trips -Warray-bounds in GCC 12
+            score[phase] = preamble_score(position, phase);
+            unsigned i = phase;
+            for (; i > 0 && score[order[i - 1]] < score[phase]; --i) order[i] = order[i - 1];
+            order[i] = phase;
+        }
+
+        // Prefer a phase that yields an intact frame over one that needs repair
+        for (bool feedback : {false, true}) {
+            for (unsigned i = 0; i < m_phases; ++i) {
+                if (slice(position, order[i], crc::ErrorCorrection::NONE, feedback, frame)) return true;
+            }
+        }
+        if (m_options.error_correction == crc::ErrorCorrection::NONE) return false;
+        for (bool feedback : {false, true}) {
+            for (unsigned i = 0; i < m_phases; ++i) {
+                if (slice(position, order[i], m_options.error_correction, feedback, frame)) return true;
+            }
+        }
+        return false;
+    }
+
+    bool Demodulator::slice(std::size_t position, unsigned phase, crc::ErrorCorrection correction, bool feedback,
+                            DemodFrame& frame) const {
+        const ChipTap* preamble = m_taps.data() + phase * (PREAMBLE_CHIPS + LONG_FRAME_CHIPS);
+        const ChipTap* taps = preamble + PREAMBLE_CHIPS;
+        const uint16_t* m = m_magnitude.data() + position;
+
+        auto chip_energy = [m](const ChipTap& tap) {
+            return int64_t{m[tap.sample]} * tap.weight[0] + int64_t{m[tap.sample + 1]} * tap.weight[1];
+        };
+
+        // A chip shares its samples with its neighbours unless the frame starts on a sample boundary; at
+        // 2.0 Msps and half a sample off, the two chips of a bit are only told apart by what leaks in from
+        // the previous bit. That part is known once the previous bit is sliced, and is subtracted in units of
+        // the pulse height measured on the preamble. The next chip is not known yet and counts half.
+        int64_t pulse_energy = 0;
+        int64_t pulse_weight = 0;
+        for (unsigned chip = 0; chip < PREAMBLE_CHIPS; ++chip) {
+            if (((PREAMBLE_PULSES >> chip) & 1) == 0) continue;
+            const ChipTap& tap = preamble[chip];
+            pulse_energy += chip_energy(tap);
+            pulse_weight += tap.weight[0] * tap.weight[0] + tap.weight[1] * tap.weight[1];
+        }
+        bool previous_high = false;     // The last preamble chip is low
+        auto slice_byte = [&](std::size_t index) {
+            unsigned byte = 0;
+            for (std::size_t bit = 0; bit < 8; ++bit) {
+                const ChipTap* chip = taps + 2 * (8 * index + bit);
+                const int64_t leak = feedback ? pulse_energy * (2 * (previous_high ? chip[0].lead : 0) - chip[1].trail) : 0;
+                const bool one = 2 * pulse_weight * (chip_energy(chip[0]) - chip_energy(chip[1])) > leak;
+                byte = (byte << 1) | (one ? 1u : 0u);
+                previous_high = !one;
+            }
+            return static_cast<uint8_t>(byte);
+        };
+
+        frame.data[0] = slice_byte(0);
+        const int df = frame.data[0] >> 3;
+        if (!is_supported_df(df)) return false;
+
+        frame.length = df >= 16 ? types::LONG_FRAME_BYTES : types::SHORT_FRAME_BYTES;
+        for (std::size_t i = 1; i < frame.length; ++i) {
+            frame.data[i] = slice_byte(i);
+        }
+
+        const uint32_t syndrome = crc::syndrome(frame.data, frame.length);
+        frame.corrected_bits = 0;
+        if (df == 11) {
+            // The low 7 bits of a DF11 syndrome carry the interrogator code
+            if ((syndrome & ~0x7Fu) != 0) return false;
+        } else if (syndrome != 0) {
+            frame.corrected_bits = crc::correct(frame.data, frame.length, syndrome, correction);
+            if (frame.corrected_bits == 0 || !is_supported_df(frame.data[0] >> 3)) return false;
+        }
+
+        const PreambleShape& shape = shape_for(m_options.sample_rate);
+        unsigned signal = 0;
+        for (const auto& pair : shape.pulses) {
+            signal += std::max(m[pair[0]], m[pair[1]]);
+        }
+        frame.signal = static_cast<uint16_t>(signal / 4);
+        frame.sample_index = m_buffer_start + position;
+        frame.mlat_ticks = frame.sample_index * m_ticks_per_sample + phase;
+        return true;
+    }
+
+    const char* implementation() {
+#ifdef ADSB_DEMOD_HAVE_SSE2
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+}
@@ -0,0 +1,95 @@
+#include "adsb/encoder.hpp"
+
+#include "adsb/crc.hpp"
+#include "adsb/utils.hpp"
+
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+    constexpr uint8_t DF_ALL_CALL = 11;
+    constexpr uint8_t DF_EXTENDED_SQUITTER = 17;
+
+    void put_header(uint8_t* frame, uint8_t downlink_format, int capability, uint32_t icao) {
+        frame[0] = static_cast<uint8_t>(downlink_format << 3 | (capability & 0x07));
+        frame[1] = static_cast<uint8_t>(icao >> 16);
+        frame[2] = static_cast<uint8_t>(icao >> 8);
+        frame[3] = static_cast<uint8_t>(icao);
+    }
+
+}
+
+namespace adsb::encoder {
+
+    void set_parity(uint8_t* frame, std::size_t length, uint32_t overlay) {
+        uint8_t* parity = frame + length - 3;
+        parity[0] = parity[1] = parity[2] = 0;
+        // With a zero parity field the syndrome is the CRC of the data bits
+        const uint32_t value = crc::syndrome(frame, length) ^ overlay;
+        parity[0] = static_cast<uint8_t>(value >> 16);
+        parity[1] = static_cast<uint8_t>(value >> 8);
+        parity[2] = static_cast<uint8_t>(value);
+    }
+
+    void encode_extended_squitter(uint32_t icao, uint64_t payload, uint8_t* frame, int capability) {
+        put_header(frame, DF_EXTENDED_SQUITTER, capability, icao);
+        for (int i = 0; i < 7; ++i) frame[4 + i] = static_cast<uint8_t>(payload >> (48 - 8 * i));
+        set_parity(frame, types::LONG_FRAME_BYTES);
+    }
+
+    std::size_t encode(const message::MessageData& data, uint8_t* frame) {
+        return std::visit([frame](const auto& message) -> std::size_t {
+            using T = std::decay_t<decltype(message)>;
+            if constexpr (std::is_same_v<T, message::IdentificationData>) {
+                encode_extended_squitter(message.icao, message::encode_identification(message), frame);
+                return types::LONG_FRAME_BYTES;
+            } else if constexpr (std::is_same_v<T, message::AirbornePositionData>) {
+                encode_extended_squitter(message.icao, message::encode_airborne_position(message), frame);
+                return types::LONG_FRAME_BYTES;
+            } else if constexpr (std::is_same_v<T, message::VelocityData>) {
+                encode_extended_squitter(message.icao, message::encode_velocity(message), frame);
+                return types::LONG_FRAME_BYTES;
+            } else if constexpr (std::is_same_v<T, message::AllCallData>) {
+                put_header(frame, DF_ALL_CALL, message.capability, message.icao);
+                set_parity(frame, types::SHORT_FRAME_BYTES, static_cast<uint32_t>(message.interrogator & 0x7F));
+                return types::SHORT_FRAME_BYTES;
+            } else {
+                return 0;
+            }
+        }, data);
+    }
+
+    BitErrorInjector::BitErrorInjector(double bit_error_rate, uint64_t seed)
+        : m_log_keep(bit_error_rate > 0.0 && bit_error_rate < 1.0 ? std::log1p(-bit_error_rate) : 0.0),
+          m_state(seed),
+          m_bits_to_next_error(bit_error_rate >= 1.0 ? 0 : UINT64_MAX) {
+        if (m_log_keep != 0.0) m_bits_to_next_error = next_gap();
+    }
+
+    uint64_t BitErrorInjector::next_gap() {
+        if (m_log_keep == 0.0) return m_bits_to_next_error == UINT64_MAX ? UINT64_MAX : 0;
+        // Uniform in (0, 1], so the logarithm is finite
+        const double u = (static_cast<double>(utils::next_random(m_state) >> 11) + 1.0) * 0x1.0p-53;
+        const double gap = std::floor(std::log(u) / m_log_keep);
+        return gap >= 1e18 ? UINT64_MAX : static_cast<uint64_t>(gap);
+    }
+
+    std::size_t BitErrorInjector::apply_errors(uint8_t* frame, uint64_t bits) {
+        std::size_t flipped = 0;
+        uint64_t bit = m_bits_to_next_error;
+        while (bit < bits) {
+            frame[bit / 8] ^= static_cast<uint8_t>(0x80 >> (bit % 8));
+            ++flipped;
+            const uint64_t gap = next_gap();
+            if (gap == UINT64_MAX) {
+                m_bits_to_next_error = UINT64_MAX;
+                return flipped;
+            }
+            bit += 1 + gap;
+        }
+        m_bits_to_next_error = bit - bits;
+        return flipped;
+    }
+
+}
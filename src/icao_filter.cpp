@@ -0,0 +1,26 @@
+#include "adsb/icao_filter.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace adsb::decoder {
+
+    IcaoFilter::IcaoFilter(Mode mode, std::vector<uint32_t> addresses)
+        : m_mode(mode),
+          m_addresses(std::move(addresses)),
+          m_summary{} {
+        for (auto& icao : m_addresses) icao &= 0xFFFFFF;
+        std::sort(m_addresses.begin(), m_addresses.end());
+        m_addresses.erase(std::unique(m_addresses.begin(), m_addresses.end()), m_addresses.end());
+
+        for (uint32_t icao : m_addresses) {
+            const uint32_t bit = summary_bit(icao);
+            m_summary[bit >> 6] |= uint64_t{1} << (bit & 63);
+        }
+    }
+
+    bool IcaoFilter::contains(uint32_t icao) const {
+        return std::binary_search(m_addresses.begin(), m_addresses.end(), icao & 0xFFFFFF);
+    }
+
+}
@@ -0,0 +1,115 @@
+#include "adsb/icao_set.hpp"
+
+#include <algorithm>
+
+namespace {
+
+    // Slot layout: confirmation time in seconds (bits 32-63), occupied flag (bit 24), address (bits 0-23)
+    uint64_t pack(uint32_t icao, uint32_t seconds) {
+        return (static_cast<uint64_t>(seconds) << 32) | (uint64_t{1} << 24) | (icao & 0xFFFFFF);
+    }
+
+    uint32_t entry_icao(uint64_t entry) {
+        return static_cast<uint32_t>(entry & 0xFFFFFF);
+    }
+
+    uint32_t entry_seconds(uint64_t entry) {
+        return static_cast<uint32_t>(entry >> 32);
+    }
+
+}
+
+namespace adsb::decoder {
+
+    IcaoSet::IcaoSet(std::size_t capacity, std::chrono::seconds ttl)
+        : m_bucket_count(1),
+          m_shift(64),
+          m_ttl(static_cast<uint32_t>(std::clamp<std::chrono::seconds::rep>(ttl.count(), 0, MAX_TTL))),
+          m_now(0),
+          m_cursor(0) {
+        while (m_bucket_count * SLOTS_PER_BUCKET < capacity * 2) {
+            m_bucket_count <<= 1;
+            --m_shift;
+        }
+        m_buckets = std::make_unique<Bucket[]>(m_bucket_count);
+        for (std::size_t b = 0; b < m_bucket_count; ++b) {
+            for (auto& slot : m_buckets[b].slots) slot.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    IcaoSet::Bucket& IcaoSet::bucket_for(uint32_t icao) const {
+        if (m_shift == 64) return m_buckets[0];
+        return m_buckets[static_cast<std::size_t>((icao * 0x9E3779B97F4A7C15ULL) >> m_shift)];
+    }
+
+    bool IcaoSet::is_fresh(uint64_t entry, uint32_t now) const {
+        // Fresh if within the time-to-live in either direction, as threads advance the clock independently. The
+        // unsigned difference also tolerates wrap-around of the 32-bit seconds counter.
+        return (entry & OCCUPIED) != 0 && now - entry_seconds(entry) + m_ttl <= 2 * m_ttl;
+    }
+
+    void IcaoSet::insert(uint32_t icao) {
+        icao &= 0xFFFFFF;
+        const uint32_t now = m_now.load(std::memory_order_relaxed);
+        const uint64_t desired = pack(icao, now);
+        Bucket& bucket = bucket_for(icao);
+
+        for (auto& slot : bucket.slots) {
+            uint64_t entry = slot.load(std::memory_order_relaxed);
+            if ((entry & OCCUPIED) != 0 && entry_icao(entry) == icao) {
+                // Refresh at most once per second to keep the cache line shared between readers
+                if (entry_seconds(entry) != now) slot.compare_exchange_strong(entry, desired, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        // Claim a free or stale slot; if the bucket is full of live entries, replace the oldest
+        std::atomic<uint64_t>* oldest = nullptr;
+        uint64_t oldest_entry = 0;
+        uint32_t oldest_age = 0;
+        for (auto& slot : bucket.slots) {
+            uint64_t entry = slot.load(std::memory_order_relaxed);
+            if (!is_fresh(entry, now)) {
+                if (slot.compare_exchange_strong(entry, desired, std::memory_order_relaxed)) return;
+                continue;
+            }
+            const uint32_t age = now - entry_seconds(entry);
+            if (oldest == nullptr || age > oldest_age) {
+                oldest = &slot;
+                oldest_entry = entry;
+                oldest_age = age;
+            }
+        }
+        if (oldest != nullptr) oldest->compare_exchange_strong(oldest_entry, desired, std::memory_order_relaxed);
+    }
+
+    bool IcaoSet::contains(uint32_t icao) const {
+        icao &= 0xFFFFFF;
+        const uint32_t now = m_now.load(std::memory_order_relaxed);
+        const Bucket& bucket = bucket_for(icao);
+        for (const auto& slot : bucket.slots) {
+            uint64_t entry = slot.load(std::memory_order_relaxed);
+            if (entry_icao(entry) == icao && is_fresh(entry, now)) return true;
+        }
+        return false;
+    }
+
+    void IcaoSet::advance(types::Timestamp now, std::size_t slots) {
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+        const auto current = static_cast<uint32_t>(seconds);
+        if (m_now.load(std::memory_order_relaxed) == current) return;
+        m_now.store(current, std::memory_order_relaxed);
+
+        const std::size_t total = capacity();
+        const std::size_t start = m_cursor.fetch_add(slots, std::memory_order_relaxed);
+        for (std::size_t n = 0; n < std::min(slots, total); ++n) {
+            const std::size_t index = (start + n) % total;
+            auto& slot = m_buckets[index / SLOTS_PER_BUCKET].slots[index % SLOTS_PER_BUCKET];
+            uint64_t entry = slot.load(std::memory_order_relaxed);
+            if ((entry & OCCUPIED) != 0 && !is_fresh(entry, current)) {
+                slot.compare_exchange_strong(entry, 0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+}
@@ -2,19 +2,29 @@
 
 #include <iomanip>
 #include <sstream>
-#include <utility>
+#include <thread>
 
 using namespace adsb::message;
-ADSBMessage::ADSBMessage(std::string icao, int type_code, std::vector<int> payload)
-    : m_payload(std::move(payload)),
-      m_icao(std::move(icao)),
+ADSBMessage::ADSBMessage(uint32_t icao, int type_code, uint64_t payload, types::Timestamp timestamp)
+    : m_payload(payload),
       m_type_code(type_code),
-      m_timestamp(std::chrono::steady_clock::now())
+      m_icao(icao),
+      m_timestamp(timestamp)
 {}
 
+void ADSBMessage::wait_for_fields() const {
+    while (m_fields.load(std::memory_order_acquire) != FIELDS_DECODED) std::this_thread::yield();
+}
+
+std::string ADSBMessage::get_icao() const {
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(6) << m_icao;
+    return ss.str();
+}
+
 std::string ADSBMessage::to_string() const {
     std::stringstream ss;
-    ss << "[ADSB] ICAO: " << m_icao
+    ss << "[ADSB] ICAO: " << get_icao()
        << " | TC: " << std::setw(2) << m_type_code;
     return ss.str();
 }
\ No newline at end of file
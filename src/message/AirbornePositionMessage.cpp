@@ -1,89 +1,160 @@
 #include "adsb/message/AirbornePositionMessage.hpp"
 #include "adsb/utils.hpp"
 
-#include <stdexcept>
 #include <sstream>
 
-using namespace adsb::message;
+namespace {
+    namespace Fields {
+        using TypeCode           = adsb::utils::Field<0, 5>;
+        using SurveillanceStatus = adsb::utils::Field<5, 2>;
+        using NicSupplementB     = adsb::utils::Field<7, 1>;
+        using AltitudeCode       = adsb::utils::Field<8, 12>;
+        using TimeUtcSync        = adsb::utils::Field<20, 1>;
+        using CprFormat          = adsb::utils::Field<21, 1>;
+        using CprLatitude        = adsb::utils::Field<22, 17>;
+        using CprLongitude       = adsb::utils::Field<39, 17>;
+    }
 
-AirbornePositionMessage::AirbornePositionMessage(const std::string& icao, int type_code, const std::vector<int>& payload)
-    : ADSBMessage(icao, type_code, payload) {
-    decode_payload();
-}
+    constexpr std::size_t ALTITUDE_CODES = 4096;
 
-void AirbornePositionMessage::decode_payload() {
-    m_surveillance_status = utils::bits_to_int(m_payload.cbegin() + 5, m_payload.cbegin() + 7);
-    m_nic_supplement_b = m_payload[7];
-    m_altitude = decode_altitude(m_payload.cbegin() + 8, m_payload.cbegin() + 20);
-    m_time_bit = (m_payload[20] == 1);
-    m_is_odd = (m_payload[21] == 1);
-    m_cpr_lat = utils::bits_to_int(m_payload.cbegin() + 22, m_payload.cbegin() + 39);
-    m_cpr_lon = utils::bits_to_int(m_payload.cbegin() + 39, m_payload.cbegin() + 56);
-}
+    // Altitude code bit layout (MSB first): C1 A1 C2 A2 C4 A4 B1 Q B2 D2 B4 D4
+    constexpr int code_bit(int code, int index) {
+        return (code >> (11 - index)) & 1;
+    }
 
-int AirbornePositionMessage::decode_altitude(std::vector<int>::const_iterator begin,
-                                              std::vector<int>::const_iterator end) {
-    if (std::distance(begin, end) != 12) {
-        throw std::invalid_argument("Altitude data must be 12 bits long.");
+    /**
+     * @brief Decodes a Gillham (Mode C) altitude code, in units of 100 ft.
+     * @return false if the code is not a valid Gillham encoding.
+     */
+    constexpr bool decode_gillham(int code, int& hundreds) {
+        const int c1 = code_bit(code, 0), a1 = code_bit(code, 1), c2 = code_bit(code, 2), a2 = code_bit(code, 3);
+        const int c4 = code_bit(code, 4), a4 = code_bit(code, 5), b1 = code_bit(code, 6);
+        const int b2 = code_bit(code, 8), d2 = code_bit(code, 9), b4 = code_bit(code, 10), d4 = code_bit(code, 11);
+
+        // All C bits zero is never a valid altitude
+        if (c1 == 0 && c2 == 0 && c4 == 0) return false;
+
+        // D2 D4 A1 A2 A4 B1 B2 B4 form a reflected Gray code of 500 ft steps
+        const int gray500 = d2 << 7 | d4 << 6 | a1 << 5 | a2 << 4 | a4 << 3 | b1 << 2 | b2 << 1 | b4;
+        int five_hundreds = 0;
+        for (int g = gray500; g != 0; g >>= 1) five_hundreds ^= g;
+
+        // C1 C2 C4 are a Gray code too, but only 1-4 and 7 (meaning 5) occur
+        int one_hundreds = (c1 << 2 | c2 << 1 | c4);
+        one_hundreds ^= one_hundreds >> 1;
+        one_hundreds ^= one_hundreds >> 2;
+        if (one_hundreds == 5 || one_hundreds == 6) return false;
+        if (one_hundreds == 7) one_hundreds = 5;
+        // The 100 ft cycle runs backwards in odd 500 ft bands
+        if (five_hundreds & 1) one_hundreds = 6 - one_hundreds;
+
+        hundreds = five_hundreds * 5 + one_hundreds - 13;
+        return true;
     }
 
-    bool q_bit = (*(begin + 4) == 1);
+    struct AltitudeTable {
+        int feet[ALTITUDE_CODES];
+    };
 
-    if (q_bit) {
-        int n = utils::bits_to_int(begin, begin + 4);
-        for (auto it = begin + 5; it != end; ++it) {
-            n = (n << 1) | *it;
+    constexpr AltitudeTable make_altitude_table() {
+        AltitudeTable table{};
+        for (int code = 0; code < static_cast<int>(ALTITUDE_CODES); ++code) {
+            if (code == 0) {
+                table.feet[code] = adsb::message::INVALID_ALTITUDE;
+            } else if (code_bit(code, 7) == 1) {
+                // Q=1: the remaining 11 bits count 25 ft steps from -1000 ft
+                const int n = ((code >> 1) & 0x7F0) | (code & 0x0F);
+                table.feet[code] = n * 25 - 1000;
+            } else {
+                int hundreds = 0;
+                table.feet[code] = decode_gillham(code, hundreds) ? hundreds * 100 : adsb::message::INVALID_ALTITUDE;
+            }
         }
-        return (n * 25) - 1000;
+        return table;
     }
 
-    std::vector<int> bits(begin, end);
-
-    int C1 = bits[0];
-    int A1 = bits[1];
-    int C2 = bits[2];
-    int A2 = bits[3];
-    int C4 = bits[5];
-    int A4 = bits[6];
-    int B1 = bits[7];
-    int B2 = bits[8];
-    int D2 = bits[9];
-    int B4 = bits[10];
-    int D4 = bits[11];
-
-    auto gray3_to_bin = [](int g2, int g1, int g0) -> int {
-        int b2 = g2;
-        int b1 = b2 ^ g1;
-        int b0 = b1 ^ g0;
-        return b2 * 4 + b1 * 2 + b0;
+    constexpr AltitudeTable ALTITUDES = make_altitude_table();
+
+    // Gillham codes cover -1200 ft to 126700 ft in 100 ft steps
+    constexpr int GILLHAM_MIN_HUNDREDS = -12;
+    constexpr int GILLHAM_MAX_HUNDREDS = 1267;
+    constexpr int Q_BIT_MAX_FEET = 50175;
+
+    struct GillhamTable {
+        int code[GILLHAM_MAX_HUNDREDS - GILLHAM_MIN_HUNDREDS + 1];
     };
 
-    int C = gray3_to_bin(C1, C2, C4); //  500ft
-    int D = gray3_to_bin(0,  D2, D4);
-    int A = gray3_to_bin(A1, A2, A4);
-    int B = gray3_to_bin(B1, B2, B4);
+    /// Inverse of the Q=0 half of ALTITUDES.
+    constexpr GillhamTable make_gillham_table() {
+        GillhamTable table{};
+        for (int code = 1; code < static_cast<int>(ALTITUDE_CODES); ++code) {
+            if (code_bit(code, 7) == 1 || ALTITUDES.feet[code] == adsb::message::INVALID_ALTITUDE) continue;
+            table.code[ALTITUDES.feet[code] / 100 - GILLHAM_MIN_HUNDREDS] = code;
+        }
+        return table;
+    }
 
-    if (C == 0 && A == 0) return 0;
+    constexpr GillhamTable GILLHAM_CODES = make_gillham_table();
+}
 
-    int five_hundred = C * 10 + D;
-    int one_hundred  = A * 5 + B;
+using namespace adsb::message;
 
-    static const int gillham_100ft[] = {-9999, 0, 100, 200, 300, -200, -100, -9999};
+int adsb::message::decode_altitude(int altitude_code) {
+    return ALTITUDES.feet[altitude_code & (ALTITUDE_CODES - 1)];
+}
 
-    if (one_hundred < 1 || one_hundred > 6) return 0;
+int adsb::message::encode_altitude(int feet) {
+    if (feet == INVALID_ALTITUDE || feet < -1000) return 0;
+    if (feet <= Q_BIT_MAX_FEET) {
+        const int n = (feet + 1000 + 12) / 25;
+        return ((n & 0x7F0) << 1) | 0x10 | (n & 0x0F);
+    }
+    const int hundreds = (feet + 50) / 100;
+    return hundreds <= GILLHAM_MAX_HUNDREDS ? GILLHAM_CODES.code[hundreds - GILLHAM_MIN_HUNDREDS] : 0;
+}
+
+AirbornePositionData adsb::message::decode_airborne_position(uint32_t icao, int type_code, uint64_t payload) {
+    AirbornePositionData data{};
+    data.icao = icao;
+    data.type_code = type_code;
+    data.surveillance_status = static_cast<int>(Fields::SurveillanceStatus::get(payload));
+    data.nic_supplement_b = static_cast<int>(Fields::NicSupplementB::get(payload));
+    data.altitude = ALTITUDES.feet[Fields::AltitudeCode::get(payload)];
+    data.time_utc_sync = Fields::TimeUtcSync::get(payload) == 1;
+    data.is_odd = Fields::CprFormat::get(payload) == 1;
+    data.cpr_lat = static_cast<int>(Fields::CprLatitude::get(payload));
+    data.cpr_lon = static_cast<int>(Fields::CprLongitude::get(payload));
+    return data;
+}
+
+uint64_t adsb::message::encode_airborne_position(const AirbornePositionData& data) {
+    return Fields::TypeCode::put(static_cast<uint64_t>(data.type_code))
+         | Fields::SurveillanceStatus::put(static_cast<uint64_t>(data.surveillance_status))
+         | Fields::NicSupplementB::put(static_cast<uint64_t>(data.nic_supplement_b))
+         | Fields::AltitudeCode::put(static_cast<uint64_t>(encode_altitude(data.altitude)))
+         | Fields::TimeUtcSync::put(data.time_utc_sync ? 1 : 0)
+         | Fields::CprFormat::put(data.is_odd ? 1 : 0)
+         | Fields::CprLatitude::put(static_cast<uint64_t>(data.cpr_lat))
+         | Fields::CprLongitude::put(static_cast<uint64_t>(data.cpr_lon));
+}
 
-    int offset_100 = gillham_100ft[one_hundred];
-    int base_500   = (five_hundred * 500) - 1200;
+AirbornePositionMessage::AirbornePositionMessage(uint32_t icao, int type_code, uint64_t payload,
+                                                 types::Timestamp timestamp)
+    : ADSBMessage(icao, type_code, payload, timestamp)
+{}
 
-    return base_500 + offset_100;
+void AirbornePositionMessage::decode_fields() const {
+    m_data = decode_airborne_position(get_icao_address(), m_type_code, m_payload);
 }
 
 std::string AirbornePositionMessage::to_string() const {
+    const AirbornePositionData& data = get_data();
     std::stringstream ss;
-    ss << ADSBMessage::to_string()
-       << " | Alt: " << m_altitude << " ft"
-       << " | Frame: " << (m_is_odd ? "Odd" : "Even")
-       << " | CPR Lat: " << m_cpr_lat
-       << " | CPR Lon: " << m_cpr_lon;
+    ss << ADSBMessage::to_string();
+    if (data.altitude != INVALID_ALTITUDE) ss << " | Alt: " << data.altitude << " ft";
+    else ss << " | Alt: n/a";
+    ss << " | Frame: " << (data.is_odd ? "Odd" : "Even")
+       << " | CPR Lat: " << data.cpr_lat
+       << " | CPR Lon: " << data.cpr_lon;
     return ss.str();
 }
\ No newline at end of file
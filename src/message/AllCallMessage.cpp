@@ -0,0 +1,32 @@
+#include "adsb/message/AllCallMessage.hpp"
+
+#include <sstream>
+
+using namespace adsb::message;
+
+AllCallData adsb::message::decode_all_call(uint32_t icao, uint32_t header, uint32_t syndrome) {
+    AllCallData data{};
+    data.icao = icao;
+    data.capability = static_cast<int>((header >> 24) & 0x7);
+    data.interrogator = static_cast<int>(syndrome & 0x7F);
+    return data;
+}
+
+AllCallMessage::AllCallMessage(uint32_t icao, uint32_t header, uint32_t syndrome, types::Timestamp timestamp)
+    : ADSBMessage(icao, 0, 0, timestamp),
+      m_header(header),
+      m_syndrome(syndrome)
+{}
+
+void AllCallMessage::decode_fields() const {
+    m_data = decode_all_call(get_icao_address(), m_header, m_syndrome);
+}
+
+std::string AllCallMessage::to_string() const {
+    const AllCallData& data = get_data();
+    std::stringstream ss;
+    ss << "[DF11] ICAO: " << get_icao()
+       << " | CA: " << data.capability
+       << " | IC: " << data.interrogator;
+    return ss.str();
+}
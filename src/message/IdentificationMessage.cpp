@@ -1,73 +1,108 @@
 #include "adsb/message/IdentificationMessage.hpp"
-#include <sstream>
+#include "adsb/utils.hpp"
 
-static const std::string FLIGHT_NAME_CHARS = "?ABCDEFGHIJKLMNOPQRSTUVWXYZ????? ???????????????0123456789??????";
+#include <sstream>
+#include <string_view>
 
-using namespace adsb::message;
+namespace {
+    namespace Fields {
+        using TypeCode   = adsb::utils::Field<0, 5>;
+        using Category   = adsb::utils::Field<5, 3>;
+        using FlightName = adsb::utils::Field<8, 48>;
+    }
 
-IdentificationMessage::IdentificationMessage(const std::string& icao, int type_code, const std::vector<int>& payload)
-    : ADSBMessage(icao, type_code, payload) {
-    decode_payload();
-}
+    constexpr std::string_view FLIGHT_NAME_CHARS = "?ABCDEFGHIJKLMNOPQRSTUVWXYZ????? ???????????????0123456789??????";
 
-void IdentificationMessage::decode_payload() {
-    m_category = decode_category(m_payload.cbegin() + 5, m_payload.cbegin() + 8);
-    m_flight_name = decode_flight_name(m_payload.cbegin() + 8, m_payload.cbegin() + 56);
-}
+    constexpr int INVALID_CHAR = -1;
 
-IdentificationMessage::EmitterCategory
-IdentificationMessage::decode_category(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end) {
-    if (std::distance(begin, end) != 3) return EmitterCategory::UNKNOWN;
+    struct CharCodeTable {
+        int8_t code[256];
+    };
 
-    int category_code = 0;
-    for (auto it = begin; it != end; ++it) {
-        category_code = (category_code << 1) | *it;
+    constexpr CharCodeTable make_char_codes() {
+        CharCodeTable table{};
+        for (int i = 0; i < 256; ++i) table.code[i] = INVALID_CHAR;
+        for (std::size_t i = 0; i < FLIGHT_NAME_CHARS.size(); ++i) {
+            const auto c = static_cast<unsigned char>(FLIGHT_NAME_CHARS[i]);
+            if (c != '?') table.code[c] = static_cast<int8_t>(i);
+        }
+        return table;
     }
 
+    constexpr CharCodeTable CHAR_CODES = make_char_codes();
 
-    if (m_type_code == 2) {
-        category_code += 8;
-    }
-    else if (m_type_code == 3) {
-        category_code += 16;
-    }
-    else if (m_type_code == 4) {
-        category_code += 24;
+    adsb::message::EmitterCategory decode_category(int type_code, int category_code) {
+        if (type_code == 2) {
+            category_code += 8;
+        }
+        else if (type_code == 3) {
+            category_code += 16;
+        }
+        else if (type_code == 4) {
+            category_code += 24;
+        }
+        return static_cast<adsb::message::EmitterCategory>(category_code);
     }
-    return static_cast<EmitterCategory>(category_code);
-}
 
-std::string
-IdentificationMessage::decode_flight_name(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end) {
-    if (std::distance(begin, end) != 48) return "N/A";
+}
 
-    std::string flight_name = "";
-    flight_name.reserve(8);
+using namespace adsb::message;
 
+uint8_t adsb::message::decode_flight_name(uint64_t name_bits, char (&out)[8]) {
+    uint8_t length = 0;
     for (int i = 0; i < 8; ++i) {
-        int char_code = 0;
-        for (int j = 0; j < 6; ++j) {
-            char_code = (char_code << 1) | *(begin + (i * 6) + j);
-        }
+        auto char_code = static_cast<std::size_t>((name_bits >> (42 - i * 6)) & 0x3F);
+        out[i] = FLIGHT_NAME_CHARS[char_code];
+        if (out[i] != ' ') length = static_cast<uint8_t>(i + 1);
+    }
+    return length;
+}
 
-        if (char_code < FLIGHT_NAME_CHARS.length()) {
-            flight_name += FLIGHT_NAME_CHARS[char_code];
-        } else {
-            flight_name += '?';
-        }
+uint64_t adsb::message::pack_callsign(std::string_view callsign) {
+    if (callsign.size() > 8) return 0;
+    uint64_t key = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+        int code = i < callsign.size() ? CHAR_CODES.code[static_cast<unsigned char>(callsign[i])] : CHAR_CODES.code[' '];
+        if (code == INVALID_CHAR) return 0;
+        key = (key << 6) | static_cast<uint64_t>(code);
     }
+    return key;
+}
+
+IdentificationData adsb::message::decode_identification(uint32_t icao, int type_code, uint64_t payload) {
+    IdentificationData data{};
+    data.icao = icao;
+    data.type_code = type_code;
+    data.category = decode_category(type_code, static_cast<int>(Fields::Category::get(payload)));
+    data.callsign_key = Fields::FlightName::get(payload);
+    data.callsign_length = decode_flight_name(data.callsign_key, data.callsign);
+    return data;
+}
 
-    size_t last = flight_name.find_last_not_of(' ');
-    if (last == std::string::npos) return "";
-    return flight_name.substr(0, last + 1);
+uint64_t adsb::message::encode_identification(const IdentificationData& data) {
+    // decode_category() adds a multiple of 8 per type code to the category code
+    const auto category_code = static_cast<uint64_t>(data.category) & 0x07;
+    const uint64_t name_bits = data.callsign_key != 0 ? data.callsign_key : pack_callsign(data.flight_name());
+    return Fields::TypeCode::put(static_cast<uint64_t>(data.type_code))
+         | Fields::Category::put(category_code)
+         | Fields::FlightName::put(name_bits);
 }
 
+IdentificationMessage::IdentificationMessage(uint32_t icao, int type_code, uint64_t payload,
+                                             types::Timestamp timestamp)
+    : ADSBMessage(icao, type_code, payload, timestamp)
+{}
+
+void IdentificationMessage::decode_fields() const {
+    m_data = decode_identification(get_icao_address(), m_type_code, m_payload);
+}
 
 std::string IdentificationMessage::to_string() const {
+    const IdentificationData& data = get_data();
     std::stringstream ss;
     ss << ADSBMessage::to_string();
-    ss << " | Flight Name: " << m_flight_name
-       << " | Category: " << ::to_string(m_category);
+    ss << " | Flight Name: " << data.flight_name()
+       << " | Category: " << adsb::message::to_string(data.category);
     return ss.str();
 }
 
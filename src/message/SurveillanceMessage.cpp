@@ -0,0 +1,92 @@
+#include "adsb/message/SurveillanceMessage.hpp"
+#include "adsb/utils.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    namespace FieldIndex {
+        constexpr int CODE_LEN          = 13;   // AC (DF4/20) or ID (DF5/21) field at the end of the header
+        constexpr int AC_M_BIT          = 6;    // Metric flag inside the 13-bit AC field
+    }
+
+    namespace Fields {
+        using Register   = adsb::utils::Field<0, 8>;    // BDS register number of a Comm-B reply
+        using FlightName = adsb::utils::Field<8, 48>;
+    }
+
+    constexpr uint64_t BDS_IDENTIFICATION = 0x20;
+
+    int code_bit(int code, int index) {
+        return (code >> (FieldIndex::CODE_LEN - 1 - index)) & 1;
+    }
+
+    /**
+     * @brief Decodes the 13-bit identity field (C1 A1 C2 A2 C4 A4 X B1 D1 B2 D2 B4 D4).
+     */
+    int decode_squawk(int code) {
+        int a = code_bit(code, 5) * 4 + code_bit(code, 3) * 2 + code_bit(code, 1);
+        int b = code_bit(code, 11) * 4 + code_bit(code, 9) * 2 + code_bit(code, 7);
+        int c = code_bit(code, 4) * 4 + code_bit(code, 2) * 2 + code_bit(code, 0);
+        int d = code_bit(code, 12) * 4 + code_bit(code, 10) * 2 + code_bit(code, 8);
+        return a * 1000 + b * 100 + c * 10 + d;
+    }
+}
+
+using namespace adsb::message;
+
+SurveillanceData adsb::message::decode_surveillance(uint32_t icao, uint32_t header, uint64_t comm_b) {
+    SurveillanceData data{};
+    data.icao = icao;
+    data.downlink_format = static_cast<int>(header >> 27);
+    data.flight_status = static_cast<int>((header >> 24) & 0x7);
+
+    const int code = static_cast<int>(header & 0x1FFF);
+    if (data.downlink_format == 4 || data.downlink_format == 20) {
+        // Metric altitudes are not decoded; without the M bit the field matches the ADS-B altitude code
+        data.altitude = INVALID_ALTITUDE;
+        if (code_bit(code, FieldIndex::AC_M_BIT) == 0) {
+            data.altitude = decode_altitude(((code >> 1) & 0xFC0) | (code & 0x3F));
+        }
+        data.has_altitude = data.altitude != INVALID_ALTITUDE;
+    } else {
+        data.squawk = decode_squawk(code);
+        data.has_squawk = true;
+    }
+
+    if ((data.downlink_format == 20 || data.downlink_format == 21)
+        && Fields::Register::get(comm_b) == BDS_IDENTIFICATION) {
+        data.callsign_key = Fields::FlightName::get(comm_b);
+        data.callsign_length = decode_flight_name(data.callsign_key, data.callsign);
+        // Other registers may start with 0x20 as well; only accept names made of valid characters
+        for (uint8_t i = 0; i < data.callsign_length; ++i) {
+            if (data.callsign[i] == '?') {
+                data.callsign_length = 0;
+                data.callsign_key = 0;
+                break;
+            }
+        }
+    }
+    return data;
+}
+
+SurveillanceMessage::SurveillanceMessage(uint32_t icao, uint32_t header, uint64_t comm_b,
+                                         types::Timestamp timestamp)
+    : ADSBMessage(icao, 0, comm_b, timestamp),
+      m_header(header)
+{}
+
+void SurveillanceMessage::decode_fields() const {
+    m_data = decode_surveillance(get_icao_address(), m_header, m_payload);
+}
+
+std::string SurveillanceMessage::to_string() const {
+    const SurveillanceData& data = get_data();
+    std::stringstream ss;
+    ss << "[DF" << data.downlink_format << "] ICAO: " << get_icao()
+       << " | FS: " << data.flight_status;
+    if (data.has_altitude) ss << " | Alt: " << data.altitude << " ft";
+    if (data.has_squawk) ss << " | Squawk: " << std::setw(4) << std::setfill('0') << data.squawk;
+    if (data.callsign_length > 0) ss << " | Flight Name: " << data.flight_name();
+    return ss.str();
+}
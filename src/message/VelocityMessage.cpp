@@ -1,54 +1,72 @@
 #include "adsb/message/VelocityMessage.hpp"
 #include "adsb/utils.hpp"
 
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 
 
 namespace {
-    namespace FieldIndex {
-        constexpr int SUBTYPE_START    = 5;
-        constexpr int SUBTYPE_END      = 8;
+    namespace Fields {
+        using TypeCode       = adsb::utils::Field<0, 5>;
+        using Subtype        = adsb::utils::Field<5, 3>;
 
-        constexpr int EW_SIGN_BIT      = 13;
-        constexpr int EW_VEL_START     = 14;
-        constexpr int EW_VEL_END       = 24;
+        using EastWestSign   = adsb::utils::Field<13, 1>;
+        using EastWest       = adsb::utils::Field<14, 10>;
 
-        constexpr int NS_SIGN_BIT      = 24;
-        constexpr int NS_VEL_START     = 25;
-        constexpr int NS_VEL_END       = 35;
+        using NorthSouthSign = adsb::utils::Field<24, 1>;
+        using NorthSouth     = adsb::utils::Field<25, 10>;
 
-        constexpr int VR_SIGN_BIT      = 36;
-        constexpr int VR_START         = 37;
-        constexpr int VR_END           = 46;
+        using VerticalSign   = adsb::utils::Field<36, 1>;
+        using VerticalRate   = adsb::utils::Field<37, 9>;
+    }
+
+    constexpr long MAX_VELOCITY_RAW = 1023;
+    constexpr long MAX_VERTICAL_RATE_RAW = 511;
+
+    /// Sign bit and magnitude + 1 of a velocity component, as in subtypes 1 and 3.
+    uint64_t encode_component(double value, long max_raw, uint64_t& sign) {
+        sign = value < 0.0 ? 1 : 0;
+        return static_cast<uint64_t>(std::min(std::lround(std::fabs(value)) + 1, max_raw));
     }
 }
 
 using namespace adsb::message;
 
-VelocityMessage::VelocityMessage(const std::string& icao, int type_code, const std::vector<int>& payload)
-    : ADSBMessage(icao, type_code, payload) {
-    decode_payload();
+uint64_t adsb::message::encode_velocity(const VelocityData& data) {
+    const double heading_rad = data.heading * M_PI / 180.0;
+    uint64_t s_ew = 0;
+    uint64_t s_ns = 0;
+    uint64_t s_vr = 0;
+    const uint64_t v_ew_raw = encode_component(data.speed * std::sin(heading_rad), MAX_VELOCITY_RAW, s_ew);
+    const uint64_t v_ns_raw = encode_component(data.speed * std::cos(heading_rad), MAX_VELOCITY_RAW, s_ns);
+    const uint64_t vr_raw = encode_component(data.vertical_rate / 64.0, MAX_VERTICAL_RATE_RAW, s_vr);
+
+    return Fields::TypeCode::put(static_cast<uint64_t>(data.type_code))
+         | Fields::Subtype::put(1)
+         | Fields::EastWestSign::put(s_ew) | Fields::EastWest::put(v_ew_raw)
+         | Fields::NorthSouthSign::put(s_ns) | Fields::NorthSouth::put(v_ns_raw)
+         | Fields::VerticalSign::put(s_vr) | Fields::VerticalRate::put(vr_raw);
 }
 
-void VelocityMessage::decode_payload() {
-    int subtype = utils::bits_to_int(m_payload.cbegin() + FieldIndex::SUBTYPE_START,
-                                     m_payload.cbegin() + FieldIndex::SUBTYPE_END);
+VelocityData adsb::message::decode_velocity(uint32_t icao, int type_code, uint64_t payload) {
+    VelocityData data{};
+    data.icao = icao;
+    data.type_code = type_code;
+
+    int subtype = static_cast<int>(Fields::Subtype::get(payload));
 
     if (subtype == 1 || subtype == 2) {
 
-        const int s_ew = m_payload[FieldIndex::EW_SIGN_BIT];
-        const int v_ew_raw = utils::bits_to_int(m_payload.cbegin() + FieldIndex::EW_VEL_START,
-                                                m_payload.cbegin() + FieldIndex::EW_VEL_END);
+        const int s_ew = static_cast<int>(Fields::EastWestSign::get(payload));
+        const int v_ew_raw = static_cast<int>(Fields::EastWest::get(payload));
 
-        const int s_ns = m_payload[FieldIndex::NS_SIGN_BIT];
-        const int v_ns_raw = utils::bits_to_int(m_payload.cbegin() + FieldIndex::NS_VEL_START,
-                                                m_payload.cbegin() + FieldIndex::NS_VEL_END);
+        const int s_ns = static_cast<int>(Fields::NorthSouthSign::get(payload));
+        const int v_ns_raw = static_cast<int>(Fields::NorthSouth::get(payload));
 
-        const int s_vr = m_payload[FieldIndex::VR_SIGN_BIT];
-        const int vr_raw = utils::bits_to_int(m_payload.cbegin() + FieldIndex::VR_START,
-                                              m_payload.cbegin() + FieldIndex::VR_END);
+        const int s_vr = static_cast<int>(Fields::VerticalSign::get(payload));
+        const int vr_raw = static_cast<int>(Fields::VerticalRate::get(payload));
 
         double vel_ew = (v_ew_raw == 0) ? 0.0 : (v_ew_raw - 1.0);
         if (s_ew == 1) vel_ew = -vel_ew;
@@ -56,28 +74,39 @@ void VelocityMessage::decode_payload() {
         double vel_ns = (v_ns_raw == 0) ? 0.0 : (v_ns_raw - 1.0);
         if (s_ns == 1) vel_ns = -vel_ns;
 
-        m_vertical_rate = (vr_raw == 0) ? 0 : (vr_raw - 1) * 64;
-        if (s_vr == 1) m_vertical_rate = -m_vertical_rate;
+        data.vertical_rate = (vr_raw == 0) ? 0 : (vr_raw - 1) * 64;
+        if (s_vr == 1) data.vertical_rate = -data.vertical_rate;
 
-        m_speed = std::sqrt(vel_ew * vel_ew + vel_ns * vel_ns);
+        data.speed = std::sqrt(vel_ew * vel_ew + vel_ns * vel_ns);
 
         double heading_rad = std::atan2(vel_ew, vel_ns);
-        m_heading = (heading_rad * 180.0) / M_PI;
-        if (m_heading < 0) {
-            m_heading += 360.0;
+        data.heading = (heading_rad * 180.0) / M_PI;
+        if (data.heading < 0) {
+            data.heading += 360.0;
         }
     } else {
-        m_speed = 0.0;
-        m_heading = 0.0;
-        m_vertical_rate = 0;
+        data.speed = 0.0;
+        data.heading = 0.0;
+        data.vertical_rate = 0;
     }
+    return data;
+}
+
+VelocityMessage::VelocityMessage(uint32_t icao, int type_code, uint64_t payload,
+                                 types::Timestamp timestamp)
+    : ADSBMessage(icao, type_code, payload, timestamp)
+{}
+
+void VelocityMessage::decode_fields() const {
+    m_data = decode_velocity(get_icao_address(), m_type_code, m_payload);
 }
 
 std::string VelocityMessage::to_string() const {
+    const VelocityData& data = get_data();
     std::stringstream ss;
     ss << ADSBMessage::to_string();
-    ss << " | Speed: "   << std::fixed << std::setprecision(1) << m_speed << " kn"
-       << " | Hdg: "     << std::fixed << std::setprecision(1) << m_heading << " deg"
-       << " | VRate: "   << m_vertical_rate << " ft/min";
+    ss << " | Speed: "   << std::fixed << std::setprecision(1) << data.speed << " kn"
+       << " | Hdg: "     << std::fixed << std::setprecision(1) << data.heading << " deg"
+       << " | VRate: "   << data.vertical_rate << " ft/min";
     return ss.str();
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "adsb/pipeline.hpp"
+
+#include "adsb/crc.hpp"
+#include "adsb/utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    // Elements moved per ring access
+    constexpr std::size_t BATCH = 64;
+
+    constexpr std::size_t SPIN_ROUNDS = 64;
+    constexpr std::size_t YIELD_ROUNDS = 256;
+
+    /**
+     * @brief Waits a little longer the longer a thread has found no work.
+     *
+     * Spins first (lowest latency), then yields the core, then sleeps so
+     * that idle workers do not burn a CPU each.
+     */
+    void back_off(std::size_t& idle_rounds) {
+        ++idle_rounds;
+        if (idle_rounds < SPIN_ROUNDS) {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        } else if (idle_rounds < YIELD_ROUNDS) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    /// true for address/parity replies, whose address is XORed into the CRC.
+    bool has_address_parity(const uint8_t* frame) {
+        switch (frame[0] >> 3) {
+            case 0: case 4: case 5: case 16: case 20: case 21:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+}
+
+namespace adsb::pipeline {
+
+    bool Pipeline::Source::push(const uint8_t* frame, std::size_t length, types::Timestamp timestamp) {
+        SourceQueue& queue = *m_pipeline->m_sources[m_index];
+        if (length != types::LONG_FRAME_BYTES && length != types::SHORT_FRAME_BYTES) return false;
+
+        // Frames are queued for the worker owning the address they most likely belong to; a corrupted frame
+        // yields a wrong address, and the decoded message is then routed to the right shard. Address/parity
+        // replies reveal it only through their CRC, which has to be computed here: sent to another worker,
+        // a reply could be decoded before the DF11/DF17 frame that confirms its address. The worker reuses
+        // the syndrome and computes those of all other frames in batches.
+        FrameItem item;
+        uint32_t address;
+        if (has_address_parity(frame)) {
+            item.syndrome = crc::syndrome(frame, length);
+            address = item.syndrome;
+        } else {
+            item.syndrome = 0;
+            address = static_cast<uint32_t>(utils::load_be(frame + 1, 3));
+        }
+        std::copy(frame, frame + length, item.data);
+        item.length = static_cast<uint8_t>(length);
+        item.time_ns = types::to_nanoseconds(timestamp);
+        SpscRing<FrameItem>& ring = *queue.rings[m_pipeline->shard_of(address)];
+
+        if (!ring.try_push(item)) {
+            if (m_pipeline->m_options.overflow == OverflowPolicy::DROP) {
+                queue.dropped.add(1);
+                return false;
+            }
+            std::size_t idle_rounds = 0;
+            while (!ring.try_push(item)) back_off(idle_rounds);
+        }
+        queue.received.add(1);
+        return true;
+    }
+
+    Pipeline::SourceQueue::SourceQueue(std::size_t capacity, std::size_t workers) {
+        for (std::size_t i = 0; i < workers; ++i) {
+            rings.push_back(std::make_unique<SpscRing<FrameItem>>(std::max(capacity / workers, BATCH)));
+        }
+    }
+
+    Pipeline::Worker::Worker(const tracker::TrackerOptions& options, std::size_t index, std::size_t workers,
+                             std::size_t capacity)
+        : tracker(options), inbound(workers) {
+        for (std::size_t sender = 0; sender < workers; ++sender) {
+            if (sender != index) inbound[sender] = std::make_unique<SpscRing<MessageItem>>(capacity);
+        }
+    }
+
+    Pipeline::Pipeline(const PipelineOptions& options) : m_options(options) {
+        std::size_t workers = options.workers;
+        if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+
+        for (std::size_t i = 0; i < std::max<std::size_t>(options.sources, 1); ++i) {
+            m_sources.push_back(std::make_unique<SourceQueue>(options.source_capacity, workers));
+        }
+        for (std::size_t i = 0; i < workers; ++i) {
+            m_workers.push_back(std::make_unique<Worker>(options.tracker, i, workers, options.shard_capacity));
+        }
+
+        // Start last: the threads read the vectors above
+        for (std::size_t i = 0; i < workers; ++i) {
+            m_workers[i]->thread = std::thread(&Pipeline::run, this, i);
+        }
+    }
+
+    Pipeline::~Pipeline() {
+        stop();
+    }
+
+    void Pipeline::stop() {
+        if (m_stopped) return;
+        m_stopped = true;
+        m_stopping.store(true, std::memory_order_release);
+        for (auto& worker : m_workers) worker->thread.join();
+    }
+
+    PipelineStats Pipeline::stats() const {
+        PipelineStats stats;
+        for (const auto& source : m_sources) {
+            stats.received += source->received.value.load(std::memory_order_relaxed);
+            stats.dropped += source->dropped.value.load(std::memory_order_relaxed);
+        }
+        for (const auto& worker : m_workers) {
+            stats.duplicates += worker->duplicates.value.load(std::memory_order_relaxed);
+            stats.decoded += worker->decoded.value.load(std::memory_order_relaxed);
+            stats.updates += worker->updates.value.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void Pipeline::run(std::size_t index) {
+        bool decoding = true;
+        std::size_t idle_rounds = 0;
+
+        for (;;) {
+            std::size_t work = 0;
+            if (decoding) {
+                // Read the flag before draining: frames pushed before stop() are then all visible
+                const bool stopping = m_stopping.load(std::memory_order_acquire);
+                work += decode_sources(index);
+                if (stopping && work == 0) {
+                    decoding = false;
+                    m_decoders_done.fetch_add(1, std::memory_order_release);
+                }
+            }
+            work += drain_inbound(index);
+
+            if (work > 0) {
+                idle_rounds = 0;
+            } else if (!decoding && m_decoders_done.load(std::memory_order_acquire) == m_workers.size()) {
+                // No worker routes anything anymore; whatever is still queued for us is visible now
+                if (drain_inbound(index) == 0) return;
+            } else {
+                back_off(idle_rounds);
+            }
+        }
+    }
+
+    std::size_t Pipeline::decode_sources(std::size_t index) {
+        Worker& worker = *m_workers[index];
+        decoder::IcaoSet* known = m_options.decoder.known_aircraft;
+        FrameItem frames[BATCH];
+        uint32_t syndromes[BATCH];
+        MessageItem item;
+        std::size_t processed = 0;
+
+        for (std::size_t source = 0; source < m_sources.size(); ++source) {
+            const std::size_t count = m_sources[source]->rings[index]->try_pop(frames, BATCH);
+
+            // CRC of the batch in place, one run of frames of equal length at a time. Address/parity replies
+            // bring the syndrome push() computed for them.
+            for (std::size_t begin = 0, end = 0; begin < count; begin = end) {
+                if (has_address_parity(frames[begin].data)) {
+                    syndromes[begin] = frames[begin].syndrome;
+                    end = begin + 1;
+                    continue;
+                }
+                while (end < count && frames[end].length == frames[begin].length
+                       && !has_address_parity(frames[end].data)) {
+                    ++end;
+                }
+                crc::check_crc_batch(frames[begin].data, sizeof(FrameItem), frames[begin].length, end - begin,
+                                     syndromes + begin);
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                FrameItem& frame = frames[i];
+                if (m_options.duplicates != nullptr
+                    && m_options.duplicates->check(frame.data, frame.length, types::from_nanoseconds(frame.time_ns),
+                                                   static_cast<uint32_t>(source)).duplicate) {
+                    worker.duplicates.add(1);
+                    continue;
+                }
+                if (known != nullptr) known->advance(types::from_nanoseconds(frame.time_ns));
+                if (!decoder::decode_into(frame.data, frame.length, syndromes[i], item.data, m_options.decoder)) {
+                    continue;
+                }
+                worker.decoded.add(1);
+                item.time_ns = frame.time_ns;
+                route(index, item);
+            }
+            processed += count;
+        }
+        return processed;
+    }
+
+    void Pipeline::route(std::size_t index, const MessageItem& item) {
+        const std::size_t owner = shard_of(message::icao_of(item.data));
+        if (owner == index) {
+            Worker& worker = *m_workers[index];
+            const tracker::AircraftState* state = worker.tracker.update(item.data, types::from_nanoseconds(item.time_ns));
+            if (state == nullptr) return;
+            worker.updates.add(1);
+            if (m_options.on_update) m_options.on_update(*state);
+            return;
+        }
+
+        // Keep consuming while the owner's ring is full, so two workers waiting for each other both progress
+        SpscRing<MessageItem>& ring = *m_workers[owner]->inbound[index];
+        std::size_t idle_rounds = 0;
+        while (!ring.try_push(item)) {
+            if (drain_inbound(index) == 0) back_off(idle_rounds);
+        }
+    }
+
+    std::size_t Pipeline::drain_inbound(std::size_t index) {
+        Worker& worker = *m_workers[index];
+        MessageItem items[BATCH];
+        std::size_t processed = 0;
+
+        for (std::size_t sender = 0; sender < worker.inbound.size(); ++sender) {
+            if (sender == index) continue;
+            const std::size_t count = worker.inbound[sender]->try_pop(items, BATCH);
+            for (std::size_t i = 0; i < count; ++i) {
+                const tracker::AircraftState* state = worker.tracker.update(items[i].data,
+                                                                            types::from_nanoseconds(items[i].time_ns));
+                if (state == nullptr) continue;
+                worker.updates.add(1);
+                if (m_options.on_update) m_options.on_update(*state);
+            }
+            processed += count;
+        }
+        return processed;
+    }
+
+}
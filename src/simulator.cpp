@@ -0,0 +1,255 @@
+#include "adsb/simulator.hpp"
+
+#include "adsb/cpr.hpp"
+#include "adsb/crc.hpp"
+#include "adsb/message/MessageData.hpp"
+#include "adsb/utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unordered_set>
+
+namespace {
+
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+    constexpr double TICKS_PER_SECOND = static_cast<double>(adsb::types::MLAT_TICKS_PER_SECOND);
+    constexpr double MAX_INTERVAL_SECONDS = 8.0;
+
+    constexpr int TYPE_CODE_IDENTIFICATION = 4;
+    constexpr int TYPE_CODE_POSITION = 11;
+    constexpr int TYPE_CODE_VELOCITY = 19;
+
+    // Frames per check_crc_batch() call
+    constexpr std::size_t PARITY_BATCH = 256;
+
+    double wrap_longitude(double longitude) {
+        if (longitude >= 180.0) return longitude - 360.0;
+        if (longitude < -180.0) return longitude + 360.0;
+        return longitude;
+    }
+
+}
+
+namespace adsb::simulator {
+
+    TrafficSimulator::TrafficSimulator(const SimulatorOptions& options)
+        : m_options(options),
+          m_radius_deg(options.radius_nm / 60.0),
+          m_center_cos(std::cos(options.center.latitude * DEG_TO_RAD)),
+          m_interval_ticks{},
+          m_rng(options.seed),
+          m_wheel(WHEEL_SLOTS),
+          m_syndromes(PARITY_BATCH),
+          m_errors(options.bit_error_rate, options.seed ^ 0x5EED) {
+        const double intervals[KIND_COUNT] = {options.position_interval, options.velocity_interval,
+                                              options.identification_interval};
+        for (std::size_t kind = 0; kind < KIND_COUNT; ++kind) {
+            const double seconds = std::clamp(intervals[kind], 0.05, MAX_INTERVAL_SECONDS);
+            m_interval_ticks[kind] = static_cast<uint64_t>(seconds * TICKS_PER_SECOND);
+        }
+
+        const std::size_t count = std::max<std::size_t>(options.aircraft, 1);
+        m_aircraft.resize(count);
+        m_motion.resize(count);
+
+        std::unordered_set<uint32_t> addresses;
+        for (std::size_t i = 0; i < count; ++i) {
+            uint32_t icao;
+            do {
+                icao = static_cast<uint32_t>(next_random() & 0xFFFFFF);
+            } while (icao == 0 || !addresses.insert(icao).second);
+            m_aircraft[i].icao = icao;
+            spawn(i);
+
+            // Spread the first transmissions over one interval
+            for (uint32_t kind = 0; kind < KIND_COUNT; ++kind) {
+                const auto offset = static_cast<uint64_t>(next_unit() * static_cast<double>(m_interval_ticks[kind]));
+                m_wheel[(offset / SLOT_TICKS) % WHEEL_SLOTS].push_back(static_cast<uint32_t>(i) << 2 | kind);
+            }
+        }
+    }
+
+    uint64_t TrafficSimulator::next_random() {
+        return utils::next_random(m_rng);
+    }
+
+    double TrafficSimulator::next_unit() {
+        return static_cast<double>(next_random() >> 11) * 0x1.0p-53;
+    }
+
+    void TrafficSimulator::spawn(std::size_t index) {
+        SimulatedAircraft& aircraft = m_aircraft[index];
+        Motion& motion = m_motion[index];
+
+        char callsign[9];
+        std::snprintf(callsign, sizeof(callsign), "%c%c%c%u", 'A' + static_cast<int>(next_random() % 26),
+                      'A' + static_cast<int>(next_random() % 26), 'A' + static_cast<int>(next_random() % 26),
+                      static_cast<unsigned>(next_random() % 10000));
+        aircraft.callsign_key = message::pack_callsign(callsign);
+
+        // Uniform over the disk around the center
+        const double distance = m_radius_deg * std::sqrt(next_unit());
+        const double bearing = next_unit() * 2.0 * M_PI;
+        aircraft.latitude = m_options.center.latitude + distance * std::cos(bearing);
+        aircraft.longitude = wrap_longitude(m_options.center.longitude + distance * std::sin(bearing) / m_center_cos);
+        aircraft.altitude = 1000.0 + std::floor(next_unit() * 400.0) * 100.0;
+        aircraft.speed = 140.0 + next_unit() * 340.0;
+
+        // A third each climbs, descends or stays level
+        const double choice = next_unit();
+        motion.target_altitude = aircraft.altitude;
+        int vertical_rate = 0;
+        if (choice < 1.0 / 3.0 && aircraft.altitude < 39000.0) {
+            motion.target_altitude = aircraft.altitude + 1000.0 + std::floor(next_unit() * (40000.0 - aircraft.altitude) / 100.0) * 100.0;
+            vertical_rate = 64 * static_cast<int>(10 + next_unit() * 40);
+        } else if (choice < 2.0 / 3.0 && aircraft.altitude > 3000.0) {
+            motion.target_altitude = 2000.0 + std::floor(next_unit() * (aircraft.altitude - 2000.0) / 100.0) * 100.0;
+            vertical_rate = -64 * static_cast<int>(10 + next_unit() * 40);
+        }
+
+        const message::IdentificationData identification{aircraft.icao, TYPE_CODE_IDENTIFICATION,
+                                                         message::EmitterCategory::LARGE, {}, 0, aircraft.callsign_key};
+        motion.identification_payload = message::encode_identification(identification);
+        motion.updated_ticks = now_ticks();
+        motion.next_odd = (next_random() & 1) != 0;
+        set_track(index, next_unit() * 360.0, vertical_rate);
+    }
+
+    void TrafficSimulator::set_track(std::size_t index, double heading, int vertical_rate) {
+        SimulatedAircraft& aircraft = m_aircraft[index];
+        Motion& motion = m_motion[index];
+
+        aircraft.heading = heading;
+        aircraft.vertical_rate = vertical_rate;
+
+        // One knot is one arc minute of latitude per hour
+        const double degrees_per_tick = aircraft.speed / 60.0 / 3600.0 / TICKS_PER_SECOND;
+        motion.lat_per_tick = degrees_per_tick * std::cos(heading * DEG_TO_RAD);
+        motion.lon_per_tick = degrees_per_tick * std::sin(heading * DEG_TO_RAD)
+                            / std::max(std::cos(aircraft.latitude * DEG_TO_RAD), 0.01);
+        motion.feet_per_tick = vertical_rate / 60.0 / TICKS_PER_SECOND;
+
+        const message::VelocityData velocity{aircraft.icao, TYPE_CODE_VELOCITY, aircraft.speed, heading, vertical_rate};
+        motion.velocity_payload = message::encode_velocity(velocity);
+    }
+
+    void TrafficSimulator::move(std::size_t index, uint64_t ticks) {
+        SimulatedAircraft& aircraft = m_aircraft[index];
+        Motion& motion = m_motion[index];
+
+        const auto elapsed = static_cast<double>(ticks - motion.updated_ticks);
+        motion.updated_ticks = ticks;
+        aircraft.latitude += motion.lat_per_tick * elapsed;
+        aircraft.longitude = wrap_longitude(aircraft.longitude + motion.lon_per_tick * elapsed);
+
+        if (aircraft.vertical_rate != 0) {
+            aircraft.altitude += motion.feet_per_tick * elapsed;
+            const bool reached = aircraft.vertical_rate > 0 ? aircraft.altitude >= motion.target_altitude
+                                                            : aircraft.altitude <= motion.target_altitude;
+            if (reached) {
+                aircraft.altitude = motion.target_altitude;
+                set_track(index, aircraft.heading, 0);
+            }
+        }
+
+        // Turn back towards the center, give or take 30 degrees, when leaving the area
+        const double d_lat = aircraft.latitude - m_options.center.latitude;
+        const double d_lon = (aircraft.longitude - m_options.center.longitude) * m_center_cos;
+        if (d_lat * d_lat + d_lon * d_lon > m_radius_deg * m_radius_deg) {
+            const double inbound = std::atan2(-d_lon, -d_lat) / DEG_TO_RAD;
+            set_track(index, std::fmod(inbound + 360.0 + (next_unit() - 0.5) * 60.0, 360.0), aircraft.vertical_rate);
+        }
+    }
+
+    uint64_t TrafficSimulator::position_payload(std::size_t index) {
+        const SimulatedAircraft& aircraft = m_aircraft[index];
+        Motion& motion = m_motion[index];
+
+        const bool odd = motion.next_odd;
+        motion.next_odd = !odd;
+        const cpr::EncodedPosition cpr = cpr::encode(aircraft.latitude, aircraft.longitude, odd);
+
+        message::AirbornePositionData position{};
+        position.type_code = TYPE_CODE_POSITION;
+        position.altitude = static_cast<int>(std::lround(aircraft.altitude));
+        position.is_odd = odd;
+        position.cpr_lat = cpr.cpr_lat;
+        position.cpr_lon = cpr.cpr_lon;
+        return message::encode_airborne_position(position);
+    }
+
+    void TrafficSimulator::schedule(uint32_t event, uint64_t ticks) {
+        // Uniform within +-20% of the mean interval, and never in the current slot
+        const uint64_t interval = m_interval_ticks[event & 3];
+        const auto jittered = static_cast<uint64_t>(static_cast<double>(interval) * (0.8 + 0.4 * next_unit()));
+        const uint64_t slot = std::max((ticks + jittered) / SLOT_TICKS, m_slot + 1);
+        m_wheel[slot % WHEEL_SLOTS].push_back(event);
+    }
+
+    std::size_t TrafficSimulator::generate(Frame* frames, std::size_t count) {
+        std::size_t produced = 0;
+        while (produced < count) {
+            std::vector<uint32_t>& slot = m_wheel[m_slot % WHEEL_SLOTS];
+            if (m_cursor == slot.size()) {
+                slot.clear();
+                m_cursor = 0;
+                ++m_slot;
+                continue;
+            }
+
+            // Events of a slot are spread evenly over its 10 ms
+            const uint64_t ticks = m_slot * SLOT_TICKS + m_cursor * SLOT_TICKS / slot.size();
+            const uint32_t event = slot[m_cursor++];
+            const std::size_t index = event >> 2;
+
+            uint64_t payload;
+            switch (event & 3) {
+                case POSITION:
+                    move(index, ticks);
+                    payload = position_payload(index);
+                    break;
+                case VELOCITY:
+                    payload = m_motion[index].velocity_payload;
+                    break;
+                default:
+                    payload = m_motion[index].identification_payload;
+                    break;
+            }
+            schedule(event, ticks);
+
+            Frame& frame = frames[produced++];
+            const uint32_t icao = m_aircraft[index].icao;
+            frame.data[0] = static_cast<uint8_t>(17 << 3 | encoder::CAPABILITY_AIRBORNE);
+            frame.data[1] = static_cast<uint8_t>(icao >> 16);
+            frame.data[2] = static_cast<uint8_t>(icao >> 8);
+            frame.data[3] = static_cast<uint8_t>(icao);
+            for (int i = 0; i < 7; ++i) frame.data[4 + i] = static_cast<uint8_t>(payload >> (48 - 8 * i));
+            frame.data[11] = frame.data[12] = frame.data[13] = 0;
+            frame.length = types::LONG_FRAME_BYTES;
+            frame.mlat_ticks = ticks;
+        }
+
+        // With zero parity fields the syndromes are the parities
+        std::size_t flipped = 0;
+        for (std::size_t first = 0; first < count; first += PARITY_BATCH) {
+            const std::size_t batch = std::min(PARITY_BATCH, count - first);
+            crc::check_crc_batch(frames[first].data, sizeof(Frame), types::LONG_FRAME_BYTES, batch, m_syndromes.data());
+            for (std::size_t i = 0; i < batch; ++i) {
+                Frame& frame = frames[first + i];
+                frame.data[11] = static_cast<uint8_t>(m_syndromes[i] >> 16);
+                frame.data[12] = static_cast<uint8_t>(m_syndromes[i] >> 8);
+                frame.data[13] = static_cast<uint8_t>(m_syndromes[i]);
+                flipped += m_errors.apply(frame.data, frame.length);
+            }
+        }
+        return flipped;
+    }
+
+    std::vector<Frame> TrafficSimulator::generate(std::size_t count) {
+        std::vector<Frame> frames(count);
+        generate(frames.data(), count);
+        return frames;
+    }
+
+}
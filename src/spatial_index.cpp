@@ -0,0 +1,303 @@
+#include "adsb/spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    constexpr double EARTH_RADIUS_NM = 3440.065;
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+
+    double wrap_longitude(double longitude) {
+        if (longitude >= 180.0) return longitude - 360.0;
+        if (longitude < -180.0) return longitude + 360.0;
+        return longitude;
+    }
+
+    uint32_t clamp_index(double value, uint32_t count) {
+        if (!(value > 0.0)) return 0;
+        return static_cast<uint32_t>(std::min(value, static_cast<double>(count - 1)));
+    }
+
+    /**
+     * @brief Haversine term of the distance between two positions; grows monotonically with the distance.
+     */
+    double haversine(double lat_a, double lon_a, double cos_lat_a, double lat_b, double lon_b) {
+        const double s_lat = std::sin((lat_b - lat_a) * DEG_TO_RAD / 2);
+        const double s_lon = std::sin((lon_b - lon_a) * DEG_TO_RAD / 2);
+        return s_lat * s_lat + cos_lat_a * std::cos(lat_b * DEG_TO_RAD) * s_lon * s_lon;
+    }
+
+    constexpr unsigned RADIX_BITS = 11;
+
+    /**
+     * @brief Stable LSD radix sort of (cell << 32 | entry) keys by their cell.
+     *
+     * Linear in the number of keys, unlike a comparison sort, which matters
+     * because every publish sorts all indexed aircraft.
+     */
+    void sort_by_cell(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch, unsigned cell_bits) {
+        constexpr std::size_t BINS = std::size_t{1} << RADIX_BITS;
+        scratch.resize(keys.size());
+        for (unsigned shift = 32; shift < 32 + cell_bits; shift += RADIX_BITS) {
+            uint32_t offsets[BINS] = {};
+            for (uint64_t key : keys) ++offsets[(key >> shift) & (BINS - 1)];
+            uint32_t total = 0;
+            for (auto& offset : offsets) {
+                const uint32_t count = offset;
+                offset = total;
+                total += count;
+            }
+            for (uint64_t key : keys) scratch[offsets[(key >> shift) & (BINS - 1)]++] = key;
+            keys.swap(scratch);
+        }
+    }
+
+    std::size_t table_size_for(std::size_t capacity) {
+        std::size_t size = 16;
+        while (size < capacity * 2) size <<= 1;
+        return size;
+    }
+
+}
+
+namespace adsb::tracker {
+
+    template <typename Fn>
+    void SpatialSnapshot::for_each_candidate(double south, double west, double north, double east, Fn&& fn) const {
+        const uint32_t first_row = clamp_index(std::floor((south + 90.0) / m_cell_degrees), m_rows);
+        const uint32_t last_row = clamp_index(std::floor((north + 90.0) / m_cell_degrees), m_rows);
+
+        // One column run, or two when the box wraps across the antimeridian
+        uint32_t runs[2][2];
+        std::size_t run_count = 1;
+        const uint32_t west_column = clamp_index(std::floor((west + 180.0) / m_cell_degrees), m_columns);
+        const uint32_t east_column = clamp_index(std::floor((east + 180.0) / m_cell_degrees), m_columns);
+        if (west <= east) {
+            runs[0][0] = west_column;
+            runs[0][1] = east_column;
+        } else if (east_column >= west_column) {
+            // Wraps around almost the whole globe: both runs would overlap
+            runs[0][0] = 0;
+            runs[0][1] = m_columns - 1;
+        } else {
+            runs[0][0] = west_column;
+            runs[0][1] = m_columns - 1;
+            runs[1][0] = 0;
+            runs[1][1] = east_column;
+            run_count = 2;
+        }
+
+        for (uint32_t row = first_row; row <= last_row; ++row) {
+            for (std::size_t run = 0; run < run_count; ++run) {
+                const uint32_t first_cell = row * m_columns + runs[run][0];
+                const uint32_t last_cell = row * m_columns + runs[run][1];
+                auto begin = std::lower_bound(m_cells.begin(), m_cells.end(), first_cell);
+                auto end = std::upper_bound(begin, m_cells.end(), last_cell);
+                for (auto it = begin; it != end; ++it) fn(m_aircraft[static_cast<std::size_t>(it - m_cells.begin())]);
+            }
+        }
+    }
+
+    std::size_t SpatialSnapshot::within_box(double south, double west, double north, double east,
+                                            std::vector<IndexedAircraft>& out) const {
+        out.clear();
+        south = std::max(south, -90.0);
+        north = std::min(north, 90.0);
+        if (m_aircraft.empty() || south > north) return 0;
+        // 180 stays 180 so that [-180, 180] covers every longitude
+        if (west != 180.0) west = wrap_longitude(west);
+        if (east != 180.0) east = wrap_longitude(east);
+
+        for_each_candidate(south, west, north, east, [&](const IndexedAircraft& aircraft) {
+            const double latitude = aircraft.position.latitude;
+            const double longitude = aircraft.position.longitude;
+            const bool inside_longitude = west <= east ? longitude >= west && longitude <= east
+                                                       : longitude >= west || longitude <= east;
+            if (inside_longitude && latitude >= south && latitude <= north) out.push_back(aircraft);
+        });
+        return out.size();
+    }
+
+    std::size_t SpatialSnapshot::within_radius(const types::GlobalPosition& center, double radius_nm,
+                                               std::vector<IndexedAircraft>& out) const {
+        out.clear();
+        if (m_aircraft.empty() || radius_nm < 0.0) return 0;
+
+        const double radius = radius_nm / EARTH_RADIUS_NM;
+        const double radius_degrees = radius / DEG_TO_RAD;
+        const double south = center.latitude - radius_degrees;
+        const double north = center.latitude + radius_degrees;
+
+        // Longitude extent of the circle; it spans all longitudes if it contains a pole
+        double west = -180.0;
+        double east = 180.0;
+        if (south > -90.0 && north < 90.0) {
+            const double half_width = std::asin(std::sin(radius) / std::cos(center.latitude * DEG_TO_RAD)) / DEG_TO_RAD;
+            if (half_width < 180.0) {
+                west = wrap_longitude(center.longitude - half_width);
+                east = wrap_longitude(center.longitude + half_width);
+            }
+        }
+
+        const double cos_latitude = std::cos(center.latitude * DEG_TO_RAD);
+        const double half_sine = std::sin(std::min(radius, M_PI) / 2);
+        const double limit = half_sine * half_sine;
+        for_each_candidate(south, west, north, east, [&](const IndexedAircraft& aircraft) {
+            if (haversine(center.latitude, center.longitude, cos_latitude, aircraft.position.latitude,
+                          aircraft.position.longitude) <= limit) {
+                out.push_back(aircraft);
+            }
+        });
+        return out.size();
+    }
+
+    std::size_t SpatialSnapshot::nearest(const types::GlobalPosition& center, std::size_t k,
+                                         std::vector<IndexedAircraft>& out) const {
+        out.clear();
+        if (k == 0 || m_aircraft.empty()) return 0;
+
+        // Start with a circle that should hold about k aircraft at the density of the center's cell
+        const uint32_t row = clamp_index(std::floor((center.latitude + 90.0) / m_cell_degrees), m_rows);
+        const uint32_t column = clamp_index(std::floor((wrap_longitude(center.longitude) + 180.0) / m_cell_degrees),
+                                            m_columns);
+        const auto cell = std::equal_range(m_cells.begin(), m_cells.end(), row * m_columns + column);
+        const auto in_cell = static_cast<double>(cell.second - cell.first);
+        const double cell_nm = m_cell_degrees * 60.0;
+        double radius_nm = cell_nm;
+        if (in_cell > 0.0) {
+            const double cell_area = cell_nm * cell_nm * std::max(std::cos(center.latitude * DEG_TO_RAD), 0.01);
+            radius_nm = std::min(cell_nm, std::sqrt(static_cast<double>(k) * cell_area / (M_PI * in_cell)));
+        }
+
+        // Widen the circle until it holds k aircraft: the k closest of those are the k closest overall
+        const double half_circumference = M_PI * EARTH_RADIUS_NM;
+        while (within_radius(center, radius_nm, out) < k && radius_nm < half_circumference) radius_nm *= 2.0;
+
+        const double cos_latitude = std::cos(center.latitude * DEG_TO_RAD);
+        const auto closer = [&](const IndexedAircraft& a, const IndexedAircraft& b) {
+            return haversine(center.latitude, center.longitude, cos_latitude, a.position.latitude, a.position.longitude)
+                 < haversine(center.latitude, center.longitude, cos_latitude, b.position.latitude, b.position.longitude);
+        };
+        k = std::min(k, out.size());
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(k), out.end(), closer);
+        out.resize(k);
+        return k;
+    }
+
+    SpatialIndex::SpatialIndex(const SpatialIndexOptions& options)
+        : m_options(options),
+          m_slots(table_size_for(std::max<std::size_t>(options.capacity, 1)), EMPTY),
+          m_mask(m_slots.size() - 1),
+          m_shift(64),
+          m_current(std::make_shared<SpatialSnapshot>()) {
+        m_options.cell_degrees = std::clamp(options.cell_degrees, 0.01, 90.0);
+        m_rows = static_cast<uint32_t>(std::ceil(180.0 / m_options.cell_degrees));
+        m_columns = static_cast<uint32_t>(std::ceil(360.0 / m_options.cell_degrees));
+        for (std::size_t size = m_slots.size(); size > 1; size >>= 1) --m_shift;
+        while ((uint64_t{1} << m_cell_bits) < uint64_t{m_rows} * m_columns) ++m_cell_bits;
+        m_entries.reserve(m_options.capacity);
+
+        m_current->m_cell_degrees = m_options.cell_degrees;
+        m_current->m_rows = m_rows;
+        m_current->m_columns = m_columns;
+    }
+
+    uint32_t SpatialIndex::cell_of(const types::GlobalPosition& position) const {
+        const uint32_t row = clamp_index(std::floor((position.latitude + 90.0) / m_options.cell_degrees), m_rows);
+        const uint32_t column = clamp_index(std::floor((wrap_longitude(position.longitude) + 180.0) / m_options.cell_degrees),
+                                            m_columns);
+        return row * m_columns + column;
+    }
+
+    std::size_t SpatialIndex::home_slot(uint32_t icao) const {
+        return static_cast<std::size_t>((icao * 0x9E3779B97F4A7C15ULL) >> m_shift);
+    }
+
+    std::size_t SpatialIndex::find_slot(uint32_t icao) const {
+        for (std::size_t i = home_slot(icao);; i = (i + 1) & m_mask) {
+            if (m_slots[i] == EMPTY) return m_slots.size();
+            if (m_entries[m_slots[i]].aircraft.icao == icao) return i;
+        }
+    }
+
+    bool SpatialIndex::update(uint32_t icao, const types::GlobalPosition& position, types::Timestamp timestamp) {
+        std::size_t i = home_slot(icao);
+        for (; m_slots[i] != EMPTY; i = (i + 1) & m_mask) {
+            if (m_entries[m_slots[i]].aircraft.icao == icao) break;
+        }
+        if (m_slots[i] == EMPTY) {
+            if (m_entries.size() >= m_options.capacity) return false;
+            m_slots[i] = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+
+        Entry& entry = m_entries[m_slots[i]];
+        entry.aircraft = {icao, position, timestamp};
+        entry.cell = cell_of(position);
+        m_time = std::max(m_time, timestamp);
+        m_dirty = true;
+
+        if (m_time - m_published_time >= m_options.publish_interval) publish();
+        return true;
+    }
+
+    bool SpatialIndex::remove(uint32_t icao) {
+        const std::size_t index = find_slot(icao);
+        if (index >= m_slots.size()) return false;
+        const uint32_t entry = m_slots[index];
+
+        // Backward-shift deletion, as in the tracker's table
+        std::size_t hole = index;
+        for (std::size_t j = (index + 1) & m_mask; m_slots[j] != EMPTY; j = (j + 1) & m_mask) {
+            std::size_t home = home_slot(m_entries[m_slots[j]].aircraft.icao);
+            bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+            if (stays) continue;
+            m_slots[hole] = m_slots[j];
+            hole = j;
+        }
+        m_slots[hole] = EMPTY;
+
+        // Keep the entries dense: move the last one into the gap
+        const auto last = static_cast<uint32_t>(m_entries.size() - 1);
+        if (entry != last) {
+            m_entries[entry] = m_entries[last];
+            m_slots[find_slot(m_entries[entry].aircraft.icao)] = entry;
+        }
+        m_entries.pop_back();
+        m_dirty = true;
+        return true;
+    }
+
+    void SpatialIndex::publish() {
+        m_published_time = m_time;
+        if (!m_dirty) return;
+        m_dirty = false;
+
+        auto next = std::make_shared<SpatialSnapshot>();
+
+        m_order.resize(m_entries.size());
+        for (std::size_t i = 0; i < m_entries.size(); ++i) m_order[i] = uint64_t{m_entries[i].cell} << 32 | i;
+        sort_by_cell(m_order, m_scratch, m_cell_bits);
+
+        next->m_aircraft.resize(m_entries.size());
+        next->m_cells.resize(m_entries.size());
+        for (std::size_t i = 0; i < m_order.size(); ++i) {
+            const Entry& entry = m_entries[static_cast<uint32_t>(m_order[i])];
+            next->m_aircraft[i] = entry.aircraft;
+            next->m_cells[i] = entry.cell;
+        }
+        next->m_cell_degrees = m_options.cell_degrees;
+        next->m_rows = m_rows;
+        next->m_columns = m_columns;
+        next->m_time = m_time;
+
+        // Readers still holding the previous snapshot keep it alive; the last one frees it
+        std::atomic_store(&m_current, std::move(next));
+    }
+
+    std::shared_ptr<const SpatialSnapshot> SpatialIndex::snapshot() const {
+        return std::atomic_load(&m_current);
+    }
+
+}
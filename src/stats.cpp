@@ -0,0 +1,128 @@
+#include "adsb/stats.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace adsb::stats {
+
+    uint64_t histogram_bucket_limit(std::size_t bucket) {
+        constexpr std::size_t SUB_BUCKETS = std::size_t{1} << HISTOGRAM_SUB_BITS;
+        if (bucket < SUB_BUCKETS) return bucket;
+        const std::size_t group = bucket >> HISTOGRAM_SUB_BITS;
+        const std::size_t sub = bucket & (SUB_BUCKETS - 1);
+        const unsigned msb = static_cast<unsigned>(group + HISTOGRAM_SUB_BITS - 1);
+        const unsigned shift = msb - HISTOGRAM_SUB_BITS;
+        return ((uint64_t{SUB_BUCKETS + sub} + 1) << shift) - 1;
+    }
+
+    uint64_t Histogram::percentile_ns(double percentile) const {
+        if (count == 0) return 0;
+        const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+        const auto rank = static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (std::size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) return histogram_bucket_limit(b);
+        }
+        return histogram_bucket_limit(HISTOGRAM_BUCKETS - 1);
+    }
+
+    Snapshot Snapshot::operator-(const Snapshot& earlier) const {
+        Snapshot result = *this;
+        for (std::size_t i = 0; i < COUNTER_COUNT; ++i) result.counters[i] -= earlier.counters[i];
+        for (std::size_t i = 0; i < 32; ++i) {
+            result.downlink_formats[i] -= earlier.downlink_formats[i];
+            result.type_codes[i] -= earlier.type_codes[i];
+        }
+        for (std::size_t s = 0; s < STAGE_COUNT; ++s) {
+            Histogram& histogram = result.latency[s];
+            for (std::size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) histogram.buckets[b] -= earlier.latency[s].buckets[b];
+            histogram.count -= earlier.latency[s].count;
+            histogram.total_ns -= earlier.latency[s].total_ns;
+        }
+        return result;
+    }
+
+#if ADSB_ENABLE_STATS
+
+    namespace {
+
+        /**
+         * @struct Registry
+         * @brief Blocks of the live threads plus the totals of exited threads.
+         */
+        struct Registry {
+            std::mutex mutex;
+            std::vector<detail::ThreadStats*> threads;
+            Snapshot retired;
+        };
+
+        Registry& registry() {
+            // Never destroyed: threads may exit after static destruction has begun
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+        void accumulate(Snapshot& into, const detail::ThreadStats& stats) {
+            for (std::size_t i = 0; i < COUNTER_COUNT; ++i) {
+                into.counters[i] += stats.counters[i].load(std::memory_order_relaxed);
+            }
+            for (std::size_t i = 0; i < 32; ++i) {
+                into.downlink_formats[i] += stats.downlink_formats[i].load(std::memory_order_relaxed);
+                into.type_codes[i] += stats.type_codes[i].load(std::memory_order_relaxed);
+            }
+            for (std::size_t s = 0; s < STAGE_COUNT; ++s) {
+                Histogram& histogram = into.latency[s];
+                const auto& latency = stats.latency[s];
+                for (std::size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+                    histogram.buckets[b] += latency.buckets[b].load(std::memory_order_relaxed);
+                }
+                histogram.count += latency.count.load(std::memory_order_relaxed);
+                histogram.total_ns += latency.total_ns.load(std::memory_order_relaxed);
+            }
+        }
+
+    }
+
+    namespace detail {
+
+        ThreadStats* register_thread() {
+            // Value-initialized, so all counters start at zero
+            auto* stats = new ThreadStats();
+
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.threads.push_back(stats);
+            return stats;
+        }
+
+        void retire_thread(ThreadStats* stats) {
+            Registry& r = registry();
+            {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                accumulate(r.retired, *stats);
+                r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), stats), r.threads.end());
+            }
+            delete stats;
+        }
+
+    }
+
+    Snapshot snapshot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Snapshot result = r.retired;
+        for (const detail::ThreadStats* stats : r.threads) accumulate(result, *stats);
+        return result;
+    }
+
+#else
+
+    Snapshot snapshot() {
+        return Snapshot{};
+    }
+
+#endif
+
+}
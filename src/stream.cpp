@@ -0,0 +1,251 @@
+#include "adsb/stream.hpp"
+
+#include "adsb/utils.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    constexpr int8_t INVALID_HEX = -1;
+
+    struct HexTable {
+        int8_t value[256];
+    };
+
+    constexpr HexTable make_hex_table() {
+        HexTable table{};
+        for (int i = 0; i < 256; ++i) table.value[i] = INVALID_HEX;
+        for (int i = 0; i < 10; ++i) table.value['0' + i] = static_cast<int8_t>(i);
+        for (int i = 0; i < 6; ++i) {
+            table.value['a' + i] = static_cast<int8_t>(10 + i);
+            table.value['A' + i] = static_cast<int8_t>(10 + i);
+        }
+        return table;
+    }
+
+    constexpr HexTable HEX = make_hex_table();
+
+    /**
+     * @brief Parses `count` hex digit pairs into bytes.
+     * @return false if a character is not a hex digit.
+     */
+    bool parse_hex(const uint8_t* text, std::size_t count, uint8_t* out) {
+        for (std::size_t i = 0; i < count; ++i) {
+            int hi = HEX.value[text[2 * i]];
+            int lo = HEX.value[text[2 * i + 1]];
+            if ((hi | lo) < 0) return false;
+            out[i] = static_cast<uint8_t>((hi << 4) | lo);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks a short span for a Beast escape byte, eight bytes at a time.
+     */
+    bool contains_escape(const uint8_t* bytes, std::size_t count) {
+        constexpr uint64_t ONES = 0x0101010101010101ULL;
+        constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+        constexpr uint64_t PATTERN = ONES * adsb::stream::BeastFormat::ESCAPE;
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            word ^= PATTERN;
+            if ((word - ONES) & ~word & HIGHS) return true;
+        }
+        for (; i < count; ++i) {
+            if (bytes[i] == adsb::stream::BeastFormat::ESCAPE) return true;
+        }
+        return false;
+    }
+
+    std::size_t beast_frame_bytes(uint8_t type) {
+        switch (type) {
+            case '1': return 2;         // Mode A/C
+            case '2': return adsb::types::SHORT_FRAME_BYTES;
+            case '3': return adsb::types::LONG_FRAME_BYTES;
+            default: return 0;
+        }
+    }
+
+}
+
+namespace adsb::stream {
+
+    detail::ParseResult BeastFormat::parse(const uint8_t* p, const uint8_t* end,
+                                           const uint8_t*& next, FrameView& view) {
+        if (end - p < 2) return detail::ParseResult::INCOMPLETE;
+
+        const uint8_t type = p[1];
+        const std::size_t frame_bytes = beast_frame_bytes(type);
+        if (frame_bytes == 0) {
+            // An escaped 0x1A outside of a message or an unknown type: resynchronize
+            next = p + (type == ESCAPE ? 2 : 1);
+            return detail::ParseResult::SKIPPED;
+        }
+
+        const std::size_t message_bytes = 7 + frame_bytes;
+        const uint8_t* body = p + 2;
+        const uint8_t* message;
+
+        if (static_cast<std::size_t>(end - body) >= message_bytes
+            && !contains_escape(body, message_bytes)) {
+            // Nothing escaped: the frame is used in place
+            message = body;
+            next = body + message_bytes;
+        } else {
+            const uint8_t* q = body;
+            for (std::size_t i = 0; i < message_bytes; ++i) {
+                if (q == end) return detail::ParseResult::INCOMPLETE;
+                uint8_t byte = *q++;
+                if (byte == ESCAPE) {
+                    if (q == end) return detail::ParseResult::INCOMPLETE;
+                    if (*q != ESCAPE) {
+                        // A lone 0x1A starts the next message, this one is truncated
+                        next = q - 1;
+                        return detail::ParseResult::SKIPPED;
+                    }
+                    ++q;
+                }
+                m_message[i] = byte;
+            }
+            message = m_message;
+            next = q;
+        }
+
+        if (type == '1') return detail::ParseResult::SKIPPED;
+
+        view.mlat_ticks = utils::load_be(message, 6);
+        view.signal = message[6];
+        view.data = message + 7;
+        view.length = frame_bytes;
+        return detail::ParseResult::FRAME;
+    }
+
+    detail::ParseResult AvrFormat::parse(const uint8_t* p, const uint8_t* end,
+                                         const uint8_t*& next, FrameView& view) {
+        const std::size_t available = static_cast<std::size_t>(end - p);
+        const void* found = std::memchr(p, ';', std::min(available, MAX_MESSAGE_BYTES));
+        if (found == nullptr) {
+            if (available < MAX_MESSAGE_BYTES) return detail::ParseResult::INCOMPLETE;
+            next = p + 1;
+            return detail::ParseResult::SKIPPED;
+        }
+
+        const uint8_t* terminator = static_cast<const uint8_t*>(found);
+        next = terminator + 1;
+
+        const uint8_t* text = p + 1;
+        uint8_t header[7];
+        std::size_t header_bytes = 0;
+        if (*p == '@') header_bytes = 6;
+        else if (*p == '<') header_bytes = 7;
+
+        const std::size_t digits = static_cast<std::size_t>(terminator - text);
+        if (digits < 2 * header_bytes) return detail::ParseResult::SKIPPED;
+        const std::size_t frame_digits = digits - 2 * header_bytes;
+        if (frame_digits != 2 * types::SHORT_FRAME_BYTES && frame_digits != 2 * types::LONG_FRAME_BYTES) {
+            return detail::ParseResult::SKIPPED;
+        }
+
+        if (!parse_hex(text, header_bytes, header)) return detail::ParseResult::SKIPPED;
+        if (!parse_hex(text + 2 * header_bytes, frame_digits / 2, m_frame)) return detail::ParseResult::SKIPPED;
+
+        view.mlat_ticks = header_bytes >= 6 ? utils::load_be(header, 6) : 0;
+        view.signal = header_bytes == 7 ? header[6] : 0;
+        view.data = m_frame;
+        view.length = frame_digits / 2;
+        return detail::ParseResult::FRAME;
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(other.m_data), m_size(other.m_size), m_open(other.m_open) {
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_open = false;
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_open = other.m_open;
+            other.m_data = nullptr;
+            other.m_size = 0;
+            other.m_open = false;
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::string& path) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(info.st_size);
+        if (size > 0) {
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                return false;
+            }
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+            m_data = static_cast<const uint8_t*>(mapping);
+        }
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+
+        m_size = size;
+        m_open = true;
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (m_data != nullptr) {
+            ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+
+    FdReader::FdReader(int fd, std::size_t buffer_size)
+        : m_fd(fd),
+          m_buffer(std::max<std::size_t>(buffer_size, 1)),
+          m_eof(false) {
+    }
+
+    long FdReader::fill() {
+        for (;;) {
+            ssize_t count = ::read(m_fd, m_buffer.data(), m_buffer.size());
+            if (count > 0) return static_cast<long>(count);
+            if (count == 0) {
+                m_eof = true;
+                return 0;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+    }
+
+}
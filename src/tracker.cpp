@@ -0,0 +1,308 @@
+#include "adsb/tracker.hpp"
+
+#include "adsb/cpr.hpp"
+#include "adsb/message/AirbornePositionMessage.hpp"
+#include "adsb/message/AllCallMessage.hpp"
+#include "adsb/message/IdentificationMessage.hpp"
+#include "adsb/message/SurveillanceMessage.hpp"
+#include "adsb/message/VelocityMessage.hpp"
+#include "adsb/spatial_index.hpp"
+#include "adsb/stats.hpp"
+#include "adsb/utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+    std::size_t table_size_for(std::size_t capacity) {
+        // Keep the load factor at or below 50% for short probe sequences
+        std::size_t size = 16;
+        while (size < capacity * 2) size <<= 1;
+        return size;
+    }
+
+    unsigned log2_of(std::size_t power_of_two) {
+        unsigned bits = 0;
+        while ((std::size_t{1} << bits) < power_of_two) ++bits;
+        return bits;
+    }
+
+}
+
+namespace adsb::tracker {
+
+    AircraftTracker::AircraftTracker(const TrackerOptions& options)
+        : m_options(options),
+          m_slots(table_size_for(std::max<std::size_t>(options.capacity, 1))),
+          m_callsigns(m_slots.size(), CallsignEntry{NO_CALLSIGN, EMPTY}),
+          m_mask(m_slots.size() - 1),
+          m_shift(64 - log2_of(m_slots.size())),
+          m_size(0),
+          m_expiry_cursor(0) {
+        for (auto& slot : m_slots) slot.icao = EMPTY;
+    }
+
+    std::size_t AircraftTracker::home_slot(uint32_t icao) const {
+        // Fibonacci hashing: ICAO blocks are assigned per country, so the low bits alone cluster badly
+        return static_cast<std::size_t>((icao * 0x9E3779B97F4A7C15ULL) >> m_shift);
+    }
+
+    std::size_t AircraftTracker::find_slot(uint32_t icao) const {
+        for (std::size_t i = home_slot(icao);; i = (i + 1) & m_mask) {
+            if (m_slots[i].icao == icao) return i;
+            if (m_slots[i].icao == EMPTY) return m_slots.size();
+        }
+    }
+
+    AircraftState* AircraftTracker::find_or_insert(uint32_t icao) {
+        std::size_t i = home_slot(icao);
+        for (;; i = (i + 1) & m_mask) {
+            if (m_slots[i].icao == icao) return &m_slots[i];
+            if (m_slots[i].icao == EMPTY) break;
+        }
+
+        if (m_size >= m_options.capacity) return nullptr;
+
+        AircraftState& state = m_slots[i];
+        state = AircraftState{};
+        state.icao = icao;
+        state.category = message::EmitterCategory::UNKNOWN;
+        ++m_size;
+        return &state;
+    }
+
+    void AircraftTracker::erase_slot(std::size_t index) {
+        unindex_callsign(m_slots[index]);
+        if (m_options.spatial_index != nullptr && m_slots[index].has_position) {
+            m_options.spatial_index->remove(m_slots[index].icao);
+        }
+
+        // Backward-shift deletion keeps probe sequences intact without tombstones
+        std::size_t hole = index;
+        for (std::size_t j = (index + 1) & m_mask; m_slots[j].icao != EMPTY; j = (j + 1) & m_mask) {
+            std::size_t home = home_slot(m_slots[j].icao);
+            bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+            if (stays) continue;
+            m_slots[hole] = m_slots[j];
+            hole = j;
+        }
+        m_slots[hole].icao = EMPTY;
+        --m_size;
+    }
+
+    const AircraftState* AircraftTracker::find(uint32_t icao) const {
+        std::size_t i = find_slot(icao);
+        return i < m_slots.size() ? &m_slots[i] : nullptr;
+    }
+
+    std::size_t AircraftTracker::callsign_home_slot(uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> m_shift);
+    }
+
+    std::size_t AircraftTracker::find_callsign_slot(uint64_t key) const {
+        for (std::size_t i = callsign_home_slot(key);; i = (i + 1) & m_mask) {
+            if (m_callsigns[i].key == key) return i;
+            if (m_callsigns[i].key == NO_CALLSIGN) return m_callsigns.size();
+        }
+    }
+
+    void AircraftTracker::set_callsign(AircraftState& state, const char (&callsign)[8], uint8_t length, uint64_t key) {
+        std::memcpy(state.callsign, callsign, sizeof(state.callsign));
+        state.callsign_length = length;
+        if (length == 0) key = NO_CALLSIGN;
+        if (key == state.callsign_key) return;
+
+        unindex_callsign(state);
+        state.callsign_key = key;
+        if (key == NO_CALLSIGN) return;
+
+        std::size_t i = callsign_home_slot(key);
+        while (m_callsigns[i].key != NO_CALLSIGN && m_callsigns[i].key != key) i = (i + 1) & m_mask;
+        // A callsign reported by several aircraft points to the latest one
+        m_callsigns[i] = {key, state.icao};
+    }
+
+    void AircraftTracker::unindex_callsign(const AircraftState& state) {
+        if (state.callsign_key == NO_CALLSIGN) return;
+        std::size_t index = find_callsign_slot(state.callsign_key);
+        if (index >= m_callsigns.size() || m_callsigns[index].icao != state.icao) return;
+
+        // Same backward-shift deletion as for the aircraft table
+        std::size_t hole = index;
+        for (std::size_t j = (index + 1) & m_mask; m_callsigns[j].key != NO_CALLSIGN; j = (j + 1) & m_mask) {
+            std::size_t home = callsign_home_slot(m_callsigns[j].key);
+            bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+            if (stays) continue;
+            m_callsigns[hole] = m_callsigns[j];
+            hole = j;
+        }
+        m_callsigns[hole] = {NO_CALLSIGN, EMPTY};
+    }
+
+    const AircraftState* AircraftTracker::find_by_callsign(std::string_view callsign) const {
+        // Trailing spaces are implied by the key
+        while (!callsign.empty() && callsign.back() == ' ') callsign.remove_suffix(1);
+        if (callsign.empty()) return nullptr;
+        return find_by_callsign_key(message::pack_callsign(callsign));
+    }
+
+    const AircraftState* AircraftTracker::find_by_callsign_key(uint64_t callsign_key) const {
+        if (callsign_key == NO_CALLSIGN) return nullptr;
+        std::size_t i = find_callsign_slot(callsign_key);
+        return i < m_callsigns.size() ? find(m_callsigns[i].icao) : nullptr;
+    }
+
+    bool AircraftTracker::remove(uint32_t icao) {
+        std::size_t i = find_slot(icao);
+        if (i >= m_slots.size()) return false;
+        erase_slot(i);
+        return true;
+    }
+
+    void AircraftTracker::expire(types::Timestamp now, std::size_t slots) {
+        for (std::size_t n = 0; n < slots; ++n) {
+            AircraftState& slot = m_slots[m_expiry_cursor];
+            if (slot.icao != EMPTY && now - slot.last_seen > m_options.expiry) {
+                // The hole may be refilled by a shifted entry, so inspect the same slot again
+                erase_slot(m_expiry_cursor);
+                continue;
+            }
+            m_expiry_cursor = (m_expiry_cursor + 1) & m_mask;
+        }
+    }
+
+    void AircraftTracker::clear() {
+        for (auto& slot : m_slots) {
+            if (slot.icao == EMPTY) continue;
+            if (m_options.spatial_index != nullptr && slot.has_position) m_options.spatial_index->remove(slot.icao);
+            slot.icao = EMPTY;
+        }
+        std::fill(m_callsigns.begin(), m_callsigns.end(), CallsignEntry{NO_CALLSIGN, EMPTY});
+        m_size = 0;
+        m_expiry_cursor = 0;
+    }
+
+    const AircraftState* AircraftTracker::update(const message::MessageData& data, types::Timestamp timestamp) {
+        ADSB_STATS_TIMER(TRACKER_UPDATE);
+        if (std::holds_alternative<std::monostate>(data)) return nullptr;
+        const uint32_t icao = message::icao_of(data);
+
+        expire(timestamp, m_options.expiry_slots_per_update);
+
+        AircraftState* state = find_or_insert(icao);
+        if (state == nullptr) return nullptr;
+
+        state->last_seen = std::max(state->last_seen, timestamp);
+        ++state->message_count;
+
+        if (auto* identification = std::get_if<message::IdentificationData>(&data)) apply(*state, *identification, timestamp);
+        else if (auto* position = std::get_if<message::AirbornePositionData>(&data)) apply(*state, *position, timestamp);
+        else if (auto* velocity = std::get_if<message::VelocityData>(&data)) apply(*state, *velocity, timestamp);
+        else if (auto* all_call = std::get_if<message::AllCallData>(&data)) apply(*state, *all_call, timestamp);
+        else if (auto* surveillance = std::get_if<message::SurveillanceData>(&data)) apply(*state, *surveillance, timestamp);
+        return state;
+    }
+
+    const AircraftState* AircraftTracker::update(const message::ADSBMessage& message) {
+        if (auto* identification = dynamic_cast<const message::IdentificationMessage*>(&message)) {
+            return update(identification->get_data(), message.get_timestamp());
+        }
+        if (auto* position = dynamic_cast<const message::AirbornePositionMessage*>(&message)) {
+            return update(position->get_data(), message.get_timestamp());
+        }
+        if (auto* velocity = dynamic_cast<const message::VelocityMessage*>(&message)) {
+            return update(velocity->get_data(), message.get_timestamp());
+        }
+        if (auto* all_call = dynamic_cast<const message::AllCallMessage*>(&message)) {
+            return update(all_call->get_data(), message.get_timestamp());
+        }
+        if (auto* surveillance = dynamic_cast<const message::SurveillanceMessage*>(&message)) {
+            return update(surveillance->get_data(), message.get_timestamp());
+        }
+        return nullptr;
+    }
+
+    void AircraftTracker::apply(AircraftState& state, const message::IdentificationData& data, types::Timestamp) {
+        set_callsign(state, data.callsign, data.callsign_length, data.callsign_key);
+        state.category = data.category;
+        state.has_identification = true;
+    }
+
+    void AircraftTracker::apply(AircraftState& state, const message::AirbornePositionData& data, types::Timestamp timestamp) {
+        if (data.altitude != message::INVALID_ALTITUDE) {
+            state.altitude = data.altitude;
+            state.has_altitude = true;
+        }
+
+        CprFrame& frame = data.is_odd ? state.odd_frame : state.even_frame;
+        frame = {data.cpr_lat, data.cpr_lon, timestamp, true};
+
+        if (m_options.local_decoding && state.has_position
+            && timestamp - state.position_time <= m_options.local_reference_max_age) {
+            types::PositionResult local = cpr::local_position(data.cpr_lat, data.cpr_lon, data.is_odd, state.position);
+            if (local.is_valid) {
+                set_position(state, local.position, timestamp);
+                return;
+            }
+        }
+
+        const CprFrame& other = data.is_odd ? state.even_frame : state.odd_frame;
+        const bool pair_in_time = std::chrono::abs(timestamp - other.timestamp) <= cpr::MAX_PAIR_INTERVAL;
+        if (other.is_valid && !pair_in_time) ADSB_STATS_COUNT(CPR_PAIR_TOO_OLD);
+        if (other.is_valid && pair_in_time) {
+            const CprFrame& even = state.even_frame;
+            const CprFrame& odd = state.odd_frame;
+            types::PositionResult global = cpr::global_position(even.cpr_lat, even.cpr_lon, odd.cpr_lat, odd.cpr_lon,
+                                                                even.timestamp > odd.timestamp);
+            if (global.is_valid) {
+                set_position(state, global.position, timestamp);
+                return;
+            }
+        }
+
+        // First fix of an aircraft close enough to the receiver for an unambiguous local decode
+        if (!state.has_position && m_options.receiver_range_nm > 0.0) {
+            types::PositionResult local = cpr::local_position(data.cpr_lat, data.cpr_lon, data.is_odd, m_options.receiver);
+            if (local.is_valid && utils::distance_nm(m_options.receiver, local.position) <= m_options.receiver_range_nm) {
+                set_position(state, local.position, timestamp);
+            }
+        }
+    }
+
+    void AircraftTracker::set_position(AircraftState& state, const types::GlobalPosition& position, types::Timestamp timestamp) {
+        state.position = position;
+        state.position.altitude = state.altitude;
+        state.position_time = timestamp;
+        state.has_position = true;
+        if (m_options.spatial_index != nullptr) m_options.spatial_index->update(state.icao, state.position, timestamp);
+    }
+
+    void AircraftTracker::apply(AircraftState& state, const message::VelocityData& data, types::Timestamp) {
+        state.speed = data.speed;
+        state.heading = data.heading;
+        state.vertical_rate = data.vertical_rate;
+        state.has_velocity = true;
+    }
+
+    void AircraftTracker::apply(AircraftState&, const message::AllCallData&, types::Timestamp) {
+        // All-call replies only confirm that the aircraft is present
+    }
+
+    void AircraftTracker::apply(AircraftState& state, const message::SurveillanceData& data, types::Timestamp) {
+        if (data.has_altitude) {
+            state.altitude = data.altitude;
+            state.has_altitude = true;
+        }
+        if (data.has_squawk) {
+            state.squawk = data.squawk;
+            state.has_squawk = true;
+        }
+        if (data.callsign_length > 0) {
+            // Comm-B identification does not carry the emitter category
+            set_callsign(state, data.callsign, data.callsign_length, data.callsign_key);
+            state.has_identification = true;
+        }
+    }
+
+}
@@ -0,0 +1,178 @@
+#include "adsb/spatial_index.hpp"
+#include "adsb/stream.hpp"
+#include "adsb/tracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include <unistd.h>
+
+namespace {
+
+    using adsb::tracker::AircraftState;
+    using adsb::tracker::CprFrame;
+    using adsb::types::Timestamp;
+
+    static_assert(std::is_trivially_copyable_v<AircraftState>, "snapshots store AircraftState records as raw bytes");
+
+    constexpr char SNAPSHOT_MAGIC[8] = {'A', 'D', 'S', 'B', 'T', 'R', 'K', '1'};
+    constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+    /**
+     * @struct SnapshotHeader
+     * @brief Start of a snapshot file; the AircraftState records follow.
+     *
+     * The timestamps of the records are stored relative to the `now` passed
+     * to save(), as the tracker's time base does not survive a reboot.
+     */
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;           // sizeof(AircraftState)
+        uint32_t layout;                // layout_fingerprint()
+        uint32_t reserved;
+        uint64_t count;
+        int64_t saved_at;               // Wall-clock time of save(), nanoseconds since the Unix epoch
+    };
+
+    /// Hash of the field offsets of AircraftState, so that a rearranged struct of the same size is rejected.
+    constexpr uint32_t layout_fingerprint() {
+        const std::size_t offsets[] = {
+            offsetof(AircraftState, icao), offsetof(AircraftState, last_seen), offsetof(AircraftState, message_count),
+            offsetof(AircraftState, callsign), offsetof(AircraftState, callsign_length),
+            offsetof(AircraftState, callsign_key), offsetof(AircraftState, category),
+            offsetof(AircraftState, has_identification), offsetof(AircraftState, altitude),
+            offsetof(AircraftState, has_altitude), offsetof(AircraftState, squawk), offsetof(AircraftState, has_squawk),
+            offsetof(AircraftState, speed), offsetof(AircraftState, heading), offsetof(AircraftState, vertical_rate),
+            offsetof(AircraftState, has_velocity), offsetof(AircraftState, even_frame),
+            offsetof(AircraftState, odd_frame), offsetof(AircraftState, position),
+            offsetof(AircraftState, position_time), offsetof(AircraftState, has_position),
+        };
+        uint32_t hash = 2166136261u;    // FNV-1a
+        for (std::size_t offset : offsets) hash = (hash ^ static_cast<uint32_t>(offset)) * 16777619u;
+        return hash;
+    }
+
+    int64_t wall_clock_nanoseconds() {
+        const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+    }
+
+    void shift_timestamps(AircraftState& state, Timestamp::duration offset) {
+        state.last_seen += offset;
+        state.position_time += offset;
+        state.even_frame.timestamp += offset;
+        state.odd_frame.timestamp += offset;
+    }
+
+    /// Checks the fields that must not be read from an AircraftState unless they hold one of their valid values.
+    bool is_valid_record(const uint8_t* record) {
+        constexpr std::size_t flags[] = {
+            offsetof(AircraftState, has_identification), offsetof(AircraftState, has_altitude),
+            offsetof(AircraftState, has_squawk), offsetof(AircraftState, has_velocity),
+            offsetof(AircraftState, has_position), offsetof(AircraftState, even_frame) + offsetof(CprFrame, is_valid),
+            offsetof(AircraftState, odd_frame) + offsetof(CprFrame, is_valid),
+        };
+        static_assert(sizeof(bool) == 1, "flags are checked as single bytes");
+        for (std::size_t offset : flags) {
+            if (record[offset] > 1) return false;
+        }
+
+        uint32_t icao;
+        std::memcpy(&icao, record + offsetof(AircraftState, icao), sizeof(icao));
+        std::underlying_type_t<adsb::message::EmitterCategory> category;
+        std::memcpy(&category, record + offsetof(AircraftState, category), sizeof(category));
+        // decode_category() maps a type code of 1-4 and a 3-bit category code to 0-31
+        return icao <= 0xFFFFFF && category >= 0 && category < 32
+            && record[offsetof(AircraftState, callsign_length)] <= sizeof(AircraftState::callsign);
+    }
+
+    bool write_all(std::FILE* file, const void* data, std::size_t size) {
+        return std::fwrite(data, 1, size, file) == size;
+    }
+
+}
+
+namespace adsb::tracker {
+
+    bool AircraftTracker::save(const std::string& path, types::Timestamp now) const {
+        const std::string temporary = path + ".tmp";
+        std::FILE* file = std::fopen(temporary.c_str(), "wb");
+        if (file == nullptr) return false;
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.record_size = sizeof(AircraftState);
+        header.layout = layout_fingerprint();
+        header.count = m_size;
+        header.saved_at = wall_clock_nanoseconds();
+
+        bool ok = write_all(file, &header, sizeof(header));
+        for (const auto& slot : m_slots) {
+            if (!ok || slot.icao == EMPTY) continue;
+            AircraftState record = slot;
+            shift_timestamps(record, -now.time_since_epoch());
+            ok = write_all(file, &record, sizeof(record));
+        }
+        ok = std::fflush(file) == 0 && ok;
+        ok = ::fsync(::fileno(file)) == 0 && ok;
+        ok = std::fclose(file) == 0 && ok;
+        if (ok && std::rename(temporary.c_str(), path.c_str()) == 0) return true;
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    bool AircraftTracker::load(const std::string& path, types::Timestamp now) {
+        stream::MappedFile file;
+        if (!file.open(path) || file.size() < sizeof(SnapshotHeader)) return false;
+
+        SnapshotHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        const bool valid = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0
+                        && header.version == SNAPSHOT_VERSION && header.record_size == sizeof(AircraftState)
+                        && header.layout == layout_fingerprint()
+                        && header.count <= (file.size() - sizeof(header)) / sizeof(AircraftState);
+        if (!valid) return false;
+
+        const uint8_t* records = file.data() + sizeof(header);
+        for (uint64_t n = 0; n < header.count; ++n) {
+            if (!is_valid_record(records + n * sizeof(AircraftState))) return false;
+        }
+
+        // Time passed since the save, by the wall clock; a clock stepped back counts as none
+        const auto elapsed = std::chrono::nanoseconds(std::max<int64_t>(wall_clock_nanoseconds() - header.saved_at, 0));
+        const auto offset = now.time_since_epoch() - std::chrono::duration_cast<types::Timestamp::duration>(elapsed);
+
+        clear();
+        for (uint64_t n = 0; n < header.count; ++n) {
+            AircraftState saved;
+            std::memcpy(&saved, records + n * sizeof(AircraftState), sizeof(saved));
+            shift_timestamps(saved, offset);
+            if (saved.last_seen > now || now - saved.last_seen > m_options.expiry) continue;
+            if (m_size >= m_options.capacity) break;
+            restore(saved);
+        }
+
+        if (m_options.spatial_index != nullptr) m_options.spatial_index->publish();
+        return true;
+    }
+
+    void AircraftTracker::restore(const AircraftState& saved) {
+        AircraftState* state = find_or_insert(saved.icao);
+        if (state == nullptr) return;
+        *state = saved;
+
+        // The indexes are rebuilt rather than saved, as their layout depends on the table size
+        state->callsign_key = NO_CALLSIGN;
+        set_callsign(*state, saved.callsign, saved.callsign_length, saved.callsign_key);
+        if (m_options.spatial_index != nullptr && state->has_position) {
+            m_options.spatial_index->update(state->icao, state->position, state->position_time);
+        }
+    }
+
+}
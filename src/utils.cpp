@@ -1,7 +1,27 @@
 #include "adsb/utils.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
+namespace {
+
+    int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    constexpr double EARTH_RADIUS_NM = 3440.065;
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+
+}
+
 namespace adsb::utils {
     int bits_to_int(std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end) {
         int n = 0;
@@ -10,4 +30,43 @@ namespace adsb::utils {
         }
         return n;
     }
+
+    void pack_bits(const std::vector<int>& bits, uint8_t* out) {
+        for (std::size_t i = 0; i < bits.size() / 8; ++i) {
+            uint8_t byte = 0;
+            for (std::size_t j = 0; j < 8; ++j) {
+                byte = static_cast<uint8_t>((byte << 1) | (bits[i * 8 + j] & 1));
+            }
+            out[i] = byte;
+        }
+    }
+
+    std::size_t hex_to_bytes(std::string_view hex, uint8_t* out, std::size_t capacity) {
+        while (!hex.empty() && is_space(hex.front())) hex.remove_prefix(1);
+        while (!hex.empty() && is_space(hex.back())) hex.remove_suffix(1);
+
+        if (!hex.empty() && hex.front() == '*') hex.remove_prefix(1);
+        if (!hex.empty() && hex.back() == ';') hex.remove_suffix(1);
+
+        if (hex.empty() || hex.size() % 2 != 0 || hex.size() / 2 > capacity) return 0;
+
+        for (std::size_t i = 0; i < hex.size(); i += 2) {
+            int hi = hex_value(hex[i]);
+            int lo = hex_value(hex[i + 1]);
+            if (hi < 0 || lo < 0) return 0;
+            out[i / 2] = static_cast<uint8_t>((hi << 4) | lo);
+        }
+        return hex.size() / 2;
+    }
+
+    double distance_nm(const types::GlobalPosition& a, const types::GlobalPosition& b) {
+        double lat_a = a.latitude * DEG_TO_RAD;
+        double lat_b = b.latitude * DEG_TO_RAD;
+        double d_lat = lat_b - lat_a;
+        double d_lon = (b.longitude - a.longitude) * DEG_TO_RAD;
+
+        double h = std::sin(d_lat / 2) * std::sin(d_lat / 2)
+                 + std::cos(lat_a) * std::cos(lat_b) * std::sin(d_lon / 2) * std::sin(d_lon / 2);
+        return 2.0 * EARTH_RADIUS_NM * std::asin(std::sqrt(std::min(h, 1.0)));
+    }
 }
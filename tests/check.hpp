@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+
+namespace adsb::test {
+
+    /// Number of failed checks so far; a test returns non-zero if any failed.
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int result() {
+        if (failures() != 0) std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return failures() == 0 ? 0 : 1;
+    }
+
+}
+
+/// Records a failure, with the location and expression, if `condition` is false.
+#define ADSB_CHECK(condition)                                                                   \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);  \
+            ++::adsb::test::failures();                                                         \
+        }                                                                                       \
+    } while (0)
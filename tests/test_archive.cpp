@@ -0,0 +1,229 @@
+#include "check.hpp"
+
+#include "adsb/archive.hpp"
+#include "adsb/decoder.hpp"
+#include "adsb/simulator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace {
+
+    using adsb::archive::ArchiveQuery;
+    using adsb::archive::ArchiveReader;
+    using adsb::archive::ArchiveWriter;
+    using adsb::archive::ChunkIndexEntry;
+    using adsb::archive::MessageKind;
+
+    constexpr std::size_t FILE_HEADER_BYTES = 16;
+
+    /**
+     * @struct Row
+     * @brief A message reduced to comparable values: its time, address, kind and up to three fields.
+     */
+    struct Row {
+        int64_t time_ns;
+        uint32_t icao;
+        std::size_t kind;
+        std::array<uint64_t, 3> fields;
+
+        auto key() const { return std::tie(time_ns, icao, kind, fields); }
+        bool operator<(const Row& other) const { return key() < other.key(); }
+        bool operator==(const Row& other) const { return key() == other.key(); }
+    };
+
+    uint64_t bits_of(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    Row row_of(const adsb::message::MessageData& data, adsb::types::Timestamp timestamp) {
+        Row row{adsb::types::to_nanoseconds(timestamp), adsb::message::icao_of(data), data.index(), {}};
+        if (auto* identification = std::get_if<adsb::message::IdentificationData>(&data)) {
+            row.fields = {identification->callsign_key, static_cast<uint64_t>(identification->category),
+                          static_cast<uint64_t>(identification->type_code)};
+        } else if (auto* position = std::get_if<adsb::message::AirbornePositionData>(&data)) {
+            row.fields = {static_cast<uint64_t>(position->cpr_lat) << 32 | static_cast<uint32_t>(position->cpr_lon),
+                          static_cast<uint64_t>(position->altitude), position->is_odd};
+        } else if (auto* velocity = std::get_if<adsb::message::VelocityData>(&data)) {
+            row.fields = {bits_of(velocity->speed), bits_of(velocity->heading),
+                          static_cast<uint64_t>(velocity->vertical_rate)};
+        } else if (auto* all_call = std::get_if<adsb::message::AllCallData>(&data)) {
+            row.fields = {static_cast<uint64_t>(all_call->capability), static_cast<uint64_t>(all_call->interrogator), 0};
+        } else if (auto* surveillance = std::get_if<adsb::message::SurveillanceData>(&data)) {
+            row.fields = {static_cast<uint64_t>(surveillance->squawk), static_cast<uint64_t>(surveillance->altitude),
+                          static_cast<uint64_t>(surveillance->downlink_format)};
+        }
+        return row;
+    }
+
+    /// Decoded simulator traffic with a few all-call and surveillance replies mixed in, in time order.
+    std::vector<std::pair<adsb::message::MessageData, adsb::types::Timestamp>> traffic(std::size_t count) {
+        adsb::simulator::SimulatorOptions options;
+        options.aircraft = 50;
+        adsb::simulator::TrafficSimulator simulator(options);
+        std::vector<std::pair<adsb::message::MessageData, adsb::types::Timestamp>> messages;
+        for (const auto& frame : simulator.generate(count)) {
+            const auto timestamp = adsb::types::from_mlat_ticks(frame.mlat_ticks);
+            const auto data = adsb::decoder::decode_value(frame.data, frame.length);
+            messages.emplace_back(data, timestamp);
+            const uint32_t icao = adsb::message::icao_of(data);
+            if (messages.size() % 7 == 0) {
+                messages.emplace_back(adsb::message::AllCallData{icao, 5, static_cast<int>(messages.size() % 16)}, timestamp);
+            }
+            if (messages.size() % 11 == 0) {
+                adsb::message::SurveillanceData surveillance{};
+                surveillance.icao = icao;
+                surveillance.downlink_format = 5;
+                surveillance.squawk = 1000 + static_cast<int>(messages.size() % 7000);
+                surveillance.has_squawk = true;
+                messages.emplace_back(surveillance, timestamp);
+            }
+        }
+        return messages;
+    }
+
+    std::vector<Row> scan_all(const ArchiveReader& reader, const ArchiveQuery& query = {}) {
+        std::vector<Row> rows;
+        reader.scan(query, [&rows](const adsb::message::MessageData& data, adsb::types::Timestamp timestamp) {
+            rows.push_back(row_of(data, timestamp));
+        });
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    template <typename It>
+    std::vector<Row> rows_of(It begin, It end) {
+        std::vector<Row> rows;
+        for (It it = begin; it != end; ++it) rows.push_back(row_of(it->first, it->second));
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    std::size_t file_size(const std::string& path) {
+        struct stat info {};
+        return ::stat(path.c_str(), &info) == 0 ? static_cast<std::size_t>(info.st_size) : 0;
+    }
+
+    void append_bytes(const std::string& path, const void* bytes, std::size_t size) {
+        std::FILE* file = std::fopen(path.c_str(), "ab");
+        if (file == nullptr) return;
+        std::fwrite(bytes, 1, size, file);
+        std::fclose(file);
+    }
+
+    void remove_archive(const std::string& path) {
+        std::remove(path.c_str());
+        std::remove((path + ".idx").c_str());
+    }
+
+}
+
+int main() {
+    const std::string path = "test_archive.adsb";
+    const std::string index_path = path + ".idx";
+    remove_archive(path);
+
+    const auto messages = traffic(6000);
+    const auto middle = messages.begin() + static_cast<std::ptrdiff_t>(messages.size() / 2);
+    adsb::archive::ArchiveWriterOptions options;
+    options.chunk_rows = 200;
+
+    // Round trip of the first half
+    {
+        ArchiveWriter writer(options);
+        ADSB_CHECK(writer.open(path));
+        ADSB_CHECK(!writer.append(adsb::message::MessageData{}, adsb::types::from_nanoseconds(0)));
+        for (auto it = messages.begin(); it != middle; ++it) ADSB_CHECK(writer.append(it->first, it->second));
+        ADSB_CHECK(writer.close());
+
+        ArchiveReader reader;
+        ADSB_CHECK(reader.open(path));
+        ADSB_CHECK(scan_all(reader) == rows_of(messages.begin(), middle));
+    }
+
+    // Damage both tails as an interrupted write would: a partial chunk and a partial index record
+    const std::size_t data_size = file_size(path);
+    const std::size_t index_size = file_size(index_path);
+    const uint8_t garbage[13] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+    append_bytes(path, garbage, 5);
+    append_bytes(index_path, garbage, sizeof(garbage));
+
+    // Reopening cuts the torn tails off and appends the second half
+    {
+        ArchiveWriter writer(options);
+        ADSB_CHECK(writer.open(path));
+        ADSB_CHECK(file_size(path) == data_size);
+        ADSB_CHECK(file_size(index_path) == index_size);
+        for (auto it = middle; it != messages.end(); ++it) ADSB_CHECK(writer.append(it->first, it->second));
+        ADSB_CHECK(writer.close());
+    }
+    ADSB_CHECK((file_size(path) - FILE_HEADER_BYTES) % 8 == 0);
+    ADSB_CHECK((file_size(index_path) - FILE_HEADER_BYTES) % sizeof(ChunkIndexEntry) == 0);
+
+    // An index record whose chunk never reached the data file is skipped
+    ChunkIndexEntry dangling{file_size(path) + 4096, 10, static_cast<uint8_t>(MessageKind::VELOCITY), {},
+                             INT64_MIN, INT64_MAX, 0, 0xFFFFFF};
+    append_bytes(index_path, &dangling, sizeof(dangling));
+
+    ArchiveReader reader;
+    ADSB_CHECK(reader.open(path));
+    const std::vector<Row> all = rows_of(messages.begin(), messages.end());
+    ADSB_CHECK(scan_all(reader) == all);
+
+    // Chunk pruning: exactly the chunks whose index record overlaps the query are read
+    const uint32_t icao = all[all.size() / 3].icao;
+    ArchiveQuery query;
+    query.icao = icao;
+    query.begin = adsb::types::from_nanoseconds(all[all.size() / 4].time_ns);
+    query.end = adsb::types::from_nanoseconds(all[all.size() / 2].time_ns);
+    query.kinds = adsb::archive::kind_bit(MessageKind::AIRBORNE_POSITION) | adsb::archive::kind_bit(MessageKind::VELOCITY);
+
+    std::size_t overlapping = 0;
+    for (std::size_t i = 0; i + 1 < reader.chunk_count(); ++i) {
+        const ChunkIndexEntry& entry = reader.chunks()[i];
+        const bool kind = entry.kind == static_cast<uint8_t>(MessageKind::AIRBORNE_POSITION)
+                       || entry.kind == static_cast<uint8_t>(MessageKind::VELOCITY);
+        const bool time = entry.max_time_ns >= all[all.size() / 4].time_ns && entry.min_time_ns < all[all.size() / 2].time_ns;
+        if (kind && time && entry.min_icao <= icao && icao <= entry.max_icao) ++overlapping;
+    }
+
+    std::vector<Row> expected;
+    for (const Row& row : all) {
+        const bool kind = row.kind == static_cast<std::size_t>(MessageKind::AIRBORNE_POSITION)
+                       || row.kind == static_cast<std::size_t>(MessageKind::VELOCITY);
+        if (kind && row.icao == icao && row.time_ns >= all[all.size() / 4].time_ns
+            && row.time_ns < all[all.size() / 2].time_ns) {
+            expected.push_back(row);
+        }
+    }
+
+    std::vector<Row> found;
+    const adsb::archive::ScanStats stats = reader.scan(query, [&found](const adsb::message::MessageData& data,
+                                                                       adsb::types::Timestamp timestamp) {
+        found.push_back(row_of(data, timestamp));
+    });
+    std::sort(found.begin(), found.end());
+    ADSB_CHECK(!expected.empty());
+    ADSB_CHECK(found == expected);
+    ADSB_CHECK(stats.chunks == reader.chunk_count());
+    ADSB_CHECK(stats.chunks_read == overlapping);
+    ADSB_CHECK(stats.chunks_read < stats.chunks / 2);
+    ADSB_CHECK(stats.matches == expected.size());
+    // Binary search limits the inspected rows to those of the aircraft in the time range
+    ADSB_CHECK(stats.rows_read == expected.size());
+
+    reader.close();
+    remove_archive(path);
+    return adsb::test::result();
+}
@@ -0,0 +1,200 @@
+#include "check.hpp"
+
+#include "adsb/cpr.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    using adsb::cpr::CPR_MAX;
+
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double D_LAT_EVEN = 360.0 / 60.0;
+    constexpr double D_LAT_ODD = 360.0 / 59.0;
+
+    /// The trigonometric NL formula of the decoding guide.
+    int reference_nl(double lat) {
+        if (std::abs(lat) >= 87.0) return 1;
+        if (lat == 0) return 59;
+        double term = 1.0 - std::cos(PI / 30.0);
+        double lat_rad = lat * PI / 180.0;
+        double bottom = std::cos(lat_rad) * std::cos(lat_rad);
+        return static_cast<int>(std::floor(2.0 * PI / std::acos(1.0 - term / bottom)));
+    }
+
+    double reference_mod(double x, double y) {
+        return x - y * std::floor(x / y);
+    }
+
+    /// The global decoding equations of the guide, evaluated in double precision.
+    adsb::types::PositionResult reference_global(int even_lat, int even_lon, int odd_lat, int odd_lon, bool even_is_newer) {
+        const double lat_even = even_lat / double{CPR_MAX};
+        const double lon_even = even_lon / double{CPR_MAX};
+        const double lat_odd = odd_lat / double{CPR_MAX};
+        const double lon_odd = odd_lon / double{CPR_MAX};
+
+        const double j = std::floor(59.0 * lat_even - 60.0 * lat_odd + 0.5);
+        double r_lat_even = D_LAT_EVEN * (reference_mod(j, 60.0) + lat_even);
+        double r_lat_odd = D_LAT_ODD * (reference_mod(j, 59.0) + lat_odd);
+        if (r_lat_even >= 270.0) r_lat_even -= 360.0;
+        if (r_lat_odd >= 270.0) r_lat_odd -= 360.0;
+        if (std::abs(r_lat_even) > 90.0 || std::abs(r_lat_odd) > 90.0) return {{0.0, 0.0}, false};
+
+        const int nl = reference_nl(r_lat_even);
+        if (nl != reference_nl(r_lat_odd)) return {{0.0, 0.0}, false};
+
+        const double m = std::floor(lon_even * (nl - 1) - lon_odd * nl + 0.5);
+        const double n = std::max(even_is_newer ? nl : nl - 1, 1);
+        double longitude = 360.0 / n * (reference_mod(m, n) + (even_is_newer ? lon_even : lon_odd));
+        if (longitude >= 180.0) longitude -= 360.0;
+        return {{even_is_newer ? r_lat_even : r_lat_odd, longitude}, true};
+    }
+
+    /// The local decoding equations of the guide, evaluated in double precision.
+    adsb::types::PositionResult reference_local(int cpr_lat, int cpr_lon, bool is_odd,
+                                                const adsb::types::GlobalPosition& reference) {
+        const double lat_fraction = cpr_lat / double{CPR_MAX};
+        const double lon_fraction = cpr_lon / double{CPR_MAX};
+        const double d_lat = is_odd ? D_LAT_ODD : D_LAT_EVEN;
+        const double j = std::floor(reference.latitude / d_lat)
+                       + std::floor(0.5 + reference_mod(reference.latitude, d_lat) / d_lat - lat_fraction);
+        const double latitude = d_lat * (j + lat_fraction);
+        if (std::abs(latitude) > 90.0) return {{0.0, 0.0}, false};
+
+        const double d_lon = 360.0 / std::max(reference_nl(latitude) - (is_odd ? 1 : 0), 1);
+        const double m = std::floor(reference.longitude / d_lon)
+                       + std::floor(0.5 + reference_mod(reference.longitude, d_lon) / d_lon - lon_fraction);
+        double longitude = d_lon * (m + lon_fraction);
+        if (longitude > 180.0) longitude -= 360.0;
+        if (longitude <= -180.0) longitude += 360.0;
+        return {{latitude, longitude}, true};
+    }
+
+    bool same(const adsb::types::PositionResult& a, const adsb::types::PositionResult& b) {
+        if (a.is_valid != b.is_valid) return false;
+        return !a.is_valid || (a.position.latitude == b.position.latitude && a.position.longitude == b.position.longitude);
+    }
+
+    /**
+     * @struct Sweep
+     * @brief Compares global_position() with the reference and collects the pairs for the batch decoder.
+     */
+    struct Sweep {
+        std::vector<int> even_lat, even_lon, odd_lat, odd_lon;
+        std::vector<int64_t> even_time, odd_time;
+        std::size_t mismatches = 0;
+        std::size_t valid = 0;
+
+        void check(int e_lat, int e_lon, int o_lat, int o_lon) {
+            for (bool even_is_newer : {false, true}) {
+                const auto result = adsb::cpr::global_position(e_lat, e_lon, o_lat, o_lon, even_is_newer);
+                if (!same(result, reference_global(e_lat, e_lon, o_lat, o_lon, even_is_newer))) {
+                    if (mismatches++ < 5) {
+                        std::fprintf(stderr, "  global mismatch: %d %d %d %d %d\n", e_lat, e_lon, o_lat, o_lon, even_is_newer);
+                    }
+                }
+                valid += result.is_valid ? 1 : 0;
+
+                even_lat.push_back(e_lat);
+                even_lon.push_back(e_lon);
+                odd_lat.push_back(o_lat);
+                odd_lon.push_back(o_lon);
+                even_time.push_back(even_is_newer ? 1000 : 0);
+                odd_time.push_back(even_is_newer ? 0 : 1000);
+            }
+        }
+    };
+
+}
+
+int main() {
+    // NL() at every latitude a frame can decode to: every zone of both formats, every 17-bit offset
+    std::size_t nl_mismatches = 0;
+    for (double d_lat : {D_LAT_EVEN, D_LAT_ODD}) {
+        for (int zone = 0; zone < 60; ++zone) {
+            for (int cpr = 0; cpr < CPR_MAX; ++cpr) {
+                double lat = d_lat * (zone + cpr / double{CPR_MAX});
+                if (lat >= 270.0) lat -= 360.0;
+                if (std::abs(lat) > 90.0) continue;
+                if (adsb::cpr::NL(lat) != reference_nl(lat)) ++nl_mismatches;
+            }
+        }
+    }
+    ADSB_CHECK(nl_mismatches == 0);
+
+    // Global decoding. Sweeping all four 17-bit inputs jointly (2^68 pairs) is out of reach, so every input
+    // is swept over its full range while the other three take values that make most pairs decodable: the
+    // encoding of the same position, and a few arbitrary ones.
+    Sweep sweep;
+    const int arbitrary[] = {0, 1, 4096, 65535, 65536, 100000, CPR_MAX - 1};
+    for (int cpr = 0; cpr < CPR_MAX; ++cpr) {
+        // Latitudes: one zone per value, spread over both hemispheres
+        const int zone = cpr % 60;
+        double lat = D_LAT_EVEN * (zone + cpr / double{CPR_MAX});
+        if (lat >= 270.0) lat -= 360.0;
+        if (std::abs(lat) <= 90.0) {
+            const auto odd = adsb::cpr::encode(lat, 10.0, true);
+            sweep.check(cpr, 1234, odd.cpr_lat, odd.cpr_lon);
+        }
+        double odd_lat = D_LAT_ODD * ((cpr % 59) + cpr / double{CPR_MAX});
+        if (odd_lat >= 270.0) odd_lat -= 360.0;
+        if (std::abs(odd_lat) <= 90.0) {
+            const auto even = adsb::cpr::encode(odd_lat, -75.0, false);
+            sweep.check(even.cpr_lat, even.cpr_lon, cpr, 98765);
+        }
+        const int other = arbitrary[cpr % 7];
+        sweep.check(cpr, cpr, other, other);
+        sweep.check(other, other, cpr, cpr);
+    }
+
+    // Longitudes at latitudes across the NL bands, including the single-zone polar band
+    for (double lat : {0.0, 10.47, 33.5, 52.3, -48.9, 70.1, 86.9, 87.5, -89.9}) {
+        const auto even = adsb::cpr::encode(lat, 0.0, false);
+        const auto odd = adsb::cpr::encode(lat, 0.0, true);
+        for (int cpr = 0; cpr < CPR_MAX; ++cpr) {
+            const double lon = 360.0 * cpr / CPR_MAX - 180.0;
+            sweep.check(even.cpr_lat, cpr, odd.cpr_lat, adsb::cpr::encode(lat, lon, true).cpr_lon);
+            sweep.check(even.cpr_lat, adsb::cpr::encode(lat, lon, false).cpr_lon, odd.cpr_lat, cpr);
+        }
+    }
+    ADSB_CHECK(sweep.mismatches == 0);
+    ADSB_CHECK(sweep.valid > sweep.even_lat.size() / 2);
+
+    // The batch decoder (AVX2 where available) returns the same positions
+    const std::size_t count = sweep.even_lat.size();
+    std::vector<double> latitude(count), longitude(count);
+    std::vector<uint8_t> is_valid(count);
+    const adsb::cpr::PairBatch pairs{sweep.even_lat.data(), sweep.even_lon.data(), sweep.odd_lat.data(),
+                                     sweep.odd_lon.data(), sweep.even_time.data(), sweep.odd_time.data(), count};
+    adsb::cpr::global_position_batch(pairs, {latitude.data(), longitude.data(), is_valid.data()});
+    std::size_t batch_mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto expected = adsb::cpr::global_position(sweep.even_lat[i], sweep.even_lon[i], sweep.odd_lat[i],
+                                                         sweep.odd_lon[i], sweep.even_time[i] > sweep.odd_time[i]);
+        if (!same(expected, {{latitude[i], longitude[i]}, is_valid[i] != 0})) ++batch_mismatches;
+    }
+    ADSB_CHECK(batch_mismatches == 0);
+
+    // Local decoding: every 17-bit latitude and longitude of both formats, around a few references
+    std::size_t local_mismatches = 0;
+    for (const adsb::types::GlobalPosition& reference : {adsb::types::GlobalPosition{52.3, 4.76, 0},
+                                                         adsb::types::GlobalPosition{-33.9, 151.2, 0},
+                                                         adsb::types::GlobalPosition{0.0, -179.9, 0},
+                                                         adsb::types::GlobalPosition{86.0, 20.0, 0}}) {
+        for (bool is_odd : {false, true}) {
+            for (int cpr = 0; cpr < CPR_MAX; ++cpr) {
+                const int other = (cpr * 7919) % CPR_MAX;
+                if (!same(adsb::cpr::local_position(cpr, other, is_odd, reference),
+                          reference_local(cpr, other, is_odd, reference))) ++local_mismatches;
+                if (!same(adsb::cpr::local_position(other, cpr, is_odd, reference),
+                          reference_local(other, cpr, is_odd, reference))) ++local_mismatches;
+            }
+        }
+    }
+    ADSB_CHECK(local_mismatches == 0);
+
+    return adsb::test::result();
+}
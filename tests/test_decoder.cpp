@@ -0,0 +1,170 @@
+#include "check.hpp"
+
+#include "adsb/decoder.hpp"
+#include "adsb/encoder.hpp"
+#include "adsb/message/IdentificationMessage.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace {
+
+    using adsb::decoder::downlink_format_bit;
+    using adsb::decoder::type_code_bit;
+
+    // Identification (TC 4) of 4840D6
+    constexpr uint8_t IDENTIFICATION[14] = {0x8D, 0x48, 0x40, 0xD6, 0x20, 0x2C, 0xC3,
+                                            0x71, 0xC3, 0x2C, 0xE0, 0x57, 0x60, 0x98};
+    constexpr uint32_t ICAO = 0x4840D6;
+
+    /// DF4 altitude reply of `icao`, the address XORed into the parity.
+    void make_surveillance(uint32_t icao, uint8_t* frame) {
+        const uint8_t head[4] = {4 << 3, 0x00, 0x18, 0x38};
+        for (int i = 0; i < 4; ++i) frame[i] = head[i];
+        adsb::encoder::set_parity(frame, adsb::types::SHORT_FRAME_BYTES, icao);
+    }
+
+    /// DF11 all-call reply of `icao`.
+    void make_all_call(uint32_t icao, uint8_t* frame) {
+        adsb::message::AllCallData data{};
+        data.icao = icao;
+        data.capability = 5;
+        adsb::encoder::encode(data, frame);
+    }
+
+    bool decodes_surveillance(const uint8_t* frame, const adsb::decoder::DecoderOptions& options, uint32_t icao) {
+        adsb::message::MessageData data;
+        if (!adsb::decoder::decode_into(frame, adsb::types::SHORT_FRAME_BYTES, data, options)) return false;
+        const auto* reply = std::get_if<adsb::message::SurveillanceData>(&data);
+        return reply != nullptr && reply->icao == icao;
+    }
+
+}
+
+int main() {
+    uint8_t surveillance[adsb::types::SHORT_FRAME_BYTES];
+    make_surveillance(ICAO, surveillance);
+
+    // Without a confirmation, surveillance replies are dropped
+    {
+        adsb::decoder::IcaoSet known;
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        ADSB_CHECK(!decodes_surveillance(surveillance, options, ICAO));
+        ADSB_CHECK(adsb::decoder::decode(IDENTIFICATION, sizeof(IDENTIFICATION), options) != nullptr);
+        ADSB_CHECK(decodes_surveillance(surveillance, options, ICAO));
+    }
+
+    // A repaired DF17 frame is decoded but does not confirm its address: it may be corrected noise
+    {
+        adsb::decoder::IcaoSet known;
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        options.error_correction = adsb::crc::ErrorCorrection::TWO_BIT;
+        uint8_t damaged[sizeof(IDENTIFICATION)];
+        std::copy(std::begin(IDENTIFICATION), std::end(IDENTIFICATION), damaged);
+        damaged[6] ^= 0x10;
+        ADSB_CHECK(adsb::decoder::decode(damaged, sizeof(damaged), options) != nullptr);
+        damaged[9] ^= 0x01;
+        ADSB_CHECK(adsb::decoder::decode(damaged, sizeof(damaged), options) != nullptr);
+        ADSB_CHECK(!known.contains(ICAO));
+        ADSB_CHECK(!decodes_surveillance(surveillance, options, ICAO));
+    }
+
+    // A DF17 frame confirms its address even if the downlink format filter rejects it
+    {
+        adsb::decoder::IcaoSet known;
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        options.downlink_format_mask = downlink_format_bit(4);
+        ADSB_CHECK(adsb::decoder::decode(IDENTIFICATION, sizeof(IDENTIFICATION), options) == nullptr);
+        ADSB_CHECK(decodes_surveillance(surveillance, options, ICAO));
+
+        uint8_t other[adsb::types::SHORT_FRAME_BYTES];
+        make_surveillance(0xABCDEF, other);
+        ADSB_CHECK(!decodes_surveillance(other, options, 0xABCDEF));
+    }
+
+    // ... or the type code filter
+    {
+        adsb::decoder::IcaoSet known;
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        options.type_code_mask = type_code_bit(19);
+        ADSB_CHECK(adsb::decoder::decode(IDENTIFICATION, sizeof(IDENTIFICATION), options) == nullptr);
+        ADSB_CHECK(decodes_surveillance(surveillance, options, ICAO));
+    }
+
+    // A DF11 reply confirms its address with a DF4-only mask as well
+    {
+        adsb::decoder::IcaoSet known;
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        options.downlink_format_mask = downlink_format_bit(4);
+        uint8_t all_call[adsb::types::LONG_FRAME_BYTES];
+        make_all_call(0x3C6586, all_call);
+        ADSB_CHECK(adsb::decoder::decode(all_call, adsb::types::SHORT_FRAME_BYTES, options) == nullptr);
+
+        uint8_t reply[adsb::types::SHORT_FRAME_BYTES];
+        make_surveillance(0x3C6586, reply);
+        ADSB_CHECK(decodes_surveillance(reply, options, 0x3C6586));
+    }
+
+    // decode_visit() with a visitor for surveillance replies only
+    {
+        adsb::decoder::IcaoSet known;
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        uint32_t visited = 0;
+        auto visitor = [&](const adsb::message::SurveillanceData& reply) { visited = reply.icao; };
+        ADSB_CHECK(!adsb::decoder::decode_visit(IDENTIFICATION, sizeof(IDENTIFICATION), visitor, options));
+        ADSB_CHECK(adsb::decoder::decode_visit(surveillance, sizeof(surveillance), visitor, options));
+        ADSB_CHECK(visited == ICAO);
+    }
+
+    // Confirmations expire after the time-to-live, on the clock passed to advance()
+    {
+        adsb::decoder::IcaoSet known(64, std::chrono::seconds(60));
+        adsb::decoder::DecoderOptions options;
+        options.known_aircraft = &known;
+        const adsb::types::Timestamp start = adsb::types::from_nanoseconds(1000000000000);
+        known.advance(start);
+        ADSB_CHECK(adsb::decoder::decode(IDENTIFICATION, sizeof(IDENTIFICATION), options) != nullptr);
+        known.advance(start + std::chrono::seconds(60));
+        ADSB_CHECK(decodes_surveillance(surveillance, options, ICAO));
+        known.advance(start + std::chrono::seconds(61));
+        ADSB_CHECK(!decodes_surveillance(surveillance, options, ICAO));
+
+        // A clock a little behind, e.g. on another thread, still sees a fresh confirmation
+        known.advance(start + std::chrono::seconds(200));
+        ADSB_CHECK(adsb::decoder::decode(IDENTIFICATION, sizeof(IDENTIFICATION), options) != nullptr);
+        known.advance(start + std::chrono::seconds(195));
+        ADSB_CHECK(decodes_surveillance(surveillance, options, ICAO));
+    }
+
+    // Several threads may read the fields of one message; the first reader decodes them
+    {
+        for (int round = 0; round < 100; ++round) {
+            const auto message = adsb::decoder::decode(IDENTIFICATION, sizeof(IDENTIFICATION));
+            const auto* identification = dynamic_cast<const adsb::message::IdentificationMessage*>(message.get());
+            ADSB_CHECK(identification != nullptr);
+            if (identification == nullptr) break;
+
+            std::string names[4];
+            std::vector<std::thread> readers;
+            for (std::string& name : names) {
+                readers.emplace_back([identification, &name] { name = identification->get_flight_name(); });
+            }
+            for (std::thread& reader : readers) reader.join();
+            for (const std::string& name : names) ADSB_CHECK(name == "KLM1023");
+        }
+    }
+
+    return adsb::test::result();
+}
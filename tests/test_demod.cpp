@@ -0,0 +1,146 @@
+#include "check.hpp"
+
+#include "adsb/demod.hpp"
+#include "adsb/simulator.hpp"
+#include "adsb/stream.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    constexpr unsigned TICKS_PER_CHIP = 6;             // 12 MHz ticks per half-bit chip
+    constexpr uint64_t FRAME_TICKS = TICKS_PER_CHIP * (16 + 2 * 112);
+
+    /**
+     * @struct Recording
+     * @brief Synthesized I/Q recording and the frames it contains.
+     */
+    struct Recording {
+        std::vector<uint8_t> samples;
+        std::vector<adsb::simulator::Frame> frames;
+        std::vector<uint64_t> start_ticks;
+    };
+
+    /**
+     * @brief Modulates frames into I/Q samples like a receiver front end would record them.
+     *
+     * Every sample integrates the pulse envelope over its period, so a frame starting between two samples
+     * spreads its chips over both. Frames start at every sub-sample offset; the carrier phase drifts and
+     * Gaussian noise is added to I and Q.
+     */
+    Recording record(const std::vector<adsb::simulator::Frame>& frames, adsb::demod::SampleRate rate,
+                     adsb::demod::SampleFormat format, double amplitude, double noise) {
+        const unsigned ticks_per_sample = rate == adsb::demod::SampleRate::MSPS_2_4 ? 5 : 6;
+        Recording recording;
+        recording.frames = frames;
+
+        // Envelope on the 12 MHz grid
+        std::vector<uint8_t> envelope;
+        uint64_t tick = 1000;
+        for (std::size_t n = 0; n < frames.size(); ++n) {
+            tick += 300 + (n * 7) % 61;               // Covers every offset modulo 5 and 6 ticks
+            recording.start_ticks.push_back(tick);
+            envelope.resize(tick + FRAME_TICKS, 0);
+            auto chip = [&](unsigned index) {
+                std::fill_n(envelope.begin() + static_cast<long>(tick + TICKS_PER_CHIP * index), TICKS_PER_CHIP, 1);
+            };
+            for (unsigned index : {0u, 2u, 7u, 9u}) chip(index);
+            for (unsigned bit = 0; bit < 8 * frames[n].length; ++bit) {
+                const bool one = (frames[n].data[bit / 8] >> (7 - bit % 8)) & 1;
+                chip(16 + 2 * bit + (one ? 0 : 1));
+            }
+            tick += FRAME_TICKS;
+        }
+        envelope.resize(envelope.size() + 1000, 0);
+
+        std::mt19937 random(42);
+        std::normal_distribution<double> gaussian(0.0, noise);
+        const double full_scale = format == adsb::demod::SampleFormat::UC8 ? 127.0 : 32767.0;
+        double phase = 0.0;
+        for (std::size_t start = 0; start + ticks_per_sample <= envelope.size(); start += ticks_per_sample) {
+            unsigned high = 0;
+            for (unsigned t = 0; t < ticks_per_sample; ++t) high += envelope[start + t];
+            const double magnitude = amplitude * high / ticks_per_sample;
+            phase += 0.3;
+            const double i = (magnitude * std::cos(phase) + gaussian(random)) * full_scale;
+            const double q = (magnitude * std::sin(phase) + gaussian(random)) * full_scale;
+            if (format == adsb::demod::SampleFormat::UC8) {
+                recording.samples.push_back(static_cast<uint8_t>(std::clamp(std::lround(127.5 + i), 0L, 255L)));
+                recording.samples.push_back(static_cast<uint8_t>(std::clamp(std::lround(127.5 + q), 0L, 255L)));
+            } else {
+                for (double value : {i, q}) {
+                    const auto word = static_cast<uint16_t>(std::clamp(std::lround(value), -32768L, 32767L));
+                    recording.samples.push_back(static_cast<uint8_t>(word & 0xFF));
+                    recording.samples.push_back(static_cast<uint8_t>(word >> 8));
+                }
+            }
+        }
+        return recording;
+    }
+
+    /// Writes the recording to a file and demodulates it from a memory map, in blocks of an odd size.
+    void check_recording(const Recording& recording, const adsb::demod::DemodulatorOptions& options, const char* name) {
+        const std::string path = std::string("test_demod_") + name + ".iq";
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        ADSB_CHECK(file != nullptr);
+        if (file == nullptr) return;
+        std::fwrite(recording.samples.data(), 1, recording.samples.size(), file);
+        std::fclose(file);
+
+        adsb::stream::MappedFile mapped;
+        ADSB_CHECK(mapped.open(path));
+        std::vector<adsb::demod::DemodFrame> found;
+        adsb::demod::Demodulator demodulator(options);
+        constexpr std::size_t BLOCK_BYTES = 16381;
+        for (std::size_t offset = 0; offset < mapped.size(); offset += BLOCK_BYTES) {
+            demodulator.process(mapped.data() + offset, std::min(BLOCK_BYTES, mapped.size() - offset),
+                                [&](const adsb::demod::DemodFrame& frame) { found.push_back(frame); });
+        }
+        mapped.close();
+        std::remove(path.c_str());
+
+        std::size_t matched = 0;
+        for (std::size_t n = 0, k = 0; n < recording.frames.size() && k < found.size(); ++n) {
+            const auto& expected = recording.frames[n];
+            if (!std::equal(expected.data, expected.data + expected.length, found[k].data)) continue;
+            // Timestamps are accurate to a fraction of a chip
+            const int64_t error = static_cast<int64_t>(found[k].mlat_ticks) - static_cast<int64_t>(recording.start_ticks[n]);
+            ADSB_CHECK(error >= -3 && error <= 3);
+            ++matched;
+            ++k;
+        }
+        if (matched != recording.frames.size() || found.size() != recording.frames.size()) {
+            std::fprintf(stderr, "  %s: %zu of %zu frames, %zu reported\n", name, matched, recording.frames.size(),
+                         found.size());
+        }
+        ADSB_CHECK(matched == recording.frames.size());
+        ADSB_CHECK(found.size() == recording.frames.size());
+    }
+
+}
+
+int main() {
+    adsb::simulator::SimulatorOptions simulator_options;
+    simulator_options.aircraft = 50;
+    adsb::simulator::TrafficSimulator simulator(simulator_options);
+    const auto frames = simulator.generate(300);
+
+    for (auto rate : {adsb::demod::SampleRate::MSPS_2_0, adsb::demod::SampleRate::MSPS_2_4}) {
+        const char* rate_name = rate == adsb::demod::SampleRate::MSPS_2_4 ? "2.4" : "2.0";
+        for (auto format : {adsb::demod::SampleFormat::UC8, adsb::demod::SampleFormat::SC16}) {
+            adsb::demod::DemodulatorOptions options;
+            options.sample_rate = rate;
+            options.format = format;
+            const std::string name = std::string(rate_name) + (format == adsb::demod::SampleFormat::UC8 ? "_uc8" : "_sc16");
+            check_recording(record(frames, rate, format, 0.5, 0.02), options, name.c_str());
+        }
+    }
+
+    return adsb::test::result();
+}
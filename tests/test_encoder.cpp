@@ -0,0 +1,243 @@
+#include "check.hpp"
+
+#include "adsb/cpr.hpp"
+#include "adsb/crc.hpp"
+#include "adsb/decoder.hpp"
+#include "adsb/encoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <string_view>
+#include <variant>
+
+namespace {
+
+    using adsb::message::EmitterCategory;
+
+    /// Encodes a message into a frame and decodes it again; std::monostate if either step fails.
+    adsb::message::MessageData round_trip(const adsb::message::MessageData& data) {
+        uint8_t frame[adsb::types::LONG_FRAME_BYTES];
+        const std::size_t length = adsb::encoder::encode(data, frame);
+        if (length == 0) return {};
+        return adsb::decoder::decode_value(frame, length);
+    }
+
+    double heading_difference(double a, double b) {
+        const double difference = std::fabs(a - b);
+        return difference > 180.0 ? 360.0 - difference : difference;
+    }
+
+    void check_identification() {
+        struct Case {
+            int type_code;
+            EmitterCategory category;
+            std::string_view callsign;
+        };
+        const Case cases[] = {
+            {1, EmitterCategory::HEAVY, "KLM1023"},
+            {1, EmitterCategory::NO_INFO_A, "A"},
+            {2, EmitterCategory::GLIDER_SAILPLANE, "D EKXY"},
+            {3, EmitterCategory::SURFACE_SERVICE_VEHICLE, "TUG 12"},
+            {3, EmitterCategory::LINE_OBSTACLE, "12345678"},
+        };
+        for (const Case& c : cases) {
+            adsb::message::IdentificationData data{};
+            data.icao = 0x4840D6;
+            data.type_code = c.type_code;
+            data.category = c.category;
+            data.callsign_length = static_cast<uint8_t>(c.callsign.size());
+            c.callsign.copy(data.callsign, c.callsign.size());
+
+            const auto decoded = round_trip(data);
+            const auto* identification = std::get_if<adsb::message::IdentificationData>(&decoded);
+            ADSB_CHECK(identification != nullptr);
+            if (identification == nullptr) continue;
+            ADSB_CHECK(identification->icao == data.icao);
+            ADSB_CHECK(identification->type_code == c.type_code);
+            ADSB_CHECK(identification->category == c.category);
+            ADSB_CHECK(identification->flight_name() == c.callsign);
+            ADSB_CHECK(identification->callsign_key == adsb::message::pack_callsign(c.callsign));
+        }
+    }
+
+    void check_position(std::mt19937_64& rng) {
+        std::uniform_real_distribution<double> latitude(-85.0, 85.0);
+        std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+        std::uniform_int_distribution<int> altitude(-1000, 50175);
+        // One CPR unit of the even latitude zone; longitude units are never larger than latitude units below 85°
+        const double resolution = 360.0 / 60.0 / adsb::cpr::CPR_MAX;
+
+        for (int i = 0; i < 2000; ++i) {
+            const double lat = latitude(rng);
+            const double lon = longitude(rng);
+            adsb::message::AirbornePositionData frames[2];
+            bool complete = true;
+            for (int odd = 0; odd < 2; ++odd) {
+                adsb::message::AirbornePositionData data{};
+                data.icao = 0x3C6586;
+                data.type_code = 11;
+                data.surveillance_status = i % 4;
+                data.nic_supplement_b = i % 2;
+                data.altitude = altitude(rng);
+                data.time_utc_sync = i % 3 == 0;
+                data.is_odd = odd == 1;
+                const adsb::cpr::EncodedPosition encoded = adsb::cpr::encode(lat, lon, data.is_odd);
+                data.cpr_lat = encoded.cpr_lat;
+                data.cpr_lon = encoded.cpr_lon;
+
+                const auto decoded = round_trip(data);
+                const auto* position = std::get_if<adsb::message::AirbornePositionData>(&decoded);
+                ADSB_CHECK(position != nullptr);
+                if (position == nullptr) {
+                    complete = false;
+                    continue;
+                }
+                ADSB_CHECK(position->icao == data.icao);
+                ADSB_CHECK(position->type_code == data.type_code);
+                ADSB_CHECK(position->surveillance_status == data.surveillance_status);
+                ADSB_CHECK(position->nic_supplement_b == data.nic_supplement_b);
+                ADSB_CHECK(position->time_utc_sync == data.time_utc_sync);
+                ADSB_CHECK(position->is_odd == data.is_odd);
+                ADSB_CHECK(position->cpr_lat == data.cpr_lat && position->cpr_lon == data.cpr_lon);
+                ADSB_CHECK(std::abs(position->altitude - data.altitude) <= 12);      // 25 ft steps
+                frames[odd] = *position;
+            }
+            if (!complete) continue;
+
+            const auto now = adsb::types::from_nanoseconds(1000000000);
+            const auto result = adsb::decoder::calculate_global_position(frames[0], now, frames[1], now,
+                                                                         adsb::types::GlobalPosition{});
+            ADSB_CHECK(result.is_valid);
+            ADSB_CHECK(std::fabs(result.position.latitude - lat) <= resolution);
+            double lon_error = std::fabs(result.position.longitude - lon);
+            if (lon_error > 180.0) lon_error = 360.0 - lon_error;
+            ADSB_CHECK(lon_error <= resolution / std::cos(lat * M_PI / 180.0));
+        }
+    }
+
+    void check_velocity(std::mt19937_64& rng) {
+        std::uniform_real_distribution<double> speed(10.0, 600.0);
+        std::uniform_real_distribution<double> heading(0.0, 360.0);
+        std::uniform_int_distribution<int> vertical_rate(-6000, 6000);
+
+        for (int i = 0; i < 2000; ++i) {
+            adsb::message::VelocityData data{};
+            data.icao = 0xABCDEF;
+            data.type_code = 19;
+            data.speed = speed(rng);
+            data.heading = heading(rng);
+            data.vertical_rate = vertical_rate(rng);
+
+            const auto decoded = round_trip(data);
+            const auto* velocity = std::get_if<adsb::message::VelocityData>(&decoded);
+            ADSB_CHECK(velocity != nullptr);
+            if (velocity == nullptr) continue;
+            ADSB_CHECK(velocity->icao == data.icao);
+            // Both components are rounded to 1 kn, the vertical rate to 64 ft/min
+            ADSB_CHECK(std::fabs(velocity->speed - data.speed) <= 0.71);
+            ADSB_CHECK(heading_difference(velocity->heading, data.heading)
+                       <= std::asin(0.71 / data.speed) * 180.0 / M_PI + 1e-9);
+            ADSB_CHECK(std::abs(velocity->vertical_rate - data.vertical_rate) <= 32);
+        }
+
+        // Values beyond the field ranges are limited to the largest encodable ones
+        adsb::message::VelocityData fast{};
+        fast.type_code = 19;
+        fast.speed = 5000.0;
+        fast.heading = 0.0;
+        fast.vertical_rate = -100000;
+        const auto decoded = round_trip(fast);
+        const auto* velocity = std::get_if<adsb::message::VelocityData>(&decoded);
+        ADSB_CHECK(velocity != nullptr);
+        if (velocity != nullptr) {
+            ADSB_CHECK(velocity->speed == 1022.0);
+            ADSB_CHECK(velocity->vertical_rate == -32640);
+        }
+    }
+
+    void check_all_call() {
+        for (int interrogator : {0, 1, 42, 127}) {
+            const adsb::message::AllCallData data{0x3C6586, adsb::encoder::CAPABILITY_AIRBORNE, interrogator};
+            const auto decoded = round_trip(data);
+            const auto* reply = std::get_if<adsb::message::AllCallData>(&decoded);
+            ADSB_CHECK(reply != nullptr);
+            if (reply == nullptr) continue;
+            ADSB_CHECK(reply->icao == data.icao);
+            ADSB_CHECK(reply->capability == data.capability);
+            ADSB_CHECK(reply->interrogator == interrogator);
+        }
+    }
+
+    void check_altitude() {
+        // 25 ft encoding up to 50175 ft, Gillham 100 ft encoding above
+        for (int feet = -1000; feet <= 126700; ++feet) {
+            const int code = adsb::message::encode_altitude(feet);
+            ADSB_CHECK(code != 0);
+            const int decoded = adsb::message::decode_altitude(code);
+            ADSB_CHECK(std::abs(decoded - feet) <= (feet <= 50175 ? 12 : 50));
+        }
+        ADSB_CHECK(adsb::message::encode_altitude(-1001) == 0);
+        ADSB_CHECK(adsb::message::encode_altitude(126751) == 0);
+        ADSB_CHECK(adsb::message::encode_altitude(adsb::message::INVALID_ALTITUDE) == 0);
+        ADSB_CHECK(adsb::message::decode_altitude(0) == adsb::message::INVALID_ALTITUDE);
+
+        // Every valid code decodes to an altitude that encodes to a code of the same altitude; Gillham codes
+        // also reach -1200 and -1100 ft, below the range the encoder produces
+        for (int code = 1; code < 4096; ++code) {
+            const int feet = adsb::message::decode_altitude(code);
+            if (feet == adsb::message::INVALID_ALTITUDE || feet < -1000) continue;
+            ADSB_CHECK(adsb::message::decode_altitude(adsb::message::encode_altitude(feet)) == feet);
+        }
+    }
+
+    void check_parity(std::mt19937_64& rng) {
+        for (int i = 0; i < 1000; ++i) {
+            for (std::size_t length : {adsb::types::SHORT_FRAME_BYTES, adsb::types::LONG_FRAME_BYTES}) {
+                uint8_t frame[adsb::types::LONG_FRAME_BYTES];
+                for (uint8_t& byte : frame) byte = static_cast<uint8_t>(rng());
+                adsb::encoder::set_parity(frame, length);
+                ADSB_CHECK(adsb::crc::syndrome(frame, length) == 0);
+
+                const uint32_t overlay = static_cast<uint32_t>(rng()) & 0xFFFFFF;
+                adsb::encoder::set_parity(frame, length, overlay);
+                ADSB_CHECK(adsb::crc::syndrome(frame, length) == overlay);
+            }
+        }
+    }
+
+    void check_bit_errors(std::mt19937_64& rng) {
+        uint8_t original[adsb::types::LONG_FRAME_BYTES];
+        for (uint8_t& byte : original) byte = static_cast<uint8_t>(rng());
+
+        adsb::encoder::BitErrorInjector clean(0.0, 1);
+        adsb::encoder::BitErrorInjector all(1.0, 1);
+        for (int i = 0; i < 1000; ++i) {
+            uint8_t frame[adsb::types::LONG_FRAME_BYTES];
+            std::copy(std::begin(original), std::end(original), frame);
+            ADSB_CHECK(clean.apply(frame, sizeof(frame)) == 0);
+            ADSB_CHECK(std::equal(std::begin(original), std::end(original), frame));
+
+            ADSB_CHECK(all.apply(frame, sizeof(frame)) == 8 * sizeof(frame));
+            for (std::size_t byte = 0; byte < sizeof(frame); ++byte) {
+                ADSB_CHECK(frame[byte] == static_cast<uint8_t>(~original[byte]));
+            }
+        }
+    }
+
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    check_identification();
+    check_position(rng);
+    check_velocity(rng);
+    check_all_call();
+    check_altitude();
+    check_parity(rng);
+    check_bit_errors(rng);
+    return adsb::test::result();
+}
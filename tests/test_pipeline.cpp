@@ -0,0 +1,130 @@
+#include "check.hpp"
+
+#include "adsb/encoder.hpp"
+#include "adsb/pipeline.hpp"
+#include "adsb/simulator.hpp"
+#include "adsb/utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+    adsb::pipeline::PipelineStats run(const std::vector<adsb::simulator::Frame>& frames, std::size_t workers,
+                                      std::vector<std::size_t>& tracked) {
+        adsb::pipeline::PipelineOptions options;
+        options.workers = workers;
+        options.overflow = adsb::pipeline::OverflowPolicy::BLOCK;
+        adsb::pipeline::Pipeline pipeline(options);
+        adsb::pipeline::Pipeline::Source source = pipeline.source(0);
+        for (const auto& frame : frames) source.push(frame.data, frame.length, adsb::types::from_mlat_ticks(frame.mlat_ticks));
+        pipeline.stop();
+
+        tracked.clear();
+        for (std::size_t i = 0; i < pipeline.workers(); ++i) tracked.push_back(pipeline.shard(i).size());
+        return pipeline.stats();
+    }
+
+}
+
+int main() {
+    adsb::simulator::SimulatorOptions options;
+    options.aircraft = 200;
+    adsb::simulator::TrafficSimulator simulator(options);
+    const auto frames = simulator.generate(20000);
+
+    std::vector<std::size_t> tracked;
+    const auto single = run(frames, 1, tracked);
+    ADSB_CHECK(single.received == frames.size());
+    ADSB_CHECK(tracked.size() == 1 && tracked[0] == 200);
+
+    // One source still feeds every worker, and the result does not depend on the number of workers
+    for (std::size_t workers : {2, 4}) {
+        const auto stats = run(frames, workers, tracked);
+        ADSB_CHECK(stats.received == single.received);
+        ADSB_CHECK(stats.decoded == single.decoded);
+        ADSB_CHECK(stats.updates == single.updates);
+        std::size_t total = 0;
+        for (std::size_t count : tracked) {
+            ADSB_CHECK(count > 0);
+            total += count;
+        }
+        ADSB_CHECK(total == 200);
+    }
+
+    // Mixed short and long frames, with surveillance replies that need a confirmed address: the batched CRC
+    // gives the same result as decoding every frame on its own
+    {
+        std::vector<adsb::simulator::Frame> mixed;
+        for (std::size_t i = 0; i < 4000; ++i) {
+            const adsb::simulator::Frame& frame = frames[i];
+            mixed.push_back(frame);
+            const uint32_t icao = static_cast<uint32_t>(adsb::utils::load_be(frame.data + 1, 3));
+            adsb::simulator::Frame extra = frame;
+            if (i % 3 == 0) {
+                extra.length = static_cast<uint8_t>(adsb::encoder::encode(
+                    adsb::message::AllCallData{icao, adsb::encoder::CAPABILITY_AIRBORNE, 0}, extra.data));
+                mixed.push_back(extra);
+            } else if (i % 3 == 1) {
+                const uint8_t head[4] = {4 << 3, 0x00, 0x18, 0x38};
+                std::copy(head, head + 4, extra.data);
+                extra.length = adsb::types::SHORT_FRAME_BYTES;
+                adsb::encoder::set_parity(extra.data, extra.length, icao);
+                mixed.push_back(extra);
+            }
+        }
+
+        adsb::decoder::IcaoSet reference_known;
+        adsb::decoder::DecoderOptions reference_options;
+        reference_options.known_aircraft = &reference_known;
+        uint64_t expected = 0;
+        adsb::message::MessageData data;
+        for (const auto& frame : mixed) {
+            reference_known.advance(adsb::types::from_mlat_ticks(frame.mlat_ticks));
+            expected += adsb::decoder::decode_into(frame.data, frame.length, data, reference_options) ? 1 : 0;
+        }
+        ADSB_CHECK(expected == mixed.size());
+
+        for (std::size_t workers : {1, 3}) {
+            adsb::decoder::IcaoSet known;
+            adsb::pipeline::PipelineOptions pipeline_options;
+            pipeline_options.workers = workers;
+            pipeline_options.overflow = adsb::pipeline::OverflowPolicy::BLOCK;
+            pipeline_options.decoder.known_aircraft = &known;
+            adsb::pipeline::Pipeline pipeline(pipeline_options);
+            adsb::pipeline::Pipeline::Source source = pipeline.source(0);
+            for (const auto& frame : mixed) {
+                source.push(frame.data, frame.length, adsb::types::from_mlat_ticks(frame.mlat_ticks));
+            }
+            pipeline.stop();
+            ADSB_CHECK(pipeline.stats().decoded == expected);
+        }
+    }
+
+    // The workers age the confirmed addresses by the frame timestamps
+    {
+        adsb::decoder::IcaoSet known(64, std::chrono::seconds(60));
+        adsb::pipeline::PipelineOptions pipeline_options;
+        pipeline_options.workers = 2;
+        pipeline_options.overflow = adsb::pipeline::OverflowPolicy::BLOCK;
+        pipeline_options.decoder.known_aircraft = &known;
+        adsb::pipeline::Pipeline pipeline(pipeline_options);
+        adsb::pipeline::Pipeline::Source source = pipeline.source(0);
+
+        const uint8_t identification[14] = {0x8D, 0x48, 0x40, 0xD6, 0x20, 0x2C, 0xC3,
+                                            0x71, 0xC3, 0x2C, 0xE0, 0x57, 0x60, 0x98};
+        uint8_t reply[adsb::types::SHORT_FRAME_BYTES] = {4 << 3, 0x00, 0x18, 0x38};
+        adsb::encoder::set_parity(reply, sizeof(reply), 0x4840D6);
+
+        const adsb::types::Timestamp start = adsb::types::from_nanoseconds(0);
+        source.push(identification, sizeof(identification), start);
+        source.push(reply, sizeof(reply), start + std::chrono::seconds(30));      // Confirmed
+        source.push(reply, sizeof(reply), start + std::chrono::seconds(120));     // Expired
+        pipeline.stop();
+        ADSB_CHECK(pipeline.stats().decoded == 2);
+    }
+
+    return adsb::test::result();
+}
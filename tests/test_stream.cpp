@@ -0,0 +1,142 @@
+#include "check.hpp"
+
+#include "adsb/simulator.hpp"
+#include "adsb/stream.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /// Beast stream of the frames; a timestamp containing 0x1A bytes exercises the escaping.
+    std::vector<uint8_t> to_beast(const std::vector<adsb::simulator::Frame>& frames) {
+        std::vector<uint8_t> out;
+        auto put = [&out](uint8_t byte) {
+            out.push_back(byte);
+            if (byte == adsb::stream::BeastFormat::ESCAPE) out.push_back(byte);
+        };
+        for (const auto& frame : frames) {
+            out.push_back(adsb::stream::BeastFormat::ESCAPE);
+            out.push_back('3');
+            const uint64_t ticks = (frame.mlat_ticks & ~0xFF00ULL) | 0x1A00;
+            for (int i = 5; i >= 0; --i) put(static_cast<uint8_t>(ticks >> (8 * i)));
+            put(0x1A);                  // Signal level
+            for (std::size_t i = 0; i < frame.length; ++i) put(frame.data[i]);
+        }
+        return out;
+    }
+
+    std::vector<uint8_t> to_avr(const std::vector<adsb::simulator::Frame>& frames) {
+        std::string out;
+        char line[48];
+        for (const auto& frame : frames) {
+            int n = std::snprintf(line, sizeof(line), "@%012llX",
+                                  static_cast<unsigned long long>(frame.mlat_ticks & 0xFFFFFFFFFFFFULL));
+            for (std::size_t i = 0; i < frame.length; ++i) {
+                n += std::snprintf(line + n, sizeof(line) - static_cast<std::size_t>(n), "%02X", frame.data[i]);
+            }
+            out.append(line, static_cast<std::size_t>(n));
+            out += ";\r\n";
+        }
+        return {out.begin(), out.end()};
+    }
+
+    /// Feeds the stream in chunks ending at the given offsets and returns the frames seen.
+    template <typename Parser>
+    std::vector<adsb::stream::FrameView> feed_split(const std::vector<uint8_t>& stream,
+                                                    const std::vector<std::size_t>& cuts,
+                                                    std::vector<std::vector<uint8_t>>& copies) {
+        Parser parser;
+        std::vector<adsb::stream::FrameView> frames;
+        copies.clear();
+        std::size_t begin = 0;
+        auto on_frame = [&](const adsb::stream::FrameView& view) {
+            copies.emplace_back(view.data, view.data + view.length);
+            frames.push_back(view);
+        };
+        for (std::size_t cut : cuts) {
+            parser.feed(stream.data() + begin, cut - begin, on_frame);
+            begin = cut;
+        }
+        parser.feed(stream.data() + begin, stream.size() - begin, on_frame);
+        return frames;
+    }
+
+    /// Splitting the stream anywhere must yield exactly the frames of an unsplit feed.
+    template <typename Parser>
+    void check_splits(const std::vector<uint8_t>& stream, std::size_t expected) {
+        std::vector<std::vector<uint8_t>> whole;
+        const auto reference = feed_split<Parser>(stream, {}, whole);
+        ADSB_CHECK(reference.size() == expected);
+
+        std::vector<std::vector<uint8_t>> copies;
+        for (std::size_t cut = 0; cut <= stream.size(); ++cut) {
+            const auto frames = feed_split<Parser>(stream, {cut}, copies);
+            ADSB_CHECK(frames.size() == reference.size());
+            if (frames.size() != reference.size()) {
+                std::fprintf(stderr, "  split at %zu: %zu frames instead of %zu\n", cut, frames.size(), reference.size());
+                continue;
+            }
+            for (std::size_t i = 0; i < frames.size(); ++i) {
+                ADSB_CHECK(copies[i] == whole[i]);
+                ADSB_CHECK(frames[i].mlat_ticks == reference[i].mlat_ticks);
+            }
+        }
+
+        // Several small chunks: messages cross more than one boundary
+        for (std::size_t step : {1, 3, 7, 17}) {
+            std::vector<std::size_t> cuts;
+            for (std::size_t cut = step; cut < stream.size(); cut += step) cuts.push_back(cut);
+            ADSB_CHECK(feed_split<Parser>(stream, cuts, copies).size() == reference.size());
+            ADSB_CHECK(copies == whole);
+        }
+    }
+
+}
+
+int main() {
+    adsb::simulator::SimulatorOptions options;
+    options.aircraft = 20;
+    adsb::simulator::TrafficSimulator simulator(options);
+    const auto frames = simulator.generate(100);
+
+    check_splits<adsb::stream::BeastParser>(to_beast(frames), frames.size());
+    check_splits<adsb::stream::AvrParser>(to_avr(frames), frames.size());
+
+    // Truncated messages and malformed lines in between. A chunk ending right after the escape byte that
+    // cuts a long truncated message short carries both over, and the next message then starts so late in
+    // the carry buffer that it is only completed by the rest of the following chunk.
+    adsb::simulator::Frame escapes{};
+    std::fill(std::begin(escapes.data), std::end(escapes.data), adsb::stream::BeastFormat::ESCAPE);
+    escapes.length = adsb::types::LONG_FRAME_BYTES;
+    escapes.mlat_ticks = 0x1A1A1A1A1A1AULL;
+    const auto long_message = to_beast({escapes});
+
+    std::vector<uint8_t> truncated;
+    std::vector<uint8_t> malformed;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const std::vector<adsb::simulator::Frame> one = {frames[i]};
+        const auto beast_one = to_beast(one);
+        const auto avr_one = to_avr(one);
+        if (i % 3 == 0) truncated.insert(truncated.end(), long_message.begin(), long_message.begin() + 40);
+        if (i % 3 == 0) {
+            const std::string line = "*0123456789ABCDEF0123456789;\r\n";
+            malformed.insert(malformed.end(), line.begin(), line.end());
+        }
+        truncated.insert(truncated.end(), beast_one.begin(), beast_one.end());
+        malformed.insert(malformed.end(), avr_one.begin(), avr_one.end());
+    }
+    check_splits<adsb::stream::BeastParser>(truncated, frames.size());
+    check_splits<adsb::stream::AvrParser>(malformed, frames.size());
+
+    // Garbage in front of the first message is skipped
+    std::vector<uint8_t> noisy(40, 0x55);
+    const auto beast = to_beast(frames);
+    noisy.insert(noisy.end(), beast.begin(), beast.end());
+    check_splits<adsb::stream::BeastParser>(noisy, frames.size());
+
+    return adsb::test::result();
+}
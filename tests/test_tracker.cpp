@@ -0,0 +1,287 @@
+#include "check.hpp"
+
+#include "adsb/cpr.hpp"
+#include "adsb/decoder.hpp"
+#include "adsb/simulator.hpp"
+#include "adsb/tracker.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using namespace std::chrono_literals;
+
+    constexpr double MAX_POSITION_ERROR = 1e-4;     // Degrees; CPR resolution is about 5e-5 degrees of latitude
+
+    adsb::message::IdentificationData identification(uint32_t icao, const std::string& callsign) {
+        adsb::message::IdentificationData data{};
+        data.icao = icao;
+        data.type_code = 4;
+        data.category = adsb::message::EmitterCategory::NO_INFO_A;
+        data.callsign_length = static_cast<uint8_t>(callsign.size());
+        callsign.copy(data.callsign, callsign.size());
+        data.callsign_key = adsb::message::pack_callsign(callsign);
+        return data;
+    }
+
+    adsb::message::AirbornePositionData position(uint32_t icao, double lat, double lon, bool is_odd) {
+        adsb::message::AirbornePositionData data{};
+        data.icao = icao;
+        data.type_code = 11;
+        data.altitude = 35000;
+        data.is_odd = is_odd;
+        const adsb::cpr::EncodedPosition encoded = adsb::cpr::encode(lat, lon, is_odd);
+        data.cpr_lat = encoded.cpr_lat;
+        data.cpr_lon = encoded.cpr_lon;
+        return data;
+    }
+
+    std::vector<uint8_t> read_file(const std::string& path) {
+        std::vector<uint8_t> bytes;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) return bytes;
+        uint8_t buffer[4096];
+        for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) bytes.insert(bytes.end(), buffer, buffer + n);
+        std::fclose(file);
+        return bytes;
+    }
+
+    void write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) return;
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+    }
+
+    /// Replays simulated traffic and compares the tracked aircraft with the simulator's ground truth.
+    void check_replay(bool local_decoding) {
+        adsb::simulator::SimulatorOptions simulator_options;
+        simulator_options.aircraft = 200;
+        adsb::simulator::TrafficSimulator simulator(simulator_options);
+        const auto frames = simulator.generate(20000);
+
+        adsb::tracker::TrackerOptions options;
+        options.local_decoding = local_decoding;
+        adsb::tracker::AircraftTracker tracker(options);
+        for (const auto& frame : frames) {
+            const auto data = adsb::decoder::decode_value(frame.data, frame.length);
+            ADSB_CHECK(tracker.update(data, adsb::types::from_mlat_ticks(frame.mlat_ticks)) != nullptr);
+        }
+
+        ADSB_CHECK(tracker.size() == simulator.aircraft().size());
+        for (const auto& truth : simulator.aircraft()) {
+            const adsb::tracker::AircraftState* state = tracker.find(truth.icao);
+            ADSB_CHECK(state != nullptr);
+            if (state == nullptr) continue;
+            ADSB_CHECK(state->has_position);
+            ADSB_CHECK(std::fabs(state->position.latitude - truth.latitude) <= MAX_POSITION_ERROR);
+            ADSB_CHECK(std::fabs(state->position.longitude - truth.longitude) <= MAX_POSITION_ERROR);
+            ADSB_CHECK(std::abs(state->altitude - truth.altitude) <= 13.0);
+            ADSB_CHECK(tracker.find_by_callsign_key(truth.callsign_key) == state);
+        }
+    }
+
+    /// Single frames are placed by local decoding against the receiver, then against the last position.
+    void check_local_decoding() {
+        const adsb::types::GlobalPosition receiver = {52.0, 4.5, 0};
+        adsb::tracker::TrackerOptions options;
+        options.receiver = receiver;
+        options.receiver_range_nm = 150.0;
+        options.local_decoding = true;
+        adsb::tracker::AircraftTracker tracker(options);
+
+        const auto start = adsb::types::from_nanoseconds(0);
+        const adsb::tracker::AircraftState* state = tracker.update(position(0x484000, 52.8, 5.1, false), start);
+        ADSB_CHECK(state != nullptr && state->has_position);
+        if (state == nullptr) return;
+        ADSB_CHECK(std::fabs(state->position.latitude - 52.8) <= MAX_POSITION_ERROR);
+        ADSB_CHECK(std::fabs(state->position.longitude - 5.1) <= MAX_POSITION_ERROR);
+
+        // Another even frame: no pair, so only the local decode against the last position can move the aircraft
+        state = tracker.update(position(0x484000, 52.85, 5.2, false), start + 10s);
+        ADSB_CHECK(std::fabs(state->position.latitude - 52.85) <= MAX_POSITION_ERROR);
+        ADSB_CHECK(std::fabs(state->position.longitude - 5.2) <= MAX_POSITION_ERROR);
+
+        // About 250 NM away, out of receiver range, the first fix waits for a CPR pair
+        state = tracker.update(position(0x484001, 54.9, 9.4, false), start);
+        ADSB_CHECK(state != nullptr && !state->has_position);
+        state = tracker.update(position(0x484001, 54.91, 9.41, true), start + 1s);
+        ADSB_CHECK(state->has_position);
+        ADSB_CHECK(std::fabs(state->position.latitude - 54.91) <= MAX_POSITION_ERROR);
+        ADSB_CHECK(std::fabs(state->position.longitude - 9.41) <= MAX_POSITION_ERROR);
+    }
+
+    /// Removals in a crowded table shift entries back; every remaining aircraft must stay reachable.
+    void check_remove() {
+        adsb::tracker::TrackerOptions options;
+        options.capacity = 128;
+        adsb::tracker::AircraftTracker tracker(options);
+
+        std::mt19937 rng(7);
+        std::vector<uint32_t> icaos;
+        const auto now = adsb::types::from_nanoseconds(0);
+        while (icaos.size() < options.capacity) {
+            const uint32_t icao = rng() & 0xFFFFFF;
+            if (tracker.find(icao) != nullptr) continue;
+            ADSB_CHECK(tracker.update(identification(icao, "T" + std::to_string(icaos.size())), now) != nullptr);
+            icaos.push_back(icao);
+        }
+        ADSB_CHECK(tracker.update(identification(0xFFFFFE, "FULL"), now) == nullptr);
+
+        for (std::size_t i = 0; i < icaos.size(); i += 3) ADSB_CHECK(tracker.remove(icaos[i]));
+        ADSB_CHECK(!tracker.remove(icaos[0]));
+
+        for (std::size_t i = 0; i < icaos.size(); ++i) {
+            const std::string callsign = "T" + std::to_string(i);
+            const adsb::tracker::AircraftState* state = tracker.find(icaos[i]);
+            if (i % 3 == 0) {
+                ADSB_CHECK(state == nullptr);
+                ADSB_CHECK(tracker.find_by_callsign(callsign) == nullptr);
+                continue;
+            }
+            ADSB_CHECK(state != nullptr && state->icao == icaos[i]);
+            ADSB_CHECK(tracker.find_by_callsign(callsign) == state);
+            ADSB_CHECK(tracker.find_by_callsign(callsign + "  ") == state);
+        }
+        ADSB_CHECK(tracker.size() == icaos.size() - (icaos.size() + 2) / 3);
+
+        // A callsign taken over by another aircraft points to the latest one and survives removal of the first
+        const uint32_t first = icaos[1];
+        const uint32_t second = icaos[2];
+        tracker.update(identification(second, "T1"), now);
+        ADSB_CHECK(tracker.find_by_callsign("T1")->icao == second);
+        ADSB_CHECK(tracker.remove(first));
+        ADSB_CHECK(tracker.find_by_callsign("T1")->icao == second);
+        ADSB_CHECK(tracker.find_by_callsign("T2") == nullptr);
+    }
+
+    /// Stale aircraft are removed a few slots at a time, fresh ones stay.
+    void check_expire() {
+        adsb::tracker::TrackerOptions options;
+        options.capacity = 256;
+        options.expiry = 60s;
+        options.expiry_slots_per_update = 0;
+        adsb::tracker::AircraftTracker tracker(options);
+
+        const auto start = adsb::types::from_nanoseconds(0);
+        for (uint32_t i = 0; i < 200; ++i) {
+            const auto seen = i % 2 == 0 ? start : start + 50s;
+            tracker.update(identification(0x400000 + i * 0x1234, "E" + std::to_string(i)), seen);
+        }
+        ADSB_CHECK(tracker.size() == 200);
+
+        // One step inspects only a few slots
+        const auto now = start + 70s;
+        tracker.expire(now, 4);
+        ADSB_CHECK(tracker.size() > 100);
+
+        // A removal inspects its slot again, so one pass over the 512 slots takes up to 612 steps
+        for (int step = 0; step < 612; ++step) tracker.expire(now, 1);
+        ADSB_CHECK(tracker.size() == 100);
+        for (uint32_t i = 0; i < 200; ++i) {
+            const bool fresh = i % 2 == 1;
+            const std::string callsign = "E" + std::to_string(i);
+            ADSB_CHECK((tracker.find(0x400000 + i * 0x1234) != nullptr) == fresh);
+            ADSB_CHECK((tracker.find_by_callsign(callsign) != nullptr) == fresh);
+        }
+
+        // update() expires implicitly
+        options.expiry_slots_per_update = 2;
+        adsb::tracker::AircraftTracker implicit(options);
+        implicit.update(identification(0x400001, "OLD"), start);
+        for (int i = 0; i < 1000 && implicit.find(0x400001) != nullptr; ++i) {
+            implicit.update(identification(0x400002, "NEW"), start + 61s);
+        }
+        ADSB_CHECK(implicit.find(0x400001) == nullptr);
+        ADSB_CHECK(implicit.find_by_callsign("OLD") == nullptr);
+        ADSB_CHECK(implicit.size() == 1);
+    }
+
+    /// Snapshots keep fresh aircraft across a change of time base and reject files that do not match the build.
+    void check_snapshot() {
+        adsb::tracker::TrackerOptions options;
+        options.expiry = 60s;
+        options.expiry_slots_per_update = 0;
+        adsb::tracker::AircraftTracker tracker(options);
+
+        const auto saved_at = adsb::types::from_nanoseconds(1000000000000);
+        tracker.update(identification(0x484000, "KLM1023"), saved_at - 6s);
+        tracker.update(position(0x484000, 52.3, 4.8, false), saved_at - 6s);
+        tracker.update(position(0x484000, 52.31, 4.81, true), saved_at - 5s);
+        tracker.update(identification(0x484001, "KLM55"), saved_at - 50s);
+        tracker.update(identification(0x484002, "KLM77"), saved_at - 70s);
+        ADSB_CHECK(tracker.size() == 3);
+        const adsb::tracker::AircraftState before = *tracker.find(0x484000);
+
+        const std::string path = "test_tracker.snapshot";
+        ADSB_CHECK(tracker.save(path, saved_at));
+
+        // As after a reboot: the new time base starts near zero
+        const auto now = adsb::types::from_nanoseconds(3000000000);
+        adsb::tracker::AircraftTracker restored(options);
+        ADSB_CHECK(restored.load(path, now));
+        ADSB_CHECK(restored.size() == 2);
+        ADSB_CHECK(restored.find(0x484002) == nullptr);
+        ADSB_CHECK(restored.find_by_callsign("KLM55") != nullptr);
+        const adsb::tracker::AircraftState* state = restored.find_by_callsign("KLM1023");
+        ADSB_CHECK(state != nullptr && state->icao == 0x484000);
+        if (state != nullptr) {
+            // Less the wall-clock time between save() and load()
+            ADSB_CHECK(state->last_seen <= now - 5s && state->last_seen > now - 10s);
+            ADSB_CHECK(state->last_seen - state->position_time == before.last_seen - before.position_time);
+            ADSB_CHECK(state->last_seen - state->even_frame.timestamp == before.last_seen - before.even_frame.timestamp);
+            ADSB_CHECK(state->has_position && state->position.latitude == before.position.latitude
+                       && state->position.longitude == before.position.longitude);
+            ADSB_CHECK(state->message_count == before.message_count);
+        }
+
+        // Any mismatch or invalid record rejects the whole file and leaves the tracker as it is
+        const std::vector<uint8_t> good = read_file(path);
+        constexpr std::size_t VERSION_OFFSET = 8;
+        constexpr std::size_t LAYOUT_OFFSET = 16;
+        constexpr std::size_t COUNT_OFFSET = 24;
+        constexpr std::size_t RECORDS_OFFSET = 40;
+        ADSB_CHECK(good.size() == RECORDS_OFFSET + 3 * sizeof(adsb::tracker::AircraftState));
+
+        const auto rejected = [&](std::size_t offset, uint8_t value) {
+            std::vector<uint8_t> bad = good;
+            bad[offset] = value;
+            write_file(path, bad);
+            const bool loaded = restored.load(path, now);
+            return !loaded && restored.size() == 2 && restored.find(0x484000) != nullptr;
+        };
+        ADSB_CHECK(rejected(VERSION_OFFSET, 1));
+        ADSB_CHECK(rejected(LAYOUT_OFFSET, static_cast<uint8_t>(good[LAYOUT_OFFSET] + 1)));
+        ADSB_CHECK(rejected(COUNT_OFFSET, 4));
+        ADSB_CHECK(rejected(RECORDS_OFFSET + offsetof(adsb::tracker::AircraftState, has_position), 2));
+        ADSB_CHECK(rejected(RECORDS_OFFSET + offsetof(adsb::tracker::AircraftState, has_identification), 0xFF));
+        ADSB_CHECK(rejected(RECORDS_OFFSET + offsetof(adsb::tracker::AircraftState, category), 32));
+        ADSB_CHECK(rejected(RECORDS_OFFSET + offsetof(adsb::tracker::AircraftState, callsign_length), 9));
+
+        write_file(path, std::vector<uint8_t>(good.begin(), good.begin() + RECORDS_OFFSET - 1));
+        ADSB_CHECK(!restored.load(path, now));
+        std::remove(path.c_str());
+        ADSB_CHECK(!restored.load(path, now));
+        ADSB_CHECK(restored.size() == 2);
+    }
+
+}
+
+int main() {
+    check_replay(false);
+    check_replay(true);
+    check_local_decoding();
+    check_remove();
+    check_expire();
+    check_snapshot();
+    return adsb::test::result();
+}